@@ -45,6 +45,7 @@ set(JAVASCRIPTCORE_HEADERS
   "${PROJECT_SOURCE_DIR}/Source/JavaScriptCore/API/WebKitAvailability.h"
   "${PROJECT_SOURCE_DIR}/Source/JavaScriptCore/API/JSObjectRefPrivate.h"
   "${PROJECT_SOURCE_DIR}/Source/JavaScriptCore/API/JSRetainPtr.h"
+  "${PROJECT_SOURCE_DIR}/Source/JavaScriptCore/API/JSSamplingProfilerPrivate.h"
   )
 
 INSTALL(FILES ${JAVASCRIPTCORE_HEADERS} DESTINATION "include/JavaScriptCore/")
@@ -0,0 +1,84 @@
+#include "config.h"
+#include "JSSamplingProfilerPrivate.h"
+
+#include "APICast.h"
+#include "JSCInlines.h"
+#include "SamplingProfiler.h"
+#include <wtf/FilePrintStream.h>
+#include <wtf/Stopwatch.h>
+
+using namespace JSC;
+
+bool JSContextGroupStartSamplingProfiler(JSContextGroupRef group, unsigned intervalInMicroseconds, bool sampleNativeFrames)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    VM* vm = toJS(group);
+    JSLockHolder locker(vm);
+
+    auto stopwatch = Stopwatch::create();
+    stopwatch->start();
+    SamplingProfiler& samplingProfiler = vm->ensureSamplingProfiler(WTFMove(stopwatch));
+
+    LockHolder samplingProfilerLocker(samplingProfiler.getLock());
+    if (intervalInMicroseconds)
+        samplingProfiler.setTimingInterval(Seconds::fromMicroseconds(intervalInMicroseconds));
+    samplingProfiler.setSampleNativeFrames(samplingProfilerLocker, sampleNativeFrames);
+    samplingProfiler.noticeCurrentThreadAsJSCExecutionThread(samplingProfilerLocker);
+    samplingProfiler.start(samplingProfilerLocker);
+    return true;
+#else
+    UNUSED_PARAM(group);
+    UNUSED_PARAM(intervalInMicroseconds);
+    UNUSED_PARAM(sampleNativeFrames);
+    return false;
+#endif
+}
+
+void JSContextGroupStopSamplingProfiler(JSContextGroupRef group)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    VM* vm = toJS(group);
+    JSLockHolder locker(vm);
+
+    if (SamplingProfiler* samplingProfiler = vm->samplingProfiler()) {
+        LockHolder samplingProfilerLocker(samplingProfiler->getLock());
+        samplingProfiler->pause(samplingProfilerLocker);
+    }
+#else
+    UNUSED_PARAM(group);
+#endif
+}
+
+bool JSContextGroupWriteSamplingProfilerTrace(JSContextGroupRef group, const char* path, JSSamplingProfilerTraceFormat format)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    if (!path)
+        return false;
+
+    VM* vm = toJS(group);
+    JSLockHolder locker(vm);
+
+    SamplingProfiler* samplingProfiler = vm->samplingProfiler();
+    if (!samplingProfiler)
+        return false;
+
+    auto out = FilePrintStream::open(path, "w");
+    if (!out)
+        return false;
+
+    switch (format) {
+    case kJSSamplingProfilerTraceFormatCollapsedStacks:
+        out->print(samplingProfiler->stackTracesAsCollapsedStacks());
+        break;
+    case kJSSamplingProfilerTraceFormatChromeCPUProfile:
+        out->print(samplingProfiler->stackTracesAsChromeCPUProfile());
+        break;
+    }
+    return true;
+#else
+    UNUSED_PARAM(group);
+    UNUSED_PARAM(path);
+    UNUSED_PARAM(format);
+    return false;
+#endif
+}
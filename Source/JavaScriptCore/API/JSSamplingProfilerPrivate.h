@@ -0,0 +1,52 @@
+#ifndef JSSamplingProfilerPrivate_h
+#define JSSamplingProfilerPrivate_h
+
+#include <JavaScriptCore/JSContextRef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+@enum JSSamplingProfilerTraceFormat
+@constant kJSSamplingProfilerTraceFormatCollapsedStacks One "outer;inner;leaf count" line per distinct stack, as consumed by flamegraph.pl and speedscope.
+@constant kJSSamplingProfilerTraceFormatChromeCPUProfile A ".cpuprofile" JSON document, as loaded by Chrome DevTools and speedscope.
+*/
+typedef enum {
+    kJSSamplingProfilerTraceFormatCollapsedStacks,
+    kJSSamplingProfilerTraceFormatChromeCPUProfile
+} JSSamplingProfilerTraceFormat;
+
+/*!
+@function
+@abstract Starts (or resumes) sampling the JavaScript stacks of a context group's VM.
+@param group The JSContextGroup to profile. Must be called on the thread that runs JavaScript for the group.
+@param intervalInMicroseconds The time between samples, or 0 to keep the current interval (1ms by default).
+@param sampleNativeFrames Also record the native frames between JavaScript frames, such as layout or style recalculation forced by script. Only affects this group.
+@result false if this build does not include the sampling profiler.
+*/
+JS_EXPORT bool JSContextGroupStartSamplingProfiler(JSContextGroupRef group, unsigned intervalInMicroseconds, bool sampleNativeFrames);
+
+/*!
+@function
+@abstract Pauses the sampling profiler of a context group. Samples taken so far are kept.
+@param group The JSContextGroup being profiled.
+*/
+JS_EXPORT void JSContextGroupStopSamplingProfiler(JSContextGroupRef group);
+
+/*!
+@function
+@abstract Writes the samples taken so far to a file and discards them.
+@param group The JSContextGroup being profiled.
+@param path The file to write, it is overwritten if it exists.
+@param format The trace format to write.
+@result true if the trace was written.
+*/
+JS_EXPORT bool JSContextGroupWriteSamplingProfilerTrace(JSContextGroupRef group, const char* path, JSSamplingProfilerTraceFormat format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSSamplingProfilerPrivate_h
@@ -50,6 +50,7 @@
 #include "VM.h"
 #include <thread>
 #include <wtf/FilePrintStream.h>
+#include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/RefPtr.h>
 #include <wtf/StackTrace.h>
@@ -387,7 +388,7 @@ void SamplingProfiler::takeSample(const AbstractLocker&, Seconds& stackTraceProc
             size_t walkSize;
             bool wasValidWalk;
             bool didRunOutOfVectorSpace;
-            if (Options::sampleCCode()) {
+            if (Options::sampleCCode() || m_sampleNativeFrames) {
                 CFrameWalker walker(m_vm, machineFrame, callFrame, codeBlockSetLocker, machineThreadsLocker);
                 walkSize = walker.walk(m_currentFrames, didRunOutOfVectorSpace);
                 wasValidWalk = walker.wasValidWalk();
@@ -919,6 +920,164 @@ String SamplingProfiler::stackTracesAsJSON()
     return json.toString();
 }
 
+static String collapsedStackFrameName(VM& vm, SamplingProfiler::StackFrame& stackFrame)
+{
+    // ';' separates frames and ' ' separates the sample count in the collapsed format.
+    String name = stackFrame.displayName(vm);
+    String url = stackFrame.url();
+    if (!url.isEmpty())
+        name = makeString(name, " (", url, ':', stackFrame.functionStartLine(), ')');
+    name.replace(';', ':');
+    name.replace('\n', ' ');
+    return name;
+}
+
+String SamplingProfiler::stackTracesAsCollapsedStacks()
+{
+    DeferGC deferGC(m_vm.heap);
+    LockHolder locker(m_lock);
+
+    {
+        HeapIterationScope heapIterationScope(m_vm.heap);
+        processUnverifiedStackTraces();
+    }
+
+    // One line per distinct stack, root first: "outer;inner;leaf count". This is the
+    // input format of flamegraph.pl and speedscope.
+    HashMap<String, unsigned> stackCounts;
+    for (StackTrace& stackTrace : m_stackTraces) {
+        if (stackTrace.frames.isEmpty())
+            continue;
+        StringBuilder stack;
+        for (size_t i = stackTrace.frames.size(); i--;) {
+            stack.append(collapsedStackFrameName(m_vm, stackTrace.frames[i]));
+            if (i)
+                stack.append(';');
+        }
+        stackCounts.add(stack.toString(), 0).iterator->value++;
+    }
+
+    StringBuilder result;
+    for (auto& entry : stackCounts) {
+        result.append(entry.key);
+        result.append(' ');
+        result.appendNumber(entry.value);
+        result.append('\n');
+    }
+
+    clearData(locker);
+
+    return result.toString();
+}
+
+String SamplingProfiler::stackTracesAsChromeCPUProfile()
+{
+    DeferGC deferGC(m_vm.heap);
+    LockHolder locker(m_lock);
+
+    {
+        HeapIterationScope heapIterationScope(m_vm.heap);
+        processUnverifiedStackTraces();
+    }
+
+    // The ".cpuprofile" format read by Chrome DevTools and speedscope: a call tree of
+    // nodes, the leaf node of every sample, and the time between samples in microseconds.
+    struct ProfileNode {
+        String functionName;
+        String url;
+        intptr_t scriptID;
+        int lineNumber;
+        int columnNumber;
+        unsigned hitCount { 0 };
+        Vector<unsigned> children;
+    };
+
+    Vector<ProfileNode> nodes;
+    nodes.append({ "(root)"_s, emptyString(), 0, -1, -1, 0, { } });
+    HashMap<String, unsigned> nodeIndices;
+    Vector<unsigned> samples;
+    Vector<int64_t> timeDeltas;
+    Seconds lastTimestamp = m_stackTraces.isEmpty() ? 0_s : m_stackTraces.first().timestamp;
+
+    for (StackTrace& stackTrace : m_stackTraces) {
+        unsigned parent = 0;
+        for (size_t i = stackTrace.frames.size(); i--;) {
+            StackFrame& stackFrame = stackTrace.frames[i];
+            String functionName = stackFrame.displayName(m_vm);
+            String url = stackFrame.url();
+            int lineNumber = stackFrame.functionStartLine();
+            unsigned column = stackFrame.functionStartColumn();
+            int columnNumber = column == std::numeric_limits<unsigned>::max() ? -1 : static_cast<int>(column);
+
+            String key = makeString(parent, '\n', functionName, '\n', url, '\n', lineNumber, '\n', columnNumber);
+            auto addResult = nodeIndices.add(key, nodes.size());
+            if (addResult.isNewEntry) {
+                // Chrome uses zero-based line numbers.
+                nodes.append({ functionName, url, std::max<intptr_t>(stackFrame.sourceID(), 0), lineNumber > 0 ? lineNumber - 1 : -1, columnNumber, 0, { } });
+                nodes[parent].children.append(addResult.iterator->value);
+            }
+            parent = addResult.iterator->value;
+        }
+
+        nodes[parent].hitCount++;
+        samples.append(parent);
+        timeDeltas.append(static_cast<int64_t>((stackTrace.timestamp - lastTimestamp).microseconds()));
+        lastTimestamp = stackTrace.timestamp;
+    }
+
+    StringBuilder json;
+    json.appendLiteral("{\"nodes\":[");
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        auto& node = nodes[i];
+        if (i)
+            json.append(',');
+        json.appendLiteral("{\"id\":");
+        json.appendNumber(i + 1);
+        json.appendLiteral(",\"callFrame\":{\"functionName\":");
+        json.appendQuotedJSONString(node.functionName);
+        json.appendLiteral(",\"scriptId\":\"");
+        json.appendNumber(node.scriptID);
+        json.appendLiteral("\",\"url\":");
+        json.appendQuotedJSONString(node.url);
+        json.appendLiteral(",\"lineNumber\":");
+        json.appendNumber(node.lineNumber);
+        json.appendLiteral(",\"columnNumber\":");
+        json.appendNumber(node.columnNumber);
+        json.appendLiteral("},\"hitCount\":");
+        json.appendNumber(node.hitCount);
+        json.appendLiteral(",\"children\":[");
+        for (unsigned j = 0; j < node.children.size(); ++j) {
+            if (j)
+                json.append(',');
+            json.appendNumber(node.children[j] + 1);
+        }
+        json.appendLiteral("]}");
+    }
+
+    Seconds startTime = m_stackTraces.isEmpty() ? 0_s : m_stackTraces.first().timestamp;
+    json.appendLiteral("],\"startTime\":");
+    json.appendNumber(static_cast<int64_t>(startTime.microseconds()));
+    json.appendLiteral(",\"endTime\":");
+    json.appendNumber(static_cast<int64_t>(lastTimestamp.microseconds()));
+    json.appendLiteral(",\"samples\":[");
+    for (unsigned i = 0; i < samples.size(); ++i) {
+        if (i)
+            json.append(',');
+        json.appendNumber(samples[i] + 1);
+    }
+    json.appendLiteral("],\"timeDeltas\":[");
+    for (unsigned i = 0; i < timeDeltas.size(); ++i) {
+        if (i)
+            json.append(',');
+        json.appendNumber(timeDeltas[i]);
+    }
+    json.appendLiteral("]}");
+
+    clearData(locker);
+
+    return json.toString();
+}
+
 void SamplingProfiler::registerForReportAtExit()
 {
     static Lock registrationLock;
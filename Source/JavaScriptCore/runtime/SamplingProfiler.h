@@ -167,10 +167,14 @@ public:
     void start(const AbstractLocker&);
     Vector<StackTrace> releaseStackTraces(const AbstractLocker&);
     JS_EXPORT_PRIVATE String stackTracesAsJSON();
+    JS_EXPORT_PRIVATE String stackTracesAsCollapsedStacks();
+    JS_EXPORT_PRIVATE String stackTracesAsChromeCPUProfile();
     JS_EXPORT_PRIVATE void noticeCurrentThreadAsJSCExecutionThread();
     void noticeCurrentThreadAsJSCExecutionThread(const AbstractLocker&);
     void processUnverifiedStackTraces(); // You should call this only after acquiring the lock.
     void setStopWatch(const AbstractLocker&, Ref<Stopwatch>&& stopwatch) { m_stopwatch = WTFMove(stopwatch); }
+    // Records C frames for this VM even when Options::sampleCCode() is off.
+    void setSampleNativeFrames(const AbstractLocker&, bool sampleNativeFrames) { m_sampleNativeFrames = sampleNativeFrames; }
     void pause(const AbstractLocker&);
     void clearData(const AbstractLocker&);
 
@@ -195,6 +199,7 @@ private:
     bool m_isPaused;
     bool m_isShutDown;
     bool m_needsReportAtExit { false };
+    bool m_sampleNativeFrames { false };
     VM& m_vm;
     WeakRandom m_weakRandom;
     RefPtr<Stopwatch> m_stopwatch;
@@ -1246,6 +1246,10 @@
 #define USE_REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR 1
 #endif
 
+#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR) || PLATFORM(ULTRALIGHT)
+#define USE_REQUEST_ANIMATION_FRAME_THROTTLING 1
+#endif
+
 #if PLATFORM(MAC) || PLATFORM(MACCATALYST)
 #define HAVE_APPLE_GRAPHICS_CONTROL 1
 #endif
@@ -191,6 +191,54 @@ inline void copyLCharsFromUCharSource(LChar* destination, const UChar* source, s
 #endif
 }
 
+// Widens Latin-1 characters to UTF-16. Unlike copyLCharsFromUCharSource this is
+// valid for any input; every LChar maps to the UChar with the same code point.
+inline void copyUCharsFromLCharSource(UChar* destination, const LChar* source, size_t length)
+{
+#if CPU(X86_SSE2)
+    const size_t lcharsPerLoop = 16; // Process 16 bytes (16 LChars) each iteration
+
+    size_t i = 0;
+    if (length >= lcharsPerLoop) {
+        const __m128i zero = _mm_setzero_si128();
+        const size_t endLength = length - lcharsPerLoop + 1;
+        for (; i < endLength; i += lcharsPerLoop) {
+            __m128i sixteenLChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&destination[i]), _mm_unpacklo_epi8(sixteenLChars, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&destination[i + 8]), _mm_unpackhi_epi8(sixteenLChars, zero));
+        }
+    }
+
+    for (; i < length; ++i)
+        destination[i] = source[i];
+#elif COMPILER(GCC_COMPATIBLE) && CPU(ARM64) && !defined(__ILP32__)
+    const UChar* const end = destination + length;
+    const uintptr_t memoryAccessSize = 16;
+
+    if (length >= memoryAccessSize) {
+        const uintptr_t memoryAccessMask = memoryAccessSize - 1;
+
+        // Zero-extend 16 bytes into two vectors of 8 halfwords.
+        const UChar* const simdEnd = destination + (length & ~memoryAccessMask);
+        do {
+            asm("ld1   { v0.16B }, [%[SOURCE]], #16\n\t"
+                "uxtl  v1.8H, v0.8B\n\t"
+                "uxtl2 v2.8H, v0.16B\n\t"
+                "st1   { v1.8H, v2.8H }, [%[DESTINATION]], #32\n\t"
+                : [SOURCE]"+r" (source), [DESTINATION]"+r" (destination)
+                :
+                : "memory", "v0", "v1", "v2");
+        } while (destination != simdEnd);
+    }
+
+    while (destination != end)
+        *destination++ = *source++;
+#else
+    for (size_t i = 0; i < length; ++i)
+        destination[i] = source[i];
+#endif
+}
+
 } // namespace WTF
 
 using WTF::charactersAreAllASCII;
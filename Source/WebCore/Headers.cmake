@@ -61,6 +61,7 @@ set(WebCore_PRIVATE_FRAMEWORK_HEADERS
     Modules/indexeddb/server/IDBBackingStore.h
     Modules/indexeddb/server/IDBConnectionToClient.h
     Modules/indexeddb/server/IDBConnectionToClientDelegate.h
+    Modules/indexeddb/server/IDBDatabaseThread.h
     Modules/indexeddb/server/IDBServer.h
     Modules/indexeddb/server/ServerOpenDBRequest.h
     Modules/indexeddb/server/UniqueIDBDatabase.h
@@ -1353,6 +1354,7 @@ set(WebCore_PRIVATE_FRAMEWORK_HEADERS
 
     replay/UserInputBridge.h
 
+    storage/LocalStorageArea.h
     storage/Storage.h
     storage/StorageArea.h
     storage/StorageEventDispatcher.h
@@ -317,6 +317,9 @@ bool IDBCursor::setGetResult(IDBRequest& request, const IDBGetResult& getResult)
     LOG(IndexedDB, "IDBCursor::setGetResult - current key %s", getResult.keyData().loggingString().substring(0, 100).utf8().data());
     ASSERT(&effectiveObjectStore().transaction().database().originThread() == &Thread::current());
 
+    for (auto& record : getResult.prefetchedRecords())
+        m_prefetchedRecords.append(record);
+
     auto* context = request.scriptExecutionContext();
     if (!context)
         return false;
@@ -353,6 +356,48 @@ bool IDBCursor::setGetResult(IDBRequest& request, const IDBGetResult& getResult)
     return true;
 }
 
+Optional<IDBGetResult> IDBCursor::iterateWithPrefetchedRecords(const IDBIterateCursorData& data, uint64_t writeOperationCount)
+{
+    ASSERT(&effectiveObjectStore().transaction().database().originThread() == &Thread::current());
+
+    if (m_prefetchedRecords.isEmpty() || writeOperationCount != m_prefetchedRecordsWriteOperationCount)
+        return WTF::nullopt;
+
+    // Mirrors SQLiteIDBCursor::advance() and SQLiteIDBCursor::iterate(), which the server will
+    // run on its copy of these records.
+    size_t index;
+    if (data.keyData.isValid()) {
+        bool isForward = m_info.cursorDirection() == IndexedDB::CursorDirection::Next || m_info.cursorDirection() == IndexedDB::CursorDirection::Nextunique;
+        auto reachesTarget = [isForward](int comparison) {
+            return isForward ? comparison >= 0 : comparison <= 0;
+        };
+        auto match = std::find_if(m_prefetchedRecords.begin(), m_prefetchedRecords.end(), [&](auto& record) {
+            int keyComparison = record.key.compare(data.keyData);
+            if (!reachesTarget(keyComparison))
+                return false;
+            return keyComparison || !data.primaryKeyData.isValid() || reachesTarget(record.primaryKey.compare(data.primaryKeyData));
+        });
+        index = std::distance(m_prefetchedRecords.begin(), match);
+    } else
+        index = std::max(data.count, 1u) - 1;
+
+    // The record we need has not been prefetched, or may be past the end of the cursor.
+    if (index >= m_prefetchedRecords.size())
+        return WTF::nullopt;
+
+    for (; index; --index)
+        m_prefetchedRecords.removeFirst();
+    auto record = m_prefetchedRecords.takeFirst();
+
+    return IDBGetResult { record.key, record.primaryKey, WTFMove(record.value), m_keyPath };
+}
+
+void IDBCursor::clearPrefetchedRecords(uint64_t writeOperationCount)
+{
+    m_prefetchedRecords.clear();
+    m_prefetchedRecordsWriteOperationCount = writeOperationCount;
+}
+
 void IDBCursor::clearWrappers()
 {
     m_keyWrapper.clear();
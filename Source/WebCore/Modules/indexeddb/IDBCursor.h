@@ -29,12 +29,14 @@
 
 #include "ExceptionOr.h"
 #include "IDBCursorDirection.h"
+#include "IDBCursorRecord.h"
 #include "IDBCursorInfo.h"
 #include "IDBKeyPath.h"
 #include "IDBRequest.h"
 #include "IDBValue.h"
 #include "JSValueInWrappedObject.h"
 #include <JavaScriptCore/Strong.h>
+#include <wtf/Deque.h>
 #include <wtf/Variant.h>
 #include <wtf/WeakPtr.h>
 
@@ -42,6 +44,7 @@ namespace WebCore {
 
 class IDBGetResult;
 class IDBIndex;
+struct IDBIterateCursorData;
 class IDBObjectStore;
 class IDBTransaction;
 
@@ -83,6 +86,11 @@ public:
 
     bool setGetResult(IDBRequest&, const IDBGetResult&);
 
+    // Records the server sent ahead of the current one stay usable until the transaction
+    // writes anything after the request that fetched them.
+    Optional<IDBGetResult> iterateWithPrefetchedRecords(const IDBIterateCursorData&, uint64_t writeOperationCount);
+    void clearPrefetchedRecords(uint64_t writeOperationCount);
+
     virtual bool isKeyCursorWithValue() const { return false; }
 
 protected:
@@ -113,6 +121,9 @@ private:
     JSValueInWrappedObject m_keyWrapper;
     JSValueInWrappedObject m_primaryKeyWrapper;
     JSValueInWrappedObject m_valueWrapper;
+
+    Deque<IDBCursorRecord> m_prefetchedRecords;
+    uint64_t m_prefetchedRecordsWriteOperationCount { 0 };
 };
 
 
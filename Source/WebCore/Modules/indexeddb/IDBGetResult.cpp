@@ -55,6 +55,9 @@ void IDBGetResult::isolatedCopy(const IDBGetResult& source, IDBGetResult& destin
     destination.m_primaryKeyData = source.m_primaryKeyData.isolatedCopy();
     destination.m_keyPath = WebCore::isolatedCopy(source.m_keyPath);
     destination.m_isDefined = source.m_isDefined;
+    destination.m_prefetchedRecords = WTF::map(source.m_prefetchedRecords, [](auto& record) {
+        return record.isolatedCopy();
+    });
 }
 
 void IDBGetResult::setValue(IDBValue&& value)
@@ -27,6 +27,7 @@
 
 #if ENABLE(INDEXED_DATABASE)
 
+#include "IDBCursorRecord.h"
 #include "IDBKey.h"
 #include "IDBKeyData.h"
 #include "IDBKeyPath.h"
@@ -82,6 +83,7 @@ public:
     IDBGetResult isolatedCopy() const;
 
     void setValue(IDBValue&&);
+    void setPrefetchedRecords(Vector<IDBCursorRecord>&& records) { m_prefetchedRecords = WTFMove(records); }
 
     const IDBValue& value() const { return m_value; }
     const IDBKeyData& keyData() const { return m_keyData; }
@@ -89,6 +91,9 @@ public:
     const Optional<IDBKeyPath>& keyPath() const { return m_keyPath; }
     bool isDefined() const { return m_isDefined; }
 
+    // Records a cursor will visit after this one, fetched ahead by the server.
+    const Vector<IDBCursorRecord>& prefetchedRecords() const { return m_prefetchedRecords; }
+
     template<class Encoder> void encode(Encoder&) const;
     template<class Decoder> static bool decode(Decoder&, IDBGetResult&);
 
@@ -102,12 +107,13 @@ private:
     IDBKeyData m_primaryKeyData;
     Optional<IDBKeyPath> m_keyPath;
     bool m_isDefined { true };
+    Vector<IDBCursorRecord> m_prefetchedRecords;
 };
 
 template<class Encoder>
 void IDBGetResult::encode(Encoder& encoder) const
 {
-    encoder << m_keyData << m_primaryKeyData << m_keyPath << m_isDefined << m_value;
+    encoder << m_keyData << m_primaryKeyData << m_keyPath << m_isDefined << m_value << m_prefetchedRecords;
 }
 
 template<class Decoder>
@@ -137,6 +143,9 @@ bool IDBGetResult::decode(Decoder& decoder, IDBGetResult& result)
         return false;
     result.m_value = WTFMove(*value);
 
+    if (!decoder.decode(result.m_prefetchedRecords))
+        return false;
+
     return true;
 }
 
@@ -861,18 +861,19 @@ Ref<IDBRequest> IDBTransaction::doRequestOpenCursor(ExecState& state, Ref<IDBCur
     LOG(IndexedDBOperations, "IDB open cursor operation: %s", cursor->info().loggingString().utf8().data());
     scheduleOperation(IDBClient::TransactionOperationImpl::create(*this, request.get(), [protectedThis = makeRef(*this), request = request.copyRef()] (const auto& result) {
         protectedThis->didOpenCursorOnServer(request.get(), result);
-    }, [protectedThis = makeRef(*this), info = cursor->info().isolatedCopy()] (auto& operation) {
-        protectedThis->openCursorOnServer(operation, info);
+    }, [protectedThis = makeRef(*this), cursor = cursor.copyRef(), info = cursor->info().isolatedCopy()] (auto& operation) {
+        protectedThis->openCursorOnServer(operation, cursor.get(), info);
     }));
 
     return request;
 }
 
-void IDBTransaction::openCursorOnServer(IDBClient::TransactionOperation& operation, const IDBCursorInfo& info)
+void IDBTransaction::openCursorOnServer(IDBClient::TransactionOperation& operation, IDBCursor& cursor, const IDBCursorInfo& info)
 {
     LOG(IndexedDB, "IDBTransaction::openCursorOnServer");
     ASSERT(&m_database->originThread() == &Thread::current());
 
+    cursor.clearPrefetchedRecords(m_writeOperationCount);
     m_database->connectionProxy().openCursor(operation, info);
 }
 
@@ -896,17 +897,33 @@ void IDBTransaction::iterateCursor(IDBCursor& cursor, const IDBIterateCursorData
     LOG(IndexedDBOperations, "IDB iterate cursor operation: %s %s", cursor.info().loggingString().utf8().data(), data.loggingString().utf8().data());
     scheduleOperation(IDBClient::TransactionOperationImpl::create(*this, *cursor.request(), [protectedThis = makeRef(*this), request = makeRef(*cursor.request())] (const auto& result) {
         protectedThis->didIterateCursorOnServer(request.get(), result);
-    }, [protectedThis = makeRef(*this), data = data.isolatedCopy()] (auto& operation) {
-        protectedThis->iterateCursorOnServer(operation, data);
+    }, [protectedThis = makeRef(*this), cursor = makeRef(cursor), data = data.isolatedCopy()] (auto& operation) {
+        protectedThis->iterateCursorOnServer(operation, cursor.get(), data);
     }));
 }
 
-// FIXME: changes here
-void IDBTransaction::iterateCursorOnServer(IDBClient::TransactionOperation& operation, const IDBIterateCursorData& data)
+void IDBTransaction::iterateCursorOnServer(IDBClient::TransactionOperation& operation, IDBCursor& cursor, const IDBIterateCursorData& data)
 {
     LOG(IndexedDB, "IDBTransaction::iterateCursorOnServer");
     ASSERT(&m_database->originThread() == &Thread::current());
+    ASSERT(data.option == IndexedDB::CursorIterateOption::Reply);
 
+    // Results have to complete in the order their operations were sent, so the cursor can only
+    // answer from its prefetched records when nothing else is waiting on the server.
+    if (m_transactionOperationsInProgressQueue.size() == 1) {
+        ASSERT(m_transactionOperationsInProgressQueue.first() == &operation);
+        if (auto result = cursor.iterateWithPrefetchedRecords(data, m_writeOperationCount)) {
+            // The server still steps its cursor over the same records, keeping both in the same place.
+            auto serverData = data;
+            serverData.option = IndexedDB::CursorIterateOption::DoNotReply;
+            m_database->connectionProxy().iterateCursor(operation, serverData);
+
+            operation.transitionToCompleteOnThisThread(IDBResultData::iterateCursorSuccess(operation.identifier(), *result));
+            return;
+        }
+    }
+
+    cursor.clearPrefetchedRecords(m_writeOperationCount);
     m_database->connectionProxy().iterateCursor(operation, data);
 }
 
@@ -1189,6 +1206,8 @@ void IDBTransaction::deleteRecordOnServer(IDBClient::TransactionOperation& opera
     LOG(IndexedDB, "IDBTransaction::deleteRecordOnServer");
     ASSERT(&m_database->originThread() == &Thread::current());
 
+    ++m_writeOperationCount;
+
     m_database->connectionProxy().deleteRecord(operation, keyRange);
 }
 
@@ -1229,6 +1248,8 @@ void IDBTransaction::clearObjectStoreOnServer(IDBClient::TransactionOperation& o
     LOG(IndexedDB, "IDBTransaction::clearObjectStoreOnServer");
     ASSERT(&m_database->originThread() == &Thread::current());
 
+    ++m_writeOperationCount;
+
     m_database->connectionProxy().clearObjectStore(operation, objectStoreIdentifier);
 }
 
@@ -1271,6 +1292,8 @@ void IDBTransaction::putOrAddOnServer(IDBClient::TransactionOperation& operation
     ASSERT(!isReadOnly());
     ASSERT(value);
 
+    ++m_writeOperationCount;
+
     if (!value->hasBlobURLs()) {
         m_database->connectionProxy().putOrAdd(operation, key.get(), *value, overwriteMode);
         return;
@@ -216,10 +216,10 @@ private:
     void didDeleteIndexOnServer(const IDBResultData&);
 
     Ref<IDBRequest> doRequestOpenCursor(JSC::ExecState&, Ref<IDBCursor>&&);
-    void openCursorOnServer(IDBClient::TransactionOperation&, const IDBCursorInfo&);
+    void openCursorOnServer(IDBClient::TransactionOperation&, IDBCursor&, const IDBCursorInfo&);
     void didOpenCursorOnServer(IDBRequest&, const IDBResultData&);
 
-    void iterateCursorOnServer(IDBClient::TransactionOperation&, const IDBIterateCursorData&);
+    void iterateCursorOnServer(IDBClient::TransactionOperation&, IDBCursor&, const IDBIterateCursorData&);
     void didIterateCursorOnServer(IDBRequest&, const IDBResultData&);
 
     void transitionedToFinishing(IndexedDB::TransactionState);
@@ -254,6 +254,9 @@ private:
 
     HashMap<IDBResourceIdentifier, RefPtr<IDBClient::TransactionOperation>> m_transactionOperationMap;
 
+    // Bumped whenever a write is sent to the server, invalidating records cursors have prefetched.
+    uint64_t m_writeOperationCount { 0 };
+
     mutable Lock m_referencedObjectStoreLock;
     HashMap<String, std::unique_ptr<IDBObjectStore>> m_referencedObjectStores;
     HashMap<uint64_t, std::unique_ptr<IDBObjectStore>> m_deletedObjectStores;
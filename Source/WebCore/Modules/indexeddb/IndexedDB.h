@@ -104,6 +104,13 @@ enum class GetAllType {
     Values,
 };
 
+// DoNotReply iterations keep the server cursor in step with a client cursor that
+// was advanced through records the server already sent it.
+enum class CursorIterateOption {
+    DoNotReply,
+    Reply,
+};
+
 } // namespace IndexedDB
 
 } // namespace WebCore
@@ -119,6 +126,14 @@ template<> struct EnumTraits<WebCore::IndexedDB::ObjectStoreOverwriteMode> {
     >;
 };
 
+template<> struct EnumTraits<WebCore::IndexedDB::CursorIterateOption> {
+    using values = EnumValues<
+        WebCore::IndexedDB::CursorIterateOption,
+        WebCore::IndexedDB::CursorIterateOption::DoNotReply,
+        WebCore::IndexedDB::CursorIterateOption::Reply
+    >;
+};
+
 }
 
 #endif // ENABLED(INDEXED_DATABASE)
@@ -0,0 +1,43 @@
+#pragma once
+
+#if ENABLE(INDEXED_DATABASE)
+
+#include <wtf/CrossThreadTaskHandler.h>
+
+namespace WebCore {
+namespace IDBServer {
+
+// A serial task queue with its own thread that runs the backing store work of the
+// UniqueIDBDatabases IDBServer assigned to it, so a long running operation in one
+// database doesn't hold up the databases on other threads.
+class IDBDatabaseThread final : public CrossThreadTaskHandler {
+    WTF_MAKE_NONCOPYABLE(IDBDatabaseThread);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    IDBDatabaseThread()
+        : CrossThreadTaskHandler("IndexedDatabase Database", AutodrainedPoolForRunLoop::Use)
+    {
+    }
+
+    using CrossThreadTaskHandler::postTask;
+    using CrossThreadTaskHandler::postTaskReply;
+    using CrossThreadTaskHandler::suspendAndWait;
+    using CrossThreadTaskHandler::resume;
+
+    // Number of database identifiers currently assigned to this thread, main thread only.
+    unsigned databaseCount() const { return m_databaseCount; }
+    void didAssignDatabase() { ++m_databaseCount; }
+    void didUnassignDatabase()
+    {
+        ASSERT(m_databaseCount);
+        --m_databaseCount;
+    }
+
+private:
+    unsigned m_databaseCount { 0 };
+};
+
+} // namespace IDBServer
+} // namespace WebCore
+
+#endif // ENABLE(INDEXED_DATABASE)
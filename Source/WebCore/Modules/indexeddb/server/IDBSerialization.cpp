@@ -126,33 +126,52 @@ static bool isLegacySerializedIDBKeyData(const uint8_t* data, size_t size)
 The IDBKeyData serialization format is as follows:
 [1 byte version header][Key Buffer]
 
+Keys are written with version 0x01, which is built so that comparing two serialized keys with
+memcmp() gives the same result as IDBKeyData::compare(). That lets SQLite index and range scan
+key columns with its built-in BINARY collation instead of calling back into a custom collation
+that has to deserialize both keys for every comparison.
+
 The Key Buffer serialization format is as follows:
 [1 byte key type][Type specific data]
 
-Type specific serialization formats are as follows for each of the types:
+The key type bytes are ordered the same way the key types sort. Type specific serialization
+formats are as follows for each of the types:
 Min:
 [0 bytes]
 
 Number:
-[8 bytes representing a double encoded in little endian]
+[8 bytes representing a double in big endian, with the sign bit flipped for positive values and all bits flipped for negative values]
 
 Date:
-[8 bytes representing a double encoded in little endian]
+[Same as Number]
 
 String:
-[4 bytes representing string "length" in little endian]["length" number of 2-byte pairs representing ECMAScript 16-bit code units]
+[Each ECMAScript 16-bit code unit encoded in 1 to 3 bytes as described below][1 byte 0x00 terminator]
 
 Binary:
-[8 bytes representing the "size" of the binary blob]["size" bytes]
+[Each byte encoded in 1 or 2 bytes as described below][1 byte 0x00 terminator]
 
 Array:
-[8 bytes representing the "length" of the key array]["length" individual Key Buffer entries]
+[Each individual Key Buffer entry][1 byte 0x00 terminator]
 
 Max:
 [0 bytes]
+
+Code units and bytes are encoded as follows, which preserves their order and never writes a
+0x00 lead byte, so a shorter string still sorts before any longer string it is a prefix of:
+0x0000 - 0x007E: [1 byte, value + 1]
+0x007F - 0x407E: [2 bytes, big endian value - 0x7F + 0x8000]
+0x407F - 0xFFFF: [3 bytes, big endian (value << 6) | 0xC00000]
+
+Version 0x00 keys, written before the ordered format existed, are still read. They use the same
+key type bytes, but store Numbers and Dates as little endian doubles, Strings as a 4 byte little
+endian length followed by the little endian code units, Binary as an 8 byte little endian size
+followed by the bytes, and Arrays as an 8 byte little endian length followed by the entries.
 */
 
-static const uint8_t SIDBKeyVersion = 0x00;
+static const uint8_t SIDBKeyVersion = 0x01;
+static const uint8_t SIDBLittleEndianKeyVersion = 0x00;
+static const uint8_t SIDBKeyTerminator = 0x00;
 enum class SIDBKeyType : uint8_t {
     Min = 0x00,
     Number = 0x20,
@@ -188,14 +207,6 @@ static SIDBKeyType serializedTypeForKeyType(IndexedDB::KeyType type)
 }
 
 #if CPU(BIG_ENDIAN) || CPU(MIDDLE_ENDIAN) || CPU(NEEDS_ALIGNED_ACCESS)
-template <typename T> static void writeLittleEndian(Vector<char>& buffer, T value)
-{
-    for (unsigned i = 0; i < sizeof(T); i++) {
-        buffer.append(value & 0xFF);
-        value >>= 8;
-    }
-}
-
 template <typename T> static bool readLittleEndian(const uint8_t*& ptr, const uint8_t* end, T& value)
 {
     if (ptr > end - sizeof(value))
@@ -207,11 +218,6 @@ template <typename T> static bool readLittleEndian(const uint8_t*& ptr, const ui
     return true;
 }
 #else
-template <typename T> static void writeLittleEndian(Vector<char>& buffer, T value)
-{
-    buffer.append(reinterpret_cast<uint8_t*>(&value), sizeof(value));
-}
-
 template <typename T> static bool readLittleEndian(const uint8_t*& ptr, const uint8_t* end, T& value)
 {
     if (ptr > end - sizeof(value))
@@ -224,14 +230,87 @@ template <typename T> static bool readLittleEndian(const uint8_t*& ptr, const ui
 }
 #endif
 
-static void writeDouble(Vector<char>& data, double d)
+static bool readDouble(const uint8_t*& data, const uint8_t* end, double& d)
 {
-    writeLittleEndian(data, *reinterpret_cast<uint64_t*>(&d));
+    return readLittleEndian(data, end, *reinterpret_cast<uint64_t*>(&d));
 }
 
-static bool readDouble(const uint8_t*& data, const uint8_t* end, double& d)
+static const uint64_t doubleSignBit = 0x8000000000000000ull;
+
+static void writeOrderedDouble(Vector<char>& data, double d)
 {
-    return readLittleEndian(data, end, *reinterpret_cast<uint64_t*>(&d));
+    // -0 and 0 are the same key, so they need to serialize identically.
+    if (!d)
+        d = 0;
+
+    uint64_t bits = bitwise_cast<uint64_t>(d);
+    bits = (bits & doubleSignBit) ? ~bits : bits | doubleSignBit;
+    for (int shift = 56; shift >= 0; shift -= 8)
+        data.append(static_cast<char>(bits >> shift));
+}
+
+static bool readOrderedDouble(const uint8_t*& data, const uint8_t* end, double& d)
+{
+    if (end - data < 8)
+        return false;
+
+    uint64_t bits = 0;
+    for (unsigned i = 0; i < 8; ++i)
+        bits = (bits << 8) | data++[0];
+
+    bits = (bits & doubleSignBit) ? bits & ~doubleSignBit : ~bits;
+    d = bitwise_cast<double>(bits);
+    return true;
+}
+
+static const uint16_t orderedOneByteLimit = 0x7E;
+static const uint16_t orderedTwoByteLimit = 0x3FFF + orderedOneByteLimit + 1;
+
+static void writeOrderedCodeUnit(Vector<char>& data, uint16_t unit)
+{
+    if (unit <= orderedOneByteLimit) {
+        data.append(static_cast<char>(unit + 1));
+        return;
+    }
+
+    if (unit <= orderedTwoByteLimit) {
+        uint16_t value = unit - (orderedOneByteLimit + 1) + 0x8000;
+        data.append(static_cast<char>(value >> 8));
+        data.append(static_cast<char>(value & 0xFF));
+        return;
+    }
+
+    uint32_t value = (static_cast<uint32_t>(unit) << 6) | 0xC00000;
+    data.append(static_cast<char>(value >> 16));
+    data.append(static_cast<char>((value >> 8) & 0xFF));
+    data.append(static_cast<char>(value & 0xFF));
+}
+
+static bool readOrderedCodeUnit(const uint8_t*& data, const uint8_t* end, uint16_t& unit)
+{
+    ASSERT(data < end && data[0] != SIDBKeyTerminator);
+
+    uint8_t lead = data++[0];
+    if (lead <= orderedOneByteLimit + 1) {
+        unit = lead - 1;
+        return true;
+    }
+
+    if (lead < 0xC0) {
+        if (data >= end)
+            return false;
+        unit = ((static_cast<uint16_t>(lead) << 8) | data++[0]) - 0x8000 + orderedOneByteLimit + 1;
+        return true;
+    }
+
+    if (end - data < 2)
+        return false;
+    uint32_t value = (static_cast<uint32_t>(lead) << 16) | (static_cast<uint32_t>(data[0]) << 8) | data[1];
+    data += 2;
+    if ((value & 0x3F) || (value & ~0xC00000) >> 6 <= orderedTwoByteLimit)
+        return false;
+    unit = static_cast<uint16_t>((value & ~0xC00000) >> 6);
+    return true;
 }
 
 static void encodeKey(Vector<char>& data, const IDBKeyData& key)
@@ -241,39 +320,40 @@ static void encodeKey(Vector<char>& data, const IDBKeyData& key)
 
     switch (type) {
     case SIDBKeyType::Number:
-        writeDouble(data, key.number());
+        writeOrderedDouble(data, key.number());
         break;
     case SIDBKeyType::Date:
-        writeDouble(data, key.date());
+        writeOrderedDouble(data, key.date());
         break;
     case SIDBKeyType::String: {
         auto string = key.string();
-        uint32_t length = string.length();
-        writeLittleEndian(data, length);
+        unsigned length = string.length();
+        data.reserveCapacity(data.size() + length + 1);
 
-        for (size_t i = 0; i < length; ++i)
-            writeLittleEndian(data, string[i]);
+        for (unsigned i = 0; i < length; ++i)
+            writeOrderedCodeUnit(data, string[i]);
+        data.append(SIDBKeyTerminator);
 
         break;
     }
     case SIDBKeyType::Binary: {
-        auto& buffer = key.binary();
-        uint64_t size = buffer.size();
-        writeLittleEndian(data, size);
-
-        auto* bufferData = buffer.data();
-        ASSERT(bufferData || !size);
-        if (bufferData)
-            data.append(bufferData->data(), bufferData->size());
+        auto* bufferData = key.binary().data();
+        if (bufferData) {
+            data.reserveCapacity(data.size() + bufferData->size() + 1);
+            for (uint8_t byte : *bufferData)
+                writeOrderedCodeUnit(data, byte);
+        }
+        data.append(SIDBKeyTerminator);
 
         break;
     }
     case SIDBKeyType::Array: {
-        auto& array = key.array();
-        uint64_t size = array.size();
-        writeLittleEndian(data, size);
-        for (auto& key : array)
+        for (auto& key : key.array()) {
+            // Min and Max are only ever used as range bounds, an array never contains them.
+            ASSERT(key.type() != IndexedDB::KeyType::Min && key.type() != IndexedDB::KeyType::Max);
             encodeKey(data, key);
+        }
+        data.append(SIDBKeyTerminator);
 
         break;
     }
@@ -292,6 +372,85 @@ RefPtr<SharedBuffer> serializeIDBKeyData(const IDBKeyData& key)
     return SharedBuffer::create(WTFMove(data));
 }
 
+static bool decodeOrderedKey(const uint8_t*& data, const uint8_t* end, IDBKeyData& result)
+{
+    if (!data || data >= end)
+        return false;
+
+    SIDBKeyType type = static_cast<SIDBKeyType>(data++[0]);
+    switch (type) {
+    case SIDBKeyType::Min:
+        result = IDBKeyData::minimum();
+        return true;
+    case SIDBKeyType::Max:
+        result = IDBKeyData::maximum();
+        return true;
+    case SIDBKeyType::Number: {
+        double d;
+        if (!readOrderedDouble(data, end, d))
+            return false;
+
+        result.setNumberValue(d);
+        return true;
+    }
+    case SIDBKeyType::Date: {
+        double d;
+        if (!readOrderedDouble(data, end, d))
+            return false;
+
+        result.setDateValue(d);
+        return true;
+    }
+    case SIDBKeyType::String: {
+        Vector<UChar> buffer;
+        while (data < end && data[0] != SIDBKeyTerminator) {
+            uint16_t unit;
+            if (!readOrderedCodeUnit(data, end, unit))
+                return false;
+            buffer.append(unit);
+        }
+        if (data++ >= end)
+            return false;
+
+        result.setStringValue(String::adopt(WTFMove(buffer)));
+        return true;
+    }
+    case SIDBKeyType::Binary: {
+        Vector<uint8_t> dataVector;
+        while (data < end && data[0] != SIDBKeyTerminator) {
+            uint16_t unit;
+            if (!readOrderedCodeUnit(data, end, unit) || unit > 0xFF)
+                return false;
+            dataVector.append(static_cast<uint8_t>(unit));
+        }
+        if (data++ >= end)
+            return false;
+
+        result.setBinaryValue(ThreadSafeDataBuffer::create(WTFMove(dataVector)));
+        return true;
+    }
+    case SIDBKeyType::Array: {
+        Vector<IDBKeyData> array;
+        while (data < end && data[0] != SIDBKeyTerminator) {
+            IDBKeyData keyData;
+            if (!decodeOrderedKey(data, end, keyData))
+                return false;
+
+            ASSERT(keyData.isValid());
+            array.append(WTFMove(keyData));
+        }
+        if (data++ >= end)
+            return false;
+
+        result.setArrayValue(array);
+        return true;
+    }
+    default:
+        LOG_ERROR("decodeOrderedKey encountered unexpected type: %i", (int)type);
+        return false;
+    }
+}
+
 static bool decodeKey(const uint8_t*& data, const uint8_t* end, IDBKeyData& result)
 {
     if (!data || data >= end)
@@ -406,10 +565,12 @@ bool deserializeIDBKeyData(const uint8_t* data, size_t size, IDBKeyData& result)
     // Verify this is a SerializedIDBKey version we understand.
     const uint8_t* current = data;
     const uint8_t* end = data + size;
-    if (current++[0] != SIDBKeyVersion)
+    uint8_t version = current++[0];
+    if (version != SIDBKeyVersion && version != SIDBLittleEndianKeyVersion)
         return false;
 
-    if (decodeKey(current, end, result)) {
+    bool decoded = version == SIDBKeyVersion ? decodeOrderedKey(current, end, result) : decodeKey(current, end, result);
+    if (decoded) {
         // Even if we successfully decoded a key, the deserialize is only successful
         // if we actually consumed all input data.
         return current == end;
@@ -39,9 +39,12 @@
 #include "SQLiteStatement.h"
 #include "SecurityOrigin.h"
 #include "StorageQuotaManager.h"
+#include <wtf/Condition.h>
 #include <wtf/CrossThreadCopier.h>
 #include <wtf/Locker.h>
 #include <wtf/MainThread.h>
+#include <wtf/NumberOfCores.h>
+#include <wtf/ThreadSafeRefCounted.h>
 
 namespace WebCore {
 namespace IDBServer {
@@ -136,7 +139,7 @@ std::unique_ptr<IDBBackingStore> IDBServer::createBackingStore(const IDBDatabase
     if (databaseDirectoryPath.isEmpty())
         return MemoryIDBBackingStore::create(identifier);
 
-    return std::make_unique<SQLiteIDBBackingStore>(identifier, databaseDirectoryPath, m_backingStoreTemporaryFileHandler, m_perOriginQuota);
+    return std::make_unique<SQLiteIDBBackingStore>(identifier, databaseDirectoryPath, m_backingStoreTemporaryFileHandler, m_perOriginQuota, m_cursorPrefetchLimit);
 }
 
 void IDBServer::openDatabase(const IDBRequestData& requestData)
@@ -506,6 +509,106 @@ void IDBServer::postDatabaseTaskReply(CrossThreadTask&& task)
     postTaskReply(WTFMove(task));
 }
 
+static unsigned maximumDatabaseThreadCount()
+{
+    return std::max(2, std::min(WTF::numberOfProcessorCores(), 8));
+}
+
+IDBDatabaseThread& IDBServer::acquireDatabaseThread(const IDBDatabaseIdentifier& identifier)
+{
+    ASSERT(isMainThread());
+
+    auto addResult = m_databaseThreadAssignments.add(identifier, DatabaseThreadAssignment { });
+    auto& assignment = addResult.iterator->value;
+    if (addResult.isNewEntry) {
+        IDBDatabaseThread* thread = nullptr;
+        for (auto& databaseThread : m_databaseThreads) {
+            if (!thread || databaseThread->databaseCount() < thread->databaseCount())
+                thread = databaseThread.get();
+        }
+
+        // Start another thread while every existing one is busy with some other database.
+        if ((!thread || thread->databaseCount()) && m_databaseThreads.size() < maximumDatabaseThreadCount()) {
+            m_databaseThreads.append(std::make_unique<IDBDatabaseThread>());
+            thread = m_databaseThreads.last().get();
+        }
+
+        thread->didAssignDatabase();
+        assignment.thread = thread;
+    }
+
+    ++assignment.databaseCount;
+    return *assignment.thread;
+}
+
+void IDBServer::releaseDatabaseThread(const IDBDatabaseIdentifier& identifier)
+{
+    ASSERT(isMainThread());
+
+    auto iterator = m_databaseThreadAssignments.find(identifier);
+    ASSERT(iterator != m_databaseThreadAssignments.end());
+    if (iterator == m_databaseThreadAssignments.end())
+        return;
+
+    if (--iterator->value.databaseCount)
+        return;
+
+    iterator->value.thread->didUnassignDatabase();
+    m_databaseThreadAssignments.remove(iterator);
+}
+
+class DatabaseThreadsBarrier : public ThreadSafeRefCounted<DatabaseThreadsBarrier> {
+public:
+    static Ref<DatabaseThreadsBarrier> create(unsigned threadCount) { return adoptRef(*new DatabaseThreadsBarrier(threadCount)); }
+
+    void arrive()
+    {
+        LockHolder locker(m_lock);
+        ASSERT(m_pendingThreadCount);
+        if (!--m_pendingThreadCount)
+            m_condition.notifyAll();
+    }
+
+    void wait()
+    {
+        LockHolder locker(m_lock);
+        m_condition.wait(m_lock, [this] {
+            return !m_pendingThreadCount;
+        });
+    }
+
+private:
+    explicit DatabaseThreadsBarrier(unsigned threadCount)
+        : m_pendingThreadCount(threadCount)
+    {
+    }
+
+    Lock m_lock;
+    Condition m_condition;
+    unsigned m_pendingThreadCount;
+};
+
+void IDBServer::postDatabaseTaskAfterDatabaseThreads(CrossThreadTask&& task)
+{
+    ASSERT(isMainThread());
+
+    // Have the server thread wait until every database thread got through the tasks
+    // queued so far, like closing the backing stores of databases about to be deleted.
+    if (!m_databaseThreads.isEmpty()) {
+        auto barrier = DatabaseThreadsBarrier::create(m_databaseThreads.size());
+        for (auto& thread : m_databaseThreads) {
+            thread->postTask(CrossThreadTask([barrier = barrier.copyRef()] {
+                barrier->arrive();
+            }));
+        }
+        postDatabaseTask(CrossThreadTask([barrier = WTFMove(barrier)] {
+            barrier->wait();
+        }));
+    }
+
+    postDatabaseTask(WTFMove(task));
+}
+
 static uint64_t generateDeleteCallbackID()
 {
     ASSERT(isMainThread());
@@ -532,7 +635,7 @@ void IDBServer::closeAndDeleteDatabasesModifiedSince(WallTime modificationTime,
     for (auto& database : openDatabases)
         database->immediateCloseForUserDelete();
 
-    postDatabaseTask(createCrossThreadTask(*this, &IDBServer::performCloseAndDeleteDatabasesModifiedSince, modificationTime, callbackID));
+    postDatabaseTaskAfterDatabaseThreads(createCrossThreadTask(*this, &IDBServer::performCloseAndDeleteDatabasesModifiedSince, modificationTime, callbackID));
 }
 
 void IDBServer::closeAndDeleteDatabasesForOrigins(const Vector<SecurityOriginData>& origins, Function<void ()>&& completionHandler)
@@ -555,7 +658,7 @@ void IDBServer::closeAndDeleteDatabasesForOrigins(const Vector<SecurityOriginDat
     for (auto& database : openDatabases)
         database->immediateCloseForUserDelete();
 
-    postDatabaseTask(createCrossThreadTask(*this, &IDBServer::performCloseAndDeleteDatabasesForOrigins, origins, callbackID));
+    postDatabaseTaskAfterDatabaseThreads(createCrossThreadTask(*this, &IDBServer::performCloseAndDeleteDatabasesForOrigins, origins, callbackID));
 }
 
 static void removeAllDatabasesForFullOriginPath(const String& originPath, WallTime modifiedSince)
@@ -701,6 +804,12 @@ void IDBServer::setPerOriginQuota(uint64_t quota)
         database->setQuota(quota);
 }
 
+void IDBServer::setCursorPrefetchLimit(unsigned limit)
+{
+    ASSERT(isMainThread());
+    m_cursorPrefetchLimit = limit;
+}
+
 IDBServer::QuotaUser::QuotaUser(IDBServer& server, StorageQuotaManager* manager, ClientOrigin&& origin)
     : m_server(server)
     , m_manager(makeWeakPtr(manager))
@@ -839,9 +948,14 @@ void IDBServer::tryStop(ShouldForceStop shouldForceStop)
     if (m_sessionID.isEphemeral())
         return;
 
+    // Suspend the server thread first, it may be waiting for the database threads to
+    // get through their queued tasks.
     suspendAndWait();
+    for (auto& thread : m_databaseThreads)
+        thread->suspendAndWait();
+
     if (shouldForceStop == ShouldForceStop::No && SQLiteDatabaseTracker::hasTransactionInProgress()) {
-        CrossThreadTaskHandler::resume();
+        resume();
         return;
     }
 
@@ -854,6 +968,8 @@ void IDBServer::resume()
     if (m_sessionID.isEphemeral())
         return;
 
+    for (auto& thread : m_databaseThreads)
+        thread->resume();
     CrossThreadTaskHandler::resume();
 }
 
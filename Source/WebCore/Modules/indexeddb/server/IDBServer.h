@@ -29,6 +29,7 @@
 
 #include "IDBConnectionToClient.h"
 #include "IDBDatabaseIdentifier.h"
+#include "IDBDatabaseThread.h"
 #include "StorageQuotaManager.h"
 #include "StorageQuotaUser.h"
 #include "UniqueIDBDatabase.h"
@@ -55,6 +56,7 @@ struct IDBGetRecordData;
 namespace IDBServer {
 
 const uint64_t defaultPerOriginQuota = 500 * MB;
+const unsigned defaultCursorPrefetchLimit = 8;
 
 class IDBBackingStoreTemporaryFileHandler;
 
@@ -103,6 +105,12 @@ public:
     void postDatabaseTask(CrossThreadTask&&);
     void postDatabaseTaskReply(CrossThreadTask&&);
 
+    // UniqueIDBDatabases run their backing store work on a database thread. Every
+    // UniqueIDBDatabase for the same identifier gets the same thread, so a database that
+    // is still closing is never raced by a new one reopening the same files.
+    IDBDatabaseThread& acquireDatabaseThread(const IDBDatabaseIdentifier&);
+    void releaseDatabaseThread(const IDBDatabaseIdentifier&);
+
     void registerDatabaseConnection(UniqueIDBDatabaseConnection&);
     void unregisterDatabaseConnection(UniqueIDBDatabaseConnection&);
     void registerTransaction(UniqueIDBDatabaseTransaction&);
@@ -118,6 +126,11 @@ public:
     uint64_t perOriginQuota() const { return m_perOriginQuota; }
     WEBCORE_EXPORT void setPerOriginQuota(uint64_t);
 
+    // How many records past the current one a cursor fetches and sends to the client with
+    // each result. Applies to databases opened after the call.
+    unsigned cursorPrefetchLimit() const { return m_cursorPrefetchLimit; }
+    WEBCORE_EXPORT void setCursorPrefetchLimit(unsigned);
+
     void requestSpace(const ClientOrigin&, uint64_t taskSize, CompletionHandler<void(StorageQuotaManager::Decision)>&&);
     void increasePotentialSpaceUsed(const ClientOrigin&, uint64_t taskSize);
     void decreasePotentialSpaceUsed(const ClientOrigin&, uint64_t taskSize);
@@ -140,6 +153,8 @@ private:
     void performGetAllDatabaseNames(uint64_t serverConnectionIdentifier, const SecurityOriginData& mainFrameOrigin, const SecurityOriginData& openingOrigin, uint64_t callbackID);
     void didGetAllDatabaseNames(uint64_t serverConnectionIdentifier, uint64_t callbackID, const Vector<String>& databaseNames);
 
+    void postDatabaseTaskAfterDatabaseThreads(CrossThreadTask&&);
+
     void performCloseAndDeleteDatabasesModifiedSince(WallTime, uint64_t callbackID);
     void performCloseAndDeleteDatabasesForOrigins(const Vector<SecurityOriginData>&, uint64_t callbackID);
     void didPerformCloseAndDeleteDatabases(uint64_t callbackID);
@@ -190,6 +205,13 @@ private:
     HashMap<uint64_t, RefPtr<IDBConnectionToClient>> m_connectionMap;
     HashMap<IDBDatabaseIdentifier, std::unique_ptr<UniqueIDBDatabase>> m_uniqueIDBDatabaseMap;
 
+    struct DatabaseThreadAssignment {
+        IDBDatabaseThread* thread { nullptr };
+        unsigned databaseCount { 0 };
+    };
+    Vector<std::unique_ptr<IDBDatabaseThread>> m_databaseThreads;
+    HashMap<IDBDatabaseIdentifier, DatabaseThreadAssignment> m_databaseThreadAssignments;
+
     HashMap<uint64_t, UniqueIDBDatabaseConnection*> m_databaseConnections;
     HashMap<IDBResourceIdentifier, UniqueIDBDatabaseTransaction*> m_transactions;
 
@@ -199,6 +221,7 @@ private:
     IDBBackingStoreTemporaryFileHandler& m_backingStoreTemporaryFileHandler;
 
     uint64_t m_perOriginQuota { defaultPerOriginQuota };
+    unsigned m_cursorPrefetchLimit { defaultCursorPrefetchLimit };
 
     HashMap<ClientOrigin, std::unique_ptr<QuotaUser>> m_quotaUsers;
     QuotaManagerGetter m_quotaManagerGetter;
@@ -65,6 +65,10 @@ static const int currentMetadataVersion = 1;
 // The IndexedDatabase spec defines the max key generator value as 2^53.
 static const uint64_t maxGeneratorValue = 0x20000000000000;
 
+// Cursors and gets read record values in place from the mapped file instead of copying them
+// through the page cache. Each database has its own connection, so this is address space per database.
+static const int64_t databaseMemoryMapSize = 32 * MB;
+
 static int idbKeyCollate(int aLength, const void* aBuffer, int bLength, const void* bBuffer)
 {
     IDBKeyData a, b;
@@ -137,6 +141,23 @@ static const String& v3RecordsTableSchemaAlternate()
     return v3RecordsTableSchemaString;
 }
 
+static const String v4RecordsTableSchema(const String& tableName)
+{
+    return makeString("CREATE TABLE ", tableName, " (objectStoreID INTEGER NOT NULL ON CONFLICT FAIL, key TEXT NOT NULL ON CONFLICT FAIL, value NOT NULL ON CONFLICT FAIL, recordID INTEGER PRIMARY KEY)");
+}
+
+static const String& v4RecordsTableSchema()
+{
+    static NeverDestroyed<WTF::String> v4RecordsTableSchemaString(v4RecordsTableSchema("Records"));
+    return v4RecordsTableSchemaString;
+}
+
+static const String& v4RecordsTableSchemaAlternate()
+{
+    static NeverDestroyed<WTF::String> v4RecordsTableSchemaString(v4RecordsTableSchema("\"Records\""));
+    return v4RecordsTableSchemaString;
+}
+
 static const String v1IndexRecordsTableSchema(const String& tableName)
 {
     return makeString("CREATE TABLE ", tableName, " (indexID INTEGER NOT NULL ON CONFLICT FAIL, objectStoreID INTEGER NOT NULL ON CONFLICT FAIL, key TEXT COLLATE IDBKEY NOT NULL ON CONFLICT FAIL, value NOT NULL ON CONFLICT FAIL)");
@@ -188,6 +209,23 @@ static const String v3IndexRecordsTableSchemaAlternate()
     return indexRecordsTableSchemaString;
 }
 
+static const String v4IndexRecordsTableSchema(const String& tableName)
+{
+    return makeString("CREATE TABLE ", tableName, " (indexID INTEGER NOT NULL ON CONFLICT FAIL, objectStoreID INTEGER NOT NULL ON CONFLICT FAIL, key TEXT NOT NULL ON CONFLICT FAIL, value TEXT NOT NULL ON CONFLICT FAIL, objectStoreRecordID INTEGER NOT NULL ON CONFLICT FAIL)");
+}
+
+static const String v4IndexRecordsTableSchema()
+{
+    static NeverDestroyed<WTF::String> indexRecordsTableSchemaString = v4IndexRecordsTableSchema("IndexRecords");
+    return indexRecordsTableSchemaString;
+}
+
+static const String v4IndexRecordsTableSchemaAlternate()
+{
+    static NeverDestroyed<WTF::String> indexRecordsTableSchemaString = v4IndexRecordsTableSchema("\"IndexRecords\"");
+    return indexRecordsTableSchemaString;
+}
+
 static const String& v1IndexRecordsIndexSchema()
 {
     static NeverDestroyed<WTF::String> indexRecordsIndexSchemaString("CREATE INDEX IndexRecordsIndex ON IndexRecords (key)");
@@ -228,11 +266,12 @@ static const String& blobFilesTableSchemaAlternate()
     return blobFilesTableSchemaString;
 }
 
-SQLiteIDBBackingStore::SQLiteIDBBackingStore(const IDBDatabaseIdentifier& identifier, const String& databaseRootDirectory, IDBBackingStoreTemporaryFileHandler& fileHandler, uint64_t quota)
+SQLiteIDBBackingStore::SQLiteIDBBackingStore(const IDBDatabaseIdentifier& identifier, const String& databaseRootDirectory, IDBBackingStoreTemporaryFileHandler& fileHandler, uint64_t quota, unsigned cursorPrefetchLimit)
     : m_identifier(identifier)
     , m_databaseRootDirectory(databaseRootDirectory)
     , m_temporaryFileHandler(fileHandler)
     , m_quota(quota)
+    , m_cursorPrefetchLimit(cursorPrefetchLimit)
 {
     m_databaseDirectory = fullDatabaseDirectoryWithUpgrade();
 }
@@ -288,7 +327,7 @@ static bool createOrMigrateRecordsTableIfNecessary(SQLiteDatabase& database)
 
         // If there is no Records table at all, create it and then bail.
         if (sqliteResult == SQLITE_DONE) {
-            if (!database.executeCommand(v3RecordsTableSchema())) {
+            if (!database.executeCommand(v4RecordsTableSchema())) {
                 LOG_ERROR("Could not create Records table in database (%i) - %s", database.lastError(), database.lastErrorMsg());
                 return false;
             }
@@ -307,7 +346,9 @@ static bool createOrMigrateRecordsTableIfNecessary(SQLiteDatabase& database)
     ASSERT(!currentSchema.isEmpty());
 
     // If the schema in the backing store is the current schema, we're done.
-    if (currentSchema == v3RecordsTableSchema() || currentSchema == v3RecordsTableSchemaAlternate())
+    // A v3 table only differs in its key encoding, ensureValidKeyEncoding() rewrites it.
+    if (currentSchema == v4RecordsTableSchema() || currentSchema == v4RecordsTableSchemaAlternate()
+        || currentSchema == v3RecordsTableSchema() || currentSchema == v3RecordsTableSchemaAlternate())
         return true;
 
     // If the record table is not the current schema then it must be one of the previous schemas.
@@ -453,7 +494,7 @@ bool SQLiteIDBBackingStore::ensureValidIndexRecordsTable()
 
         // If there is no IndexRecords table at all, create it and then bail.
         if (sqliteResult == SQLITE_DONE) {
-            if (!m_sqliteDB->executeCommand(v3IndexRecordsTableSchema())) {
+            if (!m_sqliteDB->executeCommand(v4IndexRecordsTableSchema())) {
                 LOG_ERROR("Could not create IndexRecords table in database (%i) - %s", m_sqliteDB->lastError(), m_sqliteDB->lastErrorMsg());
                 return false;
             }
@@ -472,7 +513,9 @@ bool SQLiteIDBBackingStore::ensureValidIndexRecordsTable()
     ASSERT(!currentSchema.isEmpty());
 
     // If the schema in the backing store is the current schema, we're done.
-    if (currentSchema == v3IndexRecordsTableSchema() || currentSchema == v3IndexRecordsTableSchemaAlternate())
+    // A v3 table only differs in its key encoding, ensureValidKeyEncoding() rewrites it.
+    if (currentSchema == v4IndexRecordsTableSchema() || currentSchema == v4IndexRecordsTableSchemaAlternate()
+        || currentSchema == v3IndexRecordsTableSchema() || currentSchema == v3IndexRecordsTableSchemaAlternate())
         return true;
 
     // If the record table is not the current schema then it must be one of the previous schemas.
@@ -510,6 +553,180 @@ bool SQLiteIDBBackingStore::ensureValidIndexRecordsTable()
     return true;
 }
 
+static bool fetchTableSchema(SQLiteDatabase& database, const String& tableName, String& schema)
+{
+    SQLiteStatement statement(database, makeString("SELECT sql FROM sqlite_master WHERE type='table' AND tbl_name='", tableName, '\''));
+    if (statement.prepare() != SQLITE_OK)
+        return false;
+
+    int sqliteResult = statement.step();
+    if (sqliteResult == SQLITE_ROW)
+        schema = statement.getColumnText(0);
+    return sqliteResult == SQLITE_ROW || sqliteResult == SQLITE_DONE;
+}
+
+// Rewrites a key column written by serializeIDBKeyData() before keys were stored in their memcmp() ordered encoding.
+static RefPtr<SharedBuffer> reserializeKeyColumn(SQLiteStatement& statement, int column)
+{
+    Vector<uint8_t> keyBuffer;
+    statement.getColumnBlobAsVector(column, keyBuffer);
+
+    IDBKeyData keyData;
+    if (!deserializeIDBKeyData(keyBuffer.data(), keyBuffer.size(), keyData))
+        return nullptr;
+
+    return serializeIDBKeyData(keyData);
+}
+
+static bool migrateRecordsTableToOrderedKeys(SQLiteDatabase& database)
+{
+    if (!database.executeCommand(v4RecordsTableSchema("_Temp_Records"))) {
+        LOG_ERROR("Could not create temporary records table in database (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    {
+        SQLiteStatement select(database, "SELECT objectStoreID, key, value, recordID FROM Records;"_s);
+        SQLiteStatement insert(database, "INSERT INTO _Temp_Records VALUES (?, CAST(? AS TEXT), ?, ?);"_s);
+        if (select.prepare() != SQLITE_OK || insert.prepare() != SQLITE_OK) {
+            LOG_ERROR("Could not prepare statements to migrate Records keys (%i) - %s", database.lastError(), database.lastErrorMsg());
+            return false;
+        }
+
+        Vector<uint8_t> valueBuffer;
+        int sqliteResult;
+        while ((sqliteResult = select.step()) == SQLITE_ROW) {
+            auto keyBuffer = reserializeKeyColumn(select, 1);
+            if (!keyBuffer) {
+                LOG_ERROR("Unable to deserialize key while migrating Records table");
+                return false;
+            }
+
+            select.getColumnBlobAsVector(2, valueBuffer);
+            if (insert.bindInt64(1, select.getColumnInt64(0)) != SQLITE_OK
+                || insert.bindBlob(2, keyBuffer->data(), keyBuffer->size()) != SQLITE_OK
+                || insert.bindBlob(3, valueBuffer.data(), valueBuffer.size()) != SQLITE_OK
+                || insert.bindInt64(4, select.getColumnInt64(3)) != SQLITE_OK
+                || insert.step() != SQLITE_DONE) {
+                LOG_ERROR("Could not migrate existing Records content (%i) - %s", database.lastError(), database.lastErrorMsg());
+                return false;
+            }
+            insert.reset();
+        }
+
+        if (sqliteResult != SQLITE_DONE) {
+            LOG_ERROR("Error reading existing Records content (%i) - %s", database.lastError(), database.lastErrorMsg());
+            return false;
+        }
+    }
+
+    if (!database.executeCommand("DROP TABLE Records")) {
+        LOG_ERROR("Could not drop existing Records table (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    if (!database.executeCommand("ALTER TABLE _Temp_Records RENAME TO Records")) {
+        LOG_ERROR("Could not rename temporary Records table (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    // Dropping the table also dropped its uniqueness index.
+    if (!database.executeCommand("CREATE UNIQUE INDEX IF NOT EXISTS RecordsIndex ON Records (objectStoreID, key);")) {
+        LOG_ERROR("Could not create RecordsIndex on Records table in database (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    return true;
+}
+
+static bool migrateIndexRecordsTableToOrderedKeys(SQLiteDatabase& database)
+{
+    if (!database.executeCommand(v4IndexRecordsTableSchema("_Temp_IndexRecords"))) {
+        LOG_ERROR("Could not create temporary index records table in database (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    {
+        SQLiteStatement select(database, "SELECT indexID, objectStoreID, key, value, objectStoreRecordID FROM IndexRecords;"_s);
+        SQLiteStatement insert(database, "INSERT INTO _Temp_IndexRecords VALUES (?, ?, CAST(? AS TEXT), CAST(? AS TEXT), ?);"_s);
+        if (select.prepare() != SQLITE_OK || insert.prepare() != SQLITE_OK) {
+            LOG_ERROR("Could not prepare statements to migrate IndexRecords keys (%i) - %s", database.lastError(), database.lastErrorMsg());
+            return false;
+        }
+
+        int sqliteResult;
+        while ((sqliteResult = select.step()) == SQLITE_ROW) {
+            auto indexKeyBuffer = reserializeKeyColumn(select, 2);
+            auto valueBuffer = reserializeKeyColumn(select, 3);
+            if (!indexKeyBuffer || !valueBuffer) {
+                LOG_ERROR("Unable to deserialize key while migrating IndexRecords table");
+                return false;
+            }
+
+            if (insert.bindInt64(1, select.getColumnInt64(0)) != SQLITE_OK
+                || insert.bindInt64(2, select.getColumnInt64(1)) != SQLITE_OK
+                || insert.bindBlob(3, indexKeyBuffer->data(), indexKeyBuffer->size()) != SQLITE_OK
+                || insert.bindBlob(4, valueBuffer->data(), valueBuffer->size()) != SQLITE_OK
+                || insert.bindInt64(5, select.getColumnInt64(4)) != SQLITE_OK
+                || insert.step() != SQLITE_DONE) {
+                LOG_ERROR("Could not migrate existing IndexRecords content (%i) - %s", database.lastError(), database.lastErrorMsg());
+                return false;
+            }
+            insert.reset();
+        }
+
+        if (sqliteResult != SQLITE_DONE) {
+            LOG_ERROR("Error reading existing IndexRecords content (%i) - %s", database.lastError(), database.lastErrorMsg());
+            return false;
+        }
+    }
+
+    if (!database.executeCommand("DROP TABLE IndexRecords")) {
+        LOG_ERROR("Could not drop existing IndexRecords table (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    if (!database.executeCommand("ALTER TABLE _Temp_IndexRecords RENAME TO IndexRecords")) {
+        LOG_ERROR("Could not rename temporary IndexRecords table (%i) - %s", database.lastError(), database.lastErrorMsg());
+        return false;
+    }
+
+    return true;
+}
+
+bool SQLiteIDBBackingStore::ensureValidKeyEncoding()
+{
+    ASSERT(m_sqliteDB);
+    ASSERT(m_sqliteDB->isOpen());
+
+    // v3 tables store keys in the old serialization and compare them through the IDBKEY collation.
+    // Both tables are rewritten together since IndexRecords values are Records keys.
+    String recordsSchema;
+    String indexRecordsSchema;
+    if (!fetchTableSchema(*m_sqliteDB, "Records"_s, recordsSchema) || !fetchTableSchema(*m_sqliteDB, "IndexRecords"_s, indexRecordsSchema)) {
+        LOG_ERROR("Unable to fetch schema for the Records and IndexRecords tables.");
+        return false;
+    }
+
+    bool migrateRecords = recordsSchema == v3RecordsTableSchema() || recordsSchema == v3RecordsTableSchemaAlternate();
+    bool migrateIndexRecords = indexRecordsSchema == v3IndexRecordsTableSchema() || indexRecordsSchema == v3IndexRecordsTableSchemaAlternate();
+    if (!migrateRecords && !migrateIndexRecords)
+        return true;
+
+    SQLiteTransaction transaction(*m_sqliteDB);
+    transaction.begin();
+
+    if (migrateRecords && !migrateRecordsTableToOrderedKeys(*m_sqliteDB))
+        return false;
+
+    if (migrateIndexRecords && !migrateIndexRecordsTableToOrderedKeys(*m_sqliteDB))
+        return false;
+
+    transaction.commit();
+
+    return true;
+}
+
 bool SQLiteIDBBackingStore::ensureValidIndexRecordsIndex()
 {
     ASSERT(m_sqliteDB);
@@ -830,6 +1047,10 @@ IDBError SQLiteIDBBackingStore::getOrEstablishDatabaseInfo(IDBDatabaseInfo& info
     if (!m_sqliteDB)
         return IDBError { UnknownError, "Unable to open database file on disk"_s };
 
+    m_sqliteDB->setMemoryMapSize(databaseMemoryMapSize);
+
+    // Keys are now stored in an encoding that sorts with the default BINARY collation, IDBKEY is
+    // only needed to read and migrate tables created before that.
     m_sqliteDB->setCollationFunction("IDBKEY", [](int aLength, const void* a, int bLength, const void* b) {
         return idbKeyCollate(aLength, a, bLength, b);
     });
@@ -846,6 +1067,12 @@ IDBError SQLiteIDBBackingStore::getOrEstablishDatabaseInfo(IDBDatabaseInfo& info
         return IDBError { UnknownError, "Error creating or migrating Index Records table in database"_s };
     }
 
+    if (!ensureValidKeyEncoding()) {
+        LOG_ERROR("Error migrating record keys in database");
+        closeSQLiteDB();
+        return IDBError { UnknownError, "Error migrating record keys in database"_s };
+    }
+
     if (!ensureValidIndexRecordsIndex()) {
         LOG_ERROR("Error creating or migrating Index Records index in database");
         closeSQLiteDB();
@@ -1264,8 +1491,7 @@ IDBError SQLiteIDBBackingStore::createIndex(const IDBResourceIdentifier& transac
 
     while (!cursor->currentKey().isNull()) {
         auto& key = cursor->currentKey();
-        auto* value = cursor->currentValue();
-        ThreadSafeDataBuffer valueBuffer = value ? value->data() : ThreadSafeDataBuffer();
+        auto& valueBuffer = cursor->currentValue().data();
 
         ASSERT(cursor->currentRecordRowID());
 
@@ -2264,7 +2490,7 @@ IDBError SQLiteIDBBackingStore::getAllIndexRecords(const IDBResourceIdentifier&
         IDBKeyData keyCopy = cursor->currentPrimaryKey();
         result.addKey(WTFMove(keyCopy));
         if (getAllRecordsData.getAllType == IndexedDB::GetAllType::Values)
-            result.addValue(cursor->currentValue() ? *cursor->currentValue() : IDBValue());
+            result.addValue(IDBValue(cursor->currentValue()));
 
         ++currentCount;
         cursor->advance(1);
@@ -2311,7 +2537,7 @@ IDBError SQLiteIDBBackingStore::getIndexRecord(const IDBResourceIdentifier& tran
         else {
             auto* objectStoreInfo = infoForObjectStore(objectStoreID);
             ASSERT(objectStoreInfo);
-            getResult = { cursor->currentPrimaryKey(), cursor->currentPrimaryKey(), cursor->currentValue() ? *cursor->currentValue() : IDBValue(), objectStoreInfo->keyPath() };
+            getResult = { cursor->currentPrimaryKey(), cursor->currentPrimaryKey(), IDBValue(cursor->currentValue()), objectStoreInfo->keyPath() };
         }
     }
 
@@ -2537,7 +2763,7 @@ IDBError SQLiteIDBBackingStore::openCursor(const IDBResourceIdentifier& transact
 
     auto* objectStoreInfo = infoForObjectStore(info.objectStoreIdentifier());
     ASSERT(objectStoreInfo);
-    cursor->currentData(result, objectStoreInfo->keyPath());
+    cursor->currentData(result, objectStoreInfo->keyPath(), ShouldIncludePrefetchedRecords::Yes);
     return IDBError { };
 }
 
@@ -2578,9 +2804,13 @@ IDBError SQLiteIDBBackingStore::iterateCursor(const IDBResourceIdentifier& trans
         }
     }
 
+    // The client already has the record this iteration lands on.
+    if (data.option == IndexedDB::CursorIterateOption::DoNotReply)
+        return IDBError { };
+
     auto* objectStoreInfo = infoForObjectStore(cursor->objectStoreID());
     ASSERT(objectStoreInfo);
-    cursor->currentData(result, objectStoreInfo->keyPath());
+    cursor->currentData(result, objectStoreInfo->keyPath(), ShouldIncludePrefetchedRecords::Yes);
     return IDBError { };
 }
 
@@ -48,7 +48,7 @@ class SQLiteIDBCursor;
 class SQLiteIDBBackingStore : public IDBBackingStore {
     WTF_MAKE_FAST_ALLOCATED;
 public:
-    SQLiteIDBBackingStore(const IDBDatabaseIdentifier&, const String& databaseRootDirectory, IDBBackingStoreTemporaryFileHandler&, uint64_t quota);
+    SQLiteIDBBackingStore(const IDBDatabaseIdentifier&, const String& databaseRootDirectory, IDBBackingStoreTemporaryFileHandler&, uint64_t quota, unsigned cursorPrefetchLimit);
     
     ~SQLiteIDBBackingStore() final;
 
@@ -89,6 +89,9 @@ public:
 
     void unregisterCursor(SQLiteIDBCursor&);
 
+    // Number of records a cursor fetches ahead of its current record.
+    unsigned cursorPrefetchLimit() const { return m_cursorPrefetchLimit; }
+
     IDBBackingStoreTemporaryFileHandler& temporaryFileHandler() const { return m_temporaryFileHandler; }
 
     IDBError getBlobRecordsForObjectStoreRecord(int64_t objectStoreRecord, Vector<String>& blobURLs, PAL::SessionID&, Vector<String>& blobFilePaths);
@@ -113,6 +116,7 @@ private:
 
     bool ensureValidRecordsTable();
     bool ensureValidIndexRecordsTable();
+    bool ensureValidKeyEncoding();
     bool ensureValidIndexRecordsIndex();
     bool ensureValidBlobTables();
     std::unique_ptr<IDBDatabaseInfo> createAndPopulateInitialDatabaseInfo();
@@ -211,6 +215,7 @@ private:
     IDBBackingStoreTemporaryFileHandler& m_temporaryFileHandler;
     
     uint64_t m_quota;
+    unsigned m_cursorPrefetchLimit;
 };
 
 } // namespace IDBServer
@@ -42,8 +42,6 @@
 namespace WebCore {
 namespace IDBServer {
 
-static const size_t prefetchLimit = 8;
-
 std::unique_ptr<SQLiteIDBCursor> SQLiteIDBCursor::maybeCreate(SQLiteIDBTransaction& transaction, const IDBCursorInfo& info)
 {
     auto cursor = std::make_unique<SQLiteIDBCursor>(transaction, info);
@@ -101,7 +99,7 @@ SQLiteIDBCursor::~SQLiteIDBCursor()
         m_transaction->closeCursor(*this);
 }
 
-void SQLiteIDBCursor::currentData(IDBGetResult& result, const Optional<IDBKeyPath>& keyPath)
+void SQLiteIDBCursor::currentData(IDBGetResult& result, const Optional<IDBKeyPath>& keyPath, ShouldIncludePrefetchedRecords shouldIncludePrefetchedRecords)
 {
     ASSERT(!m_fetchedRecords.isEmpty());
 
@@ -112,7 +110,15 @@ void SQLiteIDBCursor::currentData(IDBGetResult& result, const Optional<IDBKeyPat
         return;
     }
 
-    result = { currentRecord.record.key, currentRecord.record.primaryKey, currentRecord.record.value ? *currentRecord.record.value : IDBValue(), keyPath};
+    result = { currentRecord.record.key, currentRecord.record.primaryKey, IDBValue(currentRecord.record.value), keyPath };
+
+    if (shouldIncludePrefetchedRecords == ShouldIncludePrefetchedRecords::No)
+        return;
+
+    Vector<IDBCursorRecord> prefetchedRecords;
+    for (auto iterator = ++m_fetchedRecords.begin(); iterator != m_fetchedRecords.end() && !iterator->isTerminalRecord(); ++iterator)
+        prefetchedRecords.append(iterator->record);
+    result.setPrefetchedRecords(WTFMove(prefetchedRecords));
 }
 
 static String buildIndexStatement(const IDBKeyRangeData& keyRange, IndexedDB::CursorDirection cursorDirection)
@@ -303,17 +309,23 @@ bool SQLiteIDBCursor::bindArguments()
     return true;
 }
 
+size_t SQLiteIDBCursor::prefetchLimit() const
+{
+    // The current record is kept in m_fetchedRecords as well.
+    return m_transaction->backingStore().cursorPrefetchLimit() + 1;
+}
+
 bool SQLiteIDBCursor::prefetch()
 {
     LOG(IndexedDB, "SQLiteIDBCursor::prefetch() - Cursor already has %zu fetched records", m_fetchedRecords.size());
 
-    if (m_fetchedRecords.isEmpty() || m_fetchedRecords.size() >= prefetchLimit || m_fetchedRecords.last().isTerminalRecord())
+    if (m_fetchedRecords.isEmpty() || m_fetchedRecords.size() >= prefetchLimit() || m_fetchedRecords.last().isTerminalRecord())
         return false;
 
     m_currentKeyForUniqueness = m_fetchedRecords.last().record.key;
     fetch();
 
-    return m_fetchedRecords.size() < prefetchLimit;
+    return m_fetchedRecords.size() < prefetchLimit();
 }
 
 bool SQLiteIDBCursor::advance(uint64_t count)
@@ -420,7 +432,7 @@ SQLiteIDBCursor::FetchResult SQLiteIDBCursor::internalFetchNextRecord(SQLiteCurs
     ASSERT(!m_fetchedRecords.isEmpty());
     ASSERT(!m_fetchedRecords.last().isTerminalRecord());
 
-    record.record.value = nullptr;
+    record.record.value = { };
 
     int result = m_statement->step();
     if (result == SQLITE_DONE) {
@@ -465,7 +477,7 @@ SQLiteIDBCursor::FetchResult SQLiteIDBCursor::internalFetchNextRecord(SQLiteCurs
         }
 
         if (m_cursorType == IndexedDB::CursorType::KeyAndValue)
-            record.record.value = std::make_unique<IDBValue>(ThreadSafeDataBuffer::create(WTFMove(keyData)), blobURLs, sessionID, blobFilePaths);
+            record.record.value = { ThreadSafeDataBuffer::create(WTFMove(keyData)), blobURLs, sessionID, blobFilePaths };
     } else {
         if (!deserializeIDBKeyData(keyData.data(), keyData.size(), record.record.primaryKey)) {
             LOG_ERROR("Unable to deserialize value data from database while advancing index cursor");
@@ -473,9 +485,20 @@ SQLiteIDBCursor::FetchResult SQLiteIDBCursor::internalFetchNextRecord(SQLiteCurs
             return FetchResult::Failure;
         }
 
-        SQLiteStatement objectStoreStatement(m_statement->database(), "SELECT value FROM Records WHERE key = CAST(? AS TEXT) and objectStoreID = ?;");
+        // Index cursors look up the value of every record they visit, so keep that statement
+        // prepared for the lifetime of the cursor.
+        if (!m_objectStoreRecordStatement) {
+            m_objectStoreRecordStatement = std::make_unique<SQLiteStatement>(m_statement->database(), "SELECT value FROM Records WHERE key = CAST(? AS TEXT) and objectStoreID = ?;");
+            if (m_objectStoreRecordStatement->prepare() != SQLITE_OK) {
+                LOG_ERROR("Could not create index cursor statement into object store records (%i) '%s'", m_statement->database().lastError(), m_statement->database().lastErrorMsg());
+                m_objectStoreRecordStatement = nullptr;
+                markAsErrored(record);
+                return FetchResult::Failure;
+            }
+        }
 
-        if (objectStoreStatement.prepare() != SQLITE_OK
+        auto& objectStoreStatement = *m_objectStoreRecordStatement;
+        if (objectStoreStatement.reset() != SQLITE_OK
             || objectStoreStatement.bindBlob(1, keyData.data(), keyData.size()) != SQLITE_OK
             || objectStoreStatement.bindInt64(2, m_objectStoreID) != SQLITE_OK) {
             LOG_ERROR("Could not create index cursor statement into object store records (%i) '%s'", m_statement->database().lastError(), m_statement->database().lastErrorMsg());
@@ -487,7 +510,7 @@ SQLiteIDBCursor::FetchResult SQLiteIDBCursor::internalFetchNextRecord(SQLiteCurs
 
         if (result == SQLITE_ROW) {
             objectStoreStatement.getColumnBlobAsVector(0, keyData);
-            record.record.value = std::make_unique<IDBValue>(ThreadSafeDataBuffer::create(WTFMove(keyData)));
+            record.record.value = { ThreadSafeDataBuffer::create(WTFMove(keyData)) };
         } else if (result == SQLITE_DONE) {
             // This indicates that the record we're trying to retrieve has been removed from the object store.
             // Skip over it.
@@ -560,10 +583,10 @@ const IDBKeyData& SQLiteIDBCursor::currentPrimaryKey() const
     return m_fetchedRecords.first().record.primaryKey;
 }
 
-IDBValue* SQLiteIDBCursor::currentValue() const
+const IDBValue& SQLiteIDBCursor::currentValue() const
 {
     ASSERT(!m_fetchedRecords.isEmpty());
-    return m_fetchedRecords.first().record.value.get();
+    return m_fetchedRecords.first().record.value;
 }
 
 bool SQLiteIDBCursor::didComplete() const
@@ -45,6 +45,7 @@ class IDBGetResult;
 namespace IDBServer {
 
 enum class ShouldFetchForSameKey : bool { No, Yes };
+enum class ShouldIncludePrefetchedRecords : bool { No, Yes };
 
 class SQLiteIDBTransaction;
 
@@ -68,7 +69,7 @@ public:
 
     const IDBKeyData& currentKey() const;
     const IDBKeyData& currentPrimaryKey() const;
-    IDBValue* currentValue() const;
+    const IDBValue& currentValue() const;
 
     bool advance(uint64_t count);
     bool iterate(const IDBKeyData& targetKey, const IDBKeyData& targetPrimaryKey);
@@ -79,7 +80,7 @@ public:
 
     void objectStoreRecordsChanged();
 
-    void currentData(IDBGetResult&, const Optional<IDBKeyPath>&);
+    void currentData(IDBGetResult&, const Optional<IDBKeyPath>&, ShouldIncludePrefetchedRecords = ShouldIncludePrefetchedRecords::No);
 
 private:
     bool establishStatement();
@@ -88,6 +89,8 @@ private:
 
     void resetAndRebindStatement();
 
+    size_t prefetchLimit() const;
+
     enum class FetchResult {
         Success,
         Failure,
@@ -123,6 +126,7 @@ private:
     IDBKeyData m_currentKeyForUniqueness;
 
     std::unique_ptr<SQLiteStatement> m_statement;
+    std::unique_ptr<SQLiteStatement> m_objectStoreRecordStatement;
     bool m_statementNeedsReset { true };
     int64_t m_boundID { 0 };
 
@@ -109,6 +109,7 @@ static inline uint64_t estimateSize(const IDBObjectStoreInfo& info)
 UniqueIDBDatabase::UniqueIDBDatabase(IDBServer& server, const IDBDatabaseIdentifier& identifier)
     : m_server(server)
     , m_identifier(identifier)
+    , m_databaseThread(server.acquireDatabaseThread(identifier))
     , m_operationAndTransactionTimer(*this, &UniqueIDBDatabase::operationAndTransactionTimerFired)
 {
     LOG(IndexedDB, "UniqueIDBDatabase::UniqueIDBDatabase() (%p) %s", this, m_identifier.debugString().utf8().data());
@@ -128,6 +129,8 @@ UniqueIDBDatabase::~UniqueIDBDatabase()
     RELEASE_ASSERT(m_databaseQueue.isKilled());
     RELEASE_ASSERT(m_databaseReplyQueue.isKilled());
     RELEASE_ASSERT(!m_backingStore);
+
+    m_server->releaseDatabaseThread(m_identifier);
 }
 
 const IDBDatabaseInfo& UniqueIDBDatabase::info() const
@@ -2087,7 +2090,7 @@ void UniqueIDBDatabase::transactionCompleted(RefPtr<UniqueIDBDatabaseTransaction
 void UniqueIDBDatabase::postDatabaseTask(CrossThreadTask&& task)
 {
     m_databaseQueue.append(WTFMove(task));
-    m_server->postDatabaseTask(createCrossThreadTask(*this, &UniqueIDBDatabase::executeNextDatabaseTask));
+    m_databaseThread.postTask(createCrossThreadTask(*this, &UniqueIDBDatabase::executeNextDatabaseTask));
 }
 
 void UniqueIDBDatabase::postDatabaseTaskReply(CrossThreadTask&& task)
@@ -2096,7 +2099,7 @@ void UniqueIDBDatabase::postDatabaseTaskReply(CrossThreadTask&& task)
     if (m_backingStore)
         m_databasesSizeForOrigin = m_backingStore->databasesSizeForOrigin();
     m_databaseReplyQueue.append(WTFMove(task));
-    m_server->postDatabaseTaskReply(createCrossThreadTask(*this, &UniqueIDBDatabase::executeNextDatabaseTaskReply));
+    m_databaseThread.postTaskReply(createCrossThreadTask(*this, &UniqueIDBDatabase::executeNextDatabaseTaskReply));
 }
 
 void UniqueIDBDatabase::executeNextDatabaseTask()
@@ -29,6 +29,7 @@
 
 #include "IDBBackingStore.h"
 #include "IDBDatabaseIdentifier.h"
+#include "IDBDatabaseThread.h"
 #include "IDBDatabaseInfo.h"
 #include "IDBGetResult.h"
 #include "ServerOpenDBRequest.h"
@@ -263,6 +264,7 @@ private:
 
     Ref<IDBServer> m_server;
     IDBDatabaseIdentifier m_identifier;
+    IDBDatabaseThread& m_databaseThread;
 
     ListHashSet<RefPtr<ServerOpenDBRequest>> m_pendingOpenDBRequests;
     RefPtr<ServerOpenDBRequest> m_currentOpenDBRequest;
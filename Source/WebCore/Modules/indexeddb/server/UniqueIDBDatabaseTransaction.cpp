@@ -114,6 +114,17 @@ void UniqueIDBDatabaseTransaction::commit()
     if (!database || database->hardClosedForUserDelete())
         return;
 
+    // A cursor lost track of the client after an iteration the client answered from
+    // prefetched records, so the page may have acted on the wrong records. Roll back
+    // and fail the commit with that error; the client then aborts the transaction.
+    if (!m_cursorErrors.isEmpty()) {
+        database->abortTransaction(*this, UniqueIDBDatabase::WaitForPendingTasks::Yes, [this, protectedThis, cursorError = m_cursorErrors.begin()->value](const IDBError&) {
+            LOG(IndexedDB, "UniqueIDBDatabaseTransaction::commit (abort callback)");
+            m_databaseConnection->didCommitTransaction(*this, cursorError);
+        });
+        return;
+    }
+
     database->commitTransaction(*this, [this, protectedThis](const IDBError& error) {
         LOG(IndexedDB, "UniqueIDBDatabaseTransaction::commit (callback)");
         m_databaseConnection->didCommitTransaction(*this, error);
@@ -405,10 +416,21 @@ void UniqueIDBDatabaseTransaction::iterateCursor(const IDBRequestData& requestDa
     auto database = m_databaseConnection->database();
     ASSERT(database);
     
-    database->iterateCursor(requestData, data, [this, protectedThis, requestData](const IDBError& error, const IDBGetResult& result) {
+    database->iterateCursor(requestData, data, [this, protectedThis, requestData, option = data.option](const IDBError& error, const IDBGetResult& result) {
         LOG(IndexedDB, "UniqueIDBDatabaseTransaction::iterateCursor (callback)");
 
-        if (error.isNull())
+        // The client completed this request from records it had prefetched. If the server
+        // cursor failed to follow, it no longer is where the client thinks it is.
+        if (option == IndexedDB::CursorIterateOption::DoNotReply) {
+            if (!error.isNull())
+                m_cursorErrors.add(requestData.cursorIdentifier(), error);
+            return;
+        }
+
+        auto cursorError = m_cursorErrors.take(requestData.cursorIdentifier());
+        if (!cursorError.isNull())
+            m_databaseConnection->connectionToClient().didIterateCursor(IDBResultData::error(requestData.requestIdentifier(), cursorError));
+        else if (error.isNull())
             m_databaseConnection->connectionToClient().didIterateCursor(IDBResultData::iterateCursorSuccess(requestData.requestIdentifier(), result));
         else
             m_databaseConnection->connectionToClient().didIterateCursor(IDBResultData::error(requestData.requestIdentifier(), error));
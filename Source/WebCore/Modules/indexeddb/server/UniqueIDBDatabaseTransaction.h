@@ -28,7 +28,9 @@
 #if ENABLE(INDEXED_DATABASE)
 
 #include "IDBError.h"
+#include "IDBResourceIdentifier.h"
 #include "IDBTransactionInfo.h"
+#include <wtf/HashMap.h>
 #include <wtf/Ref.h>
 #include <wtf/RefCounted.h>
 #include <wtf/WeakPtr.h>
@@ -108,6 +110,10 @@ private:
 
     State m_state { State::Running };
     IDBError m_result;
+
+    // Failures of iterations the client answered from prefetched records, by cursor. They
+    // are reported in reply to the next request for that cursor, or fail the commit.
+    HashMap<IDBResourceIdentifier, IDBError> m_cursorErrors;
 };
 
 } // namespace IDBServer
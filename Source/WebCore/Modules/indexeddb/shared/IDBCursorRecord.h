@@ -35,7 +35,9 @@ namespace WebCore {
 struct IDBCursorRecord {
     IDBKeyData key;
     IDBKeyData primaryKey;
-    std::unique_ptr<IDBValue> value;
+    IDBValue value;
+
+    IDBCursorRecord isolatedCopy() const { return { key.isolatedCopy(), primaryKey.isolatedCopy(), value.isolatedCopy() }; }
 
     template<class Encoder> void encode(Encoder&) const;
     template<class Decoder> static bool decode(Decoder&, IDBCursorRecord&);
@@ -50,14 +52,23 @@ void IDBCursorRecord::encode(Encoder& encoder) const
 template<class Decoder>
 bool IDBCursorRecord::decode(Decoder& decoder, IDBCursorRecord& record)
 {
-    if (!decoder.decode(record.key))
+    Optional<IDBKeyData> key;
+    decoder >> key;
+    if (!key)
         return false;
+    record.key = WTFMove(*key);
 
-    if (!decoder.decode(record.primaryKey))
+    Optional<IDBKeyData> primaryKey;
+    decoder >> primaryKey;
+    if (!primaryKey)
         return false;
+    record.primaryKey = WTFMove(*primaryKey);
 
-    if (!decoder.decode(record.value))
+    Optional<IDBValue> value;
+    decoder >> value;
+    if (!value)
         return false;
+    record.value = WTFMove(*value);
 
     return true;
 }
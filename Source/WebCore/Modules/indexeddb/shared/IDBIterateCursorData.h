@@ -28,6 +28,7 @@
 #if ENABLE(INDEXED_DATABASE)
 
 #include "IDBKeyData.h"
+#include "IndexedDB.h"
 
 namespace WebCore {
 
@@ -35,6 +36,7 @@ struct IDBIterateCursorData {
     IDBKeyData keyData;
     IDBKeyData primaryKeyData;
     unsigned count;
+    IndexedDB::CursorIterateOption option { IndexedDB::CursorIterateOption::Reply };
 
     IDBIterateCursorData isolatedCopy() const;
 
@@ -49,7 +51,7 @@ struct IDBIterateCursorData {
 template<class Encoder>
 void IDBIterateCursorData::encode(Encoder& encoder) const
 {
-    encoder << keyData << primaryKeyData << static_cast<uint64_t>(count);
+    encoder << keyData << primaryKeyData << static_cast<uint64_t>(count) << option;
 }
 
 template<class Decoder>
@@ -76,6 +78,12 @@ bool IDBIterateCursorData::decode(Decoder& decoder, IDBIterateCursorData& iterat
 
     iteratorCursorData.count = static_cast<unsigned>(count);
 
+    Optional<IndexedDB::CursorIterateOption> option;
+    decoder >> option;
+    if (!option)
+        return false;
+    iteratorCursorData.option = *option;
+
     return true;
 }
 
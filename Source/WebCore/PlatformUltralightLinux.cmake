@@ -86,6 +86,8 @@ list(APPEND WebCore_SOURCES
     platform/ultralight/CryptoDigestUltralight.cpp
     platform/ultralight/CursorUltralight.cpp
     platform/ultralight/DNSResolveQueueUltralight.cpp
+    platform/ultralight/DisplayRefreshUltralight.cpp
+    platform/ultralight/DisplayRefreshUltralight.h
     platform/ultralight/DragControllerUltralight.cpp
     platform/ultralight/DragDataUltralight.cpp
     platform/ultralight/DragImageUltralight.cpp
@@ -102,6 +104,7 @@ list(APPEND WebCore_SOURCES
     platform/ultralight/KeyEventUltralight.cpp
     platform/ultralight/LocalizedStringsUltralight.cpp
     platform/ultralight/LoggingUltralight.cpp
+    platform/ultralight/LowPowerModeNotifierUltralight.cpp
     platform/ultralight/MemoryUtils.cpp
     platform/ultralight/MIMETypeRegistryUltralight.cpp
     platform/ultralight/NetworkStateNotifierStub.cpp
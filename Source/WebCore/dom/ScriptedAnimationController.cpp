@@ -62,7 +62,12 @@ ScriptedAnimationController::ScriptedAnimationController(Document& document)
 {
 }
 
-ScriptedAnimationController::~ScriptedAnimationController() = default;
+ScriptedAnimationController::~ScriptedAnimationController()
+{
+#if USE(ULTRALIGHT)
+    DisplayRefreshUltralight::singleton().removeClient(*this);
+#endif
+}
 
 bool ScriptedAnimationController::requestAnimationFrameEnabled() const
 {
@@ -85,7 +90,7 @@ void ScriptedAnimationController::resume()
         scheduleAnimation();
 }
 
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR) && !RELEASE_LOG_DISABLED
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING) && !RELEASE_LOG_DISABLED
 
 static const char* throttlingReasonToString(ScriptedAnimationController::ThrottlingReason reason)
 {
@@ -119,7 +124,7 @@ static String throttlingReasonsToString(OptionSet<ScriptedAnimationController::T
 
 void ScriptedAnimationController::addThrottlingReason(ThrottlingReason reason)
 {
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING)
     if (m_throttlingReasons.contains(reason))
         return;
 
@@ -138,7 +143,7 @@ void ScriptedAnimationController::addThrottlingReason(ThrottlingReason reason)
 
 void ScriptedAnimationController::removeThrottlingReason(ThrottlingReason reason)
 {
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING)
     if (!m_throttlingReasons.contains(reason))
         return;
 
@@ -157,7 +162,7 @@ void ScriptedAnimationController::removeThrottlingReason(ThrottlingReason reason
 
 bool ScriptedAnimationController::isThrottled() const
 {
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING)
     return !m_throttlingReasons.isEmpty();
 #else
     return false;
@@ -230,7 +235,7 @@ void ScriptedAnimationController::serviceRequestAnimationFrameCallbacks(DOMHighR
 
 Seconds ScriptedAnimationController::interval() const
 {
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING)
     if (m_throttlingReasons.contains(ThrottlingReason::VisuallyIdle) || m_throttlingReasons.contains(ThrottlingReason::OutsideViewport))
         return aggressiveThrottlingAnimationInterval;
 
@@ -270,6 +275,19 @@ void ScriptedAnimationController::scheduleAnimation()
         m_isUsingTimer = true;
     }
 #endif
+#if USE(ULTRALIGHT)
+    // Unthrottled frames follow the host's refresh when it provides one. The timer still
+    // runs as a fallback in case the host stops refreshing, e.g. while minimized.
+    auto& displayRefresh = DisplayRefreshUltralight::singleton();
+    if (!isThrottled() && displayRefresh.isDrivenByHost()) {
+        displayRefresh.addClient(*this);
+        if (!m_animationTimer.isActive())
+            m_animationTimer.startOneShot(DisplayRefreshUltralight::refreshTimeout);
+        return;
+    }
+    displayRefresh.removeClient(*this);
+#endif
+
     if (m_animationTimer.isActive())
         return;
 
@@ -293,8 +311,23 @@ void ScriptedAnimationController::scheduleAnimation()
 
 void ScriptedAnimationController::animationTimerFired()
 {
+#if USE(ULTRALIGHT)
+    DisplayRefreshUltralight::singleton().removeClient(*this);
+#endif
+    m_lastAnimationFrameTimestamp = m_document->domWindow()->nowTimestamp();
+    serviceRequestAnimationFrameCallbacks(m_lastAnimationFrameTimestamp);
+}
+
+#if USE(ULTRALIGHT)
+void ScriptedAnimationController::displayDidRefresh()
+{
+    if (!m_document)
+        return;
+
+    m_animationTimer.stop();
     m_lastAnimationFrameTimestamp = m_document->domWindow()->nowTimestamp();
     serviceRequestAnimationFrameCallbacks(m_lastAnimationFrameTimestamp);
 }
+#endif
 
 }
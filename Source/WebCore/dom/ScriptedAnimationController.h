@@ -32,6 +32,10 @@
 #include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
+#if USE(ULTRALIGHT)
+#include "DisplayRefreshUltralight.h"
+#endif
+
 namespace WebCore {
 
 class Document;
@@ -39,6 +43,9 @@ class Page;
 class RequestAnimationFrameCallback;
 
 class ScriptedAnimationController : public RefCounted<ScriptedAnimationController>
+#if USE(ULTRALIGHT)
+    , public DisplayRefreshUltralightClient
+#endif
 {
 public:
     static Ref<ScriptedAnimationController> create(Document& document)
@@ -76,6 +83,10 @@ private:
     void scheduleAnimation();
     void animationTimerFired();
 
+#if USE(ULTRALIGHT)
+    void displayDidRefresh() final;
+#endif
+
     Page* page() const;
 
     typedef Vector<RefPtr<RequestAnimationFrameCallback>> CallbackList;
@@ -88,8 +99,10 @@ private:
     Timer m_animationTimer;
     double m_lastAnimationFrameTimestamp { 0 };
 
-#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
+#if USE(REQUEST_ANIMATION_FRAME_THROTTLING)
     OptionSet<ThrottlingReason> m_throttlingReasons;
+#endif
+#if USE(REQUEST_ANIMATION_FRAME_DISPLAY_MONITOR)
     bool m_isUsingTimer { false };
 #endif
 };
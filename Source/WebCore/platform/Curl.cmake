@@ -7,6 +7,7 @@ list(APPEND WebCore_SOURCES
     platform/network/curl/CertificateInfoCurl.cpp
     platform/network/curl/CookieJarCurl.cpp
     platform/network/curl/CookieJarDB.cpp
+    platform/network/curl/CookieJarMemoryStore.cpp
     platform/network/curl/CookieStorageCurl.cpp
     platform/network/curl/CookieUtil.cpp
     platform/network/curl/CredentialStorageCurl.cpp
@@ -22,6 +23,7 @@ list(APPEND WebCore_SOURCES
     platform/network/curl/CurlResourceHandleDelegate.cpp
     platform/network/curl/CurlSSLHandle.cpp
     platform/network/curl/CurlSSLVerifier.cpp
+    platform/network/curl/CurlStreamScheduler.cpp
     platform/network/curl/DNSResolveQueueCurl.cpp
     platform/network/curl/NetworkStorageSessionCurl.cpp
     platform/network/curl/ProtectionSpaceCurl.cpp
@@ -40,6 +42,7 @@ list(APPEND WebCore_PRIVATE_FRAMEWORK_HEADERS
     platform/network/curl/CertificateInfo.h
     platform/network/curl/CookieJarCurl.h
     platform/network/curl/CookieJarDB.h
+    platform/network/curl/CookieJarMemoryStore.h
     platform/network/curl/CookieUtil.h
     platform/network/curl/CurlCacheEntry.h
     platform/network/curl/CurlCacheManager.h
@@ -48,8 +48,15 @@ public:
 
     WEBCORE_EXPORT bool isLowPowerModeEnabled() const;
 
+#if USE(ULTRALIGHT)
+    // Called by the host when the system enters or leaves low power mode.
+    WEBCORE_EXPORT static void setLowPowerModeEnabled(bool);
+#endif
+
 private:
-#if PLATFORM(IOS_FAMILY)
+#if USE(ULTRALIGHT)
+    LowPowerModeChangeCallback m_callback;
+#elif PLATFORM(IOS_FAMILY)
     void notifyLowPowerModeChanged(bool);
     friend void notifyLowPowerModeChanged(LowPowerModeNotifier&, bool);
 
@@ -208,6 +208,10 @@ void Gradient::setGradientSpaceTransform(const AffineTransform& gradientSpaceTra
 
     m_gradientSpaceTransformation = gradientSpaceTransformation;
 
+#if USE(ULTRALIGHT)
+    // The Ultralight platform gradient has the transform baked into its end points.
+    platformDestroy();
+#endif
     invalidateHash();
 }
 
@@ -781,6 +781,12 @@ void GraphicsContext::drawImageBuffer(ImageBuffer& image, const FloatRect& desti
     if (paintingDisabled())
         return;
 
+    if (m_impl) {
+        if (auto bufferImage = image.copyImage(DontCopyBackingStore))
+            m_impl->drawImage(*bufferImage, destination, source, imagePaintingOptions);
+        return;
+    }
+
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_interpolationQuality);
     image.draw(*this, destination, source, imagePaintingOptions.m_compositeOperator, imagePaintingOptions.m_blendMode);
 }
@@ -805,6 +811,12 @@ void GraphicsContext::drawConsumingImageBuffer(std::unique_ptr<ImageBuffer> imag
 {
     if (paintingDisabled() || !image)
         return;
+
+    if (m_impl) {
+        if (auto bufferImage = ImageBuffer::sinkIntoImage(WTFMove(image)))
+            m_impl->drawImage(*bufferImage, destination, source, imagePaintingOptions);
+        return;
+    }
     
     InterpolationQualityMaintainer interpolationQualityForThisScope(*this, imagePaintingOptions.m_interpolationQuality);
     ImageBuffer::drawConsuming(WTFMove(image), *this, destination, source, imagePaintingOptions.m_compositeOperator, imagePaintingOptions.m_blendMode);
@@ -388,6 +388,16 @@ public:
     void fillRoundedRect(const FloatRoundedRect&, const Color&, BlendMode = BlendMode::Normal);
     void fillRectWithRoundedHole(const FloatRect&, const FloatRoundedRect& roundedHoleRect, const Color&);
 
+#if USE(ULTRALIGHT)
+    // Outset shadows are not drawn inside |clipRect|; inset shadows are drawn inside |rect|
+    // around the hole |clipRect|.
+    void drawBoxShadow(const FloatRoundedRect&, const FloatSize& offset, float radius, const Color&, bool inset, const FloatRoundedRect& clipRect);
+
+    // Called by painting code that needs the platform context (native theme parts) when
+    // this context is recording. The recorded display list is then flagged as incomplete.
+    void didSkipUnrecordableDrawing();
+#endif
+
     WEBCORE_EXPORT void clearRect(const FloatRect&);
 
     WEBCORE_EXPORT void strokeRect(const FloatRect&, float lineWidth);
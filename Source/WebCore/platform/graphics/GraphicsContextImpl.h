@@ -61,6 +61,11 @@ public:
     virtual void strokeEllipse(const FloatRect&) = 0;
     virtual void clearRect(const FloatRect&) = 0;
 
+#if USE(ULTRALIGHT)
+    virtual void drawBoxShadow(const FloatRoundedRect&, const FloatSize& offset, float radius, const Color&, bool inset, const FloatRoundedRect& clipRect) = 0;
+    virtual void didSkipUnrecordableDrawing() { }
+#endif
+
 #if USE(CG)
     virtual void applyStrokePattern() = 0;
     virtual void applyFillPattern() = 0;
@@ -205,6 +205,8 @@ namespace WebCore {
 #endif
 
 #if USE(ULTRALIGHT)
+        // The returned path is shared with copies of this Path, only modify it through a
+        // Path that has not been copied yet.
         WEBCORE_EXPORT ultralight::Ref<ultralight::Path> ultralightPath() const;
 #endif
 
@@ -224,6 +226,11 @@ namespace WebCore {
 #endif
 
     private:
+#if USE(ULTRALIGHT)
+        // Unshares the path storage and drops its cached bounds ahead of a modification.
+        ultralight::Ref<ultralight::Path> mutableUltralightPath();
+#endif
+
 #if USE(DIRECT2D)
         COMPtr<ID2D1GeometryGroup> m_path;
         COMPtr<ID2D1PathGeometry> m_activePathGeometry;
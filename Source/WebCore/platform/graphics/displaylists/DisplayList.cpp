@@ -51,6 +51,9 @@ void DisplayList::dump() const
 void DisplayList::clear()
 {
     m_list.clear();
+#if USE(ULTRALIGHT)
+    m_hasUnrecordableDrawing = false;
+#endif
 }
 
 void DisplayList::removeItemsFromIndex(size_t index)
@@ -77,6 +77,12 @@ public:
     
     String asText(AsTextFlags) const;
 
+#if USE(ULTRALIGHT)
+    // Set when something painted while recording could only be drawn into a platform
+    // context. Replaying such a list misses that drawing.
+    bool hasUnrecordableDrawing() const { return m_hasUnrecordableDrawing; }
+#endif
+
 #if !defined(NDEBUG) || !LOG_DISABLED
     WTF::CString description() const;
     void dump() const;
@@ -100,6 +106,9 @@ private:
     Vector<Ref<Item>>& list() { return m_list; }
 
     Vector<Ref<Item>> m_list;
+#if USE(ULTRALIGHT)
+    bool m_hasUnrecordableDrawing { false };
+#endif
 };
 
 } // DisplayList
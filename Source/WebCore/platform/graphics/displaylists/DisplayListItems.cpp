@@ -121,6 +121,10 @@ size_t Item::sizeInBytes(const Item& item)
         return sizeof(downcast<FillRoundedRect>(item));
     case ItemType::FillRectWithRoundedHole:
         return sizeof(downcast<FillRectWithRoundedHole>(item));
+#if USE(ULTRALIGHT)
+    case ItemType::DrawBoxShadow:
+        return sizeof(downcast<DrawBoxShadow>(item));
+#endif
     case ItemType::FillPath:
         return sizeof(downcast<FillPath>(item));
     case ItemType::FillEllipse:
@@ -391,6 +395,26 @@ void DrawGlyphs::computeBounds()
     }
 }
 
+FloatPoint DrawGlyphs::endPoint() const
+{
+    FloatPoint result = anchorPoint();
+    for (auto& advance : m_advances)
+        result.move(advance.width(), advance.height());
+    return result;
+}
+
+void DrawGlyphs::appendGlyphs(const GlyphBufferGlyph* glyphs, const GlyphBufferAdvance* advances, unsigned count)
+{
+    m_glyphs.reserveCapacity(m_glyphs.size() + count);
+    m_advances.reserveCapacity(m_advances.size() + count);
+    for (unsigned i = 0; i < count; ++i) {
+        m_glyphs.uncheckedAppend(glyphs[i]);
+        m_advances.uncheckedAppend(advances[i]);
+    }
+    m_bounds = FloatRect();
+    computeBounds();
+}
+
 Optional<FloatRect> DrawGlyphs::localBounds(const GraphicsContext&) const
 {
     FloatRect localBounds = m_bounds;
@@ -793,6 +817,38 @@ static TextStream& operator<<(TextStream& ts, const FillRectWithRoundedHole& ite
     return ts;
 }
 
+#if USE(ULTRALIGHT)
+void DrawBoxShadow::apply(GraphicsContext& context) const
+{
+    context.drawBoxShadow(m_rect, m_offset, m_radius, m_color, m_inset, m_clipRect);
+}
+
+Optional<FloatRect> DrawBoxShadow::localBounds(const GraphicsContext&) const
+{
+    // Inset shadows stay inside the box. Outset ones are offset and spread by the blur,
+    // the same extent ShadowBlur uses for a blur of this radius.
+    if (m_inset)
+        return m_rect.rect();
+
+    FloatRect bounds = m_rect.rect();
+    bounds.move(m_offset);
+    bounds.inflate(ceilf(m_radius * 1.4));
+    return bounds;
+}
+
+static TextStream& operator<<(TextStream& ts, const DrawBoxShadow& item)
+{
+    ts << static_cast<const DrawingItem&>(item);
+    ts.dumpProperty("rect", item.roundedRect());
+    ts.dumpProperty("offset", item.offset());
+    ts.dumpProperty("radius", item.radius());
+    ts.dumpProperty("color", item.color());
+    ts.dumpProperty("inset", item.inset());
+    ts.dumpProperty("clip-rect", item.clipRect());
+    return ts;
+}
+#endif
+
 void FillPath::apply(GraphicsContext& context) const
 {
     context.fillPath(m_path);
@@ -972,6 +1028,9 @@ static TextStream& operator<<(TextStream& ts, const ItemType& type)
     case ItemType::FillCompositedRect: ts << "fill-composited-rect"; break;
     case ItemType::FillRoundedRect: ts << "fill-rounded-rect"; break;
     case ItemType::FillRectWithRoundedHole: ts << "fill-rect-with-rounded-hole"; break;
+#if USE(ULTRALIGHT)
+    case ItemType::DrawBoxShadow: ts << "draw-box-shadow"; break;
+#endif
     case ItemType::FillPath: ts << "fill-path"; break;
     case ItemType::FillEllipse: ts << "fill-ellipse"; break;
     case ItemType::StrokeRect: ts << "stroke-rect"; break;
@@ -1101,6 +1160,11 @@ TextStream& operator<<(TextStream& ts, const Item& item)
     case ItemType::FillRectWithRoundedHole:
         ts << downcast<FillRectWithRoundedHole>(item);
         break;
+#if USE(ULTRALIGHT)
+    case ItemType::DrawBoxShadow:
+        ts << downcast<DrawBoxShadow>(item);
+        break;
+#endif
     case ItemType::FillPath:
         ts << downcast<FillPath>(item);
         break;
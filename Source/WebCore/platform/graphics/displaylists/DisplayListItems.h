@@ -88,6 +88,9 @@ enum class ItemType {
     FillCompositedRect,
     FillRoundedRect,
     FillRectWithRoundedHole,
+#if USE(ULTRALIGHT)
+    DrawBoxShadow,
+#endif
     FillPath,
     FillEllipse,
     StrokeRect,
@@ -538,6 +541,13 @@ public:
 
     const Vector<GlyphBufferGlyph, 128>& glyphs() const { return m_glyphs; }
 
+    const Font& font() const { return m_font.get(); }
+    FontSmoothingMode smoothingMode() const { return m_smoothingMode; }
+
+    // Where a run drawn right after this one would start if it continued this one.
+    FloatPoint endPoint() const;
+    void appendGlyphs(const GlyphBufferGlyph*, const GlyphBufferAdvance*, unsigned count);
+
 private:
     DrawGlyphs(const Font&, const GlyphBufferGlyph*, const GlyphBufferAdvance*, unsigned count, const FloatPoint& blockLocation, const FloatSize& localAnchor, FontSmoothingMode);
 
@@ -994,6 +1004,7 @@ public:
     }
 
     FloatRect rect() const { return m_rect; }
+    void setRect(const FloatRect& rect) { m_rect = rect; }
     const Color& color() const { return m_color; }
 
 private:
@@ -1122,6 +1133,45 @@ private:
     Color m_color;
 };
 
+#if USE(ULTRALIGHT)
+class DrawBoxShadow : public DrawingItem {
+public:
+    static Ref<DrawBoxShadow> create(const FloatRoundedRect& rect, const FloatSize& offset, float radius, const Color& color, bool inset, const FloatRoundedRect& clipRect)
+    {
+        return adoptRef(*new DrawBoxShadow(rect, offset, radius, color, inset, clipRect));
+    }
+
+    const FloatRoundedRect& roundedRect() const { return m_rect; }
+    const FloatSize& offset() const { return m_offset; }
+    float radius() const { return m_radius; }
+    const Color& color() const { return m_color; }
+    bool inset() const { return m_inset; }
+    const FloatRoundedRect& clipRect() const { return m_clipRect; }
+
+private:
+    DrawBoxShadow(const FloatRoundedRect& rect, const FloatSize& offset, float radius, const Color& color, bool inset, const FloatRoundedRect& clipRect)
+        : DrawingItem(ItemType::DrawBoxShadow)
+        , m_rect(rect)
+        , m_offset(offset)
+        , m_radius(radius)
+        , m_color(color)
+        , m_inset(inset)
+        , m_clipRect(clipRect)
+    {
+    }
+
+    void apply(GraphicsContext&) const override;
+    Optional<FloatRect> localBounds(const GraphicsContext&) const override;
+
+    FloatRoundedRect m_rect;
+    FloatSize m_offset;
+    float m_radius;
+    Color m_color;
+    bool m_inset;
+    FloatRoundedRect m_clipRect;
+};
+#endif
+
 class FillPath : public DrawingItem {
 public:
     static Ref<FillPath> create(const Path& path)
@@ -1351,7 +1401,7 @@ SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawGlyphs)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawImage)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawTiledImage)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawTiledScaledImage)
-#if USE(CG) || USE(CAIRO)
+#if USE(CG) || USE(CAIRO) || USE(ULTRALIGHT)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawNativeImage)
 #endif
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawPattern)
@@ -1369,6 +1419,9 @@ SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillRectWithGradient)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillCompositedRect)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillRoundedRect)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillRectWithRoundedHole)
+#if USE(ULTRALIGHT)
+SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(DrawBoxShadow)
+#endif
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillPath)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(FillEllipse)
 SPECIALIZE_TYPE_TRAITS_DISPLAYLIST_ITEM(StrokeRect)
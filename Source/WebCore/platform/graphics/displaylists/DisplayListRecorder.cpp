@@ -101,6 +101,10 @@ void Recorder::setMiterLimit(float miterLimit)
 
 void Recorder::drawGlyphs(const Font& font, const GlyphBuffer& glyphBuffer, unsigned from, unsigned numGlyphs, const FloatPoint& startPoint, FontSmoothingMode smoothingMode)
 {
+#if USE(ULTRALIGHT)
+    if (coalesceGlyphs(font, glyphBuffer, from, numGlyphs, startPoint, smoothingMode))
+        return;
+#endif
     DrawingItem& newItem = downcast<DrawingItem>(appendItem(DrawGlyphs::create(font, glyphBuffer.glyphs(from), glyphBuffer.advances(from), numGlyphs, FloatPoint(), toFloatSize(startPoint), smoothingMode)));
     updateItemExtent(newItem);
 }
@@ -274,6 +278,10 @@ void Recorder::fillRect(const FloatRect& rect)
 
 void Recorder::fillRect(const FloatRect& rect, const Color& color)
 {
+#if USE(ULTRALIGHT)
+    if (coalesceFillRect(rect, color))
+        return;
+#endif
     DrawingItem& newItem = downcast<DrawingItem>(appendItem(FillRectWithColor::create(rect, color)));
     updateItemExtent(newItem);
 }
@@ -302,6 +310,19 @@ void Recorder::fillRectWithRoundedHole(const FloatRect& rect, const FloatRounded
     updateItemExtent(newItem);
 }
 
+#if USE(ULTRALIGHT)
+void Recorder::drawBoxShadow(const FloatRoundedRect& rect, const FloatSize& offset, float radius, const Color& color, bool inset, const FloatRoundedRect& clipRect)
+{
+    DrawingItem& newItem = downcast<DrawingItem>(appendItem(DrawBoxShadow::create(rect, offset, radius, color, inset, clipRect)));
+    updateItemExtent(newItem);
+}
+
+void Recorder::didSkipUnrecordableDrawing()
+{
+    m_displayList.m_hasUnrecordableDrawing = true;
+}
+#endif
+
 void Recorder::fillPath(const Path& path)
 {
     DrawingItem& newItem = downcast<DrawingItem>(appendItem(FillPath::create(path)));
@@ -402,6 +423,69 @@ Item& Recorder::appendItem(Ref<Item>&& item)
     return m_displayList.append(WTFMove(item));
 }
 
+#if USE(ULTRALIGHT)
+bool Recorder::canCoalesceWithLastItem(ItemType type) const
+{
+    if (!m_displayList.itemCount() || m_displayList.list().last()->type() != type)
+        return false;
+
+    // A pending state change has to be flushed between the two draws.
+    const ContextState& state = currentState();
+    if (state.stateChange.changesFromState(state.lastDrawingState))
+        return false;
+
+    // Separate draws cast overlapping shadows, a merged one doesn't.
+    return !graphicsContext().hasShadow();
+}
+
+bool Recorder::coalesceFillRect(const FloatRect& rect, const Color& color)
+{
+    if (!canCoalesceWithLastItem(ItemType::FillRectWithColor))
+        return false;
+
+    auto& lastItem = downcast<FillRectWithColor>(m_displayList.list().last().get());
+    if (lastItem.color() != color)
+        return false;
+
+    // Only merge rects that share a whole edge, so the union covers exactly the same pixels
+    // and nothing is painted twice.
+    FloatRect lastRect = lastItem.rect();
+    bool sharesVerticalEdge = lastRect.y() == rect.y() && lastRect.height() == rect.height()
+        && (lastRect.maxX() == rect.x() || rect.maxX() == lastRect.x());
+    bool sharesHorizontalEdge = lastRect.x() == rect.x() && lastRect.width() == rect.width()
+        && (lastRect.maxY() == rect.y() || rect.maxY() == lastRect.y());
+    if (!sharesVerticalEdge && !sharesHorizontalEdge)
+        return false;
+
+    lastRect.unite(rect);
+    lastItem.setRect(lastRect);
+    updateItemExtent(lastItem);
+    return true;
+}
+
+bool Recorder::coalesceGlyphs(const Font& font, const GlyphBuffer& glyphBuffer, unsigned from, unsigned numGlyphs, const FloatPoint& startPoint, FontSmoothingMode smoothingMode)
+{
+    if (!canCoalesceWithLastItem(ItemType::DrawGlyphs))
+        return false;
+
+    // Text is often painted one word or one text box at a time; runs that continue exactly
+    // where the previous one stopped become a single run.
+    auto& lastItem = downcast<DrawGlyphs>(m_displayList.list().last().get());
+    if (&lastItem.font() != &font || lastItem.smoothingMode() != smoothingMode)
+        return false;
+
+    // Layout positions runs in LayoutUnits while advances are floats, allow for the rounding.
+    const float tolerance = 1.0f / 64;
+    FloatSize gap = startPoint - lastItem.endPoint();
+    if (std::abs(gap.width()) > tolerance || std::abs(gap.height()) > tolerance)
+        return false;
+
+    lastItem.appendGlyphs(glyphBuffer.glyphs(from), glyphBuffer.advances(from), numGlyphs);
+    updateItemExtent(lastItem);
+    return true;
+}
+#endif
+
 void Recorder::updateItemExtent(DrawingItem& item) const
 {
     if (Optional<FloatRect> rect = item.localBounds(graphicsContext()))
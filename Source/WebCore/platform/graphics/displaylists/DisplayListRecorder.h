@@ -81,6 +81,11 @@ private:
     void strokeEllipse(const FloatRect&) override;
     void clearRect(const FloatRect&) override;
 
+#if USE(ULTRALIGHT)
+    void drawBoxShadow(const FloatRoundedRect&, const FloatSize& offset, float radius, const Color&, bool inset, const FloatRoundedRect& clipRect) override;
+    void didSkipUnrecordableDrawing() override;
+#endif
+
 #if USE(CG)
     void applyStrokePattern() override;
     void applyFillPattern() override;
@@ -133,6 +138,14 @@ private:
     Item& appendItem(Ref<Item>&&);
     void willAppendItem(const Item&);
 
+#if USE(ULTRALIGHT)
+    // Extend the previous item instead of appending a new one when nothing that affects
+    // drawing happened in between. These keep text-heavy and tiled content compact.
+    bool canCoalesceWithLastItem(ItemType) const;
+    bool coalesceFillRect(const FloatRect&, const Color&);
+    bool coalesceGlyphs(const Font&, const GlyphBuffer&, unsigned from, unsigned numGlyphs, const FloatPoint& anchorPoint, FontSmoothingMode);
+#endif
+
     FloatRect extentFromLocalBounds(const FloatRect&) const;
     void updateItemExtent(DrawingItem&) const;
     
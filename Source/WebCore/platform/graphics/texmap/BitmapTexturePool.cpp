@@ -39,6 +39,7 @@ namespace WebCore {
 
 static const Seconds releaseUnusedSecondsTolerance { 3_s };
 static const Seconds releaseUnusedTexturesTimerInterval { 500_ms };
+static const size_t unusedTexturesByteBudget = 64 * 1024 * 1024;
 
 #if USE(TEXTURE_MAPPER_GL)
 BitmapTexturePool::BitmapTexturePool(const TextureMapperContextAttributes& contextAttributes)
@@ -67,7 +68,33 @@ RefPtr<BitmapTexture> BitmapTexturePool::acquireTexture(const IntSize& size, con
 
     scheduleReleaseUnusedTextures();
     selectedEntry->markIsInUse();
-    return selectedEntry->m_texture.copyRef();
+    RefPtr<BitmapTexture> texture = selectedEntry->m_texture.copyRef();
+    releaseTexturesOverBudget();
+    return texture;
+}
+
+void BitmapTexturePool::releaseTexturesOverBudget()
+{
+    // Textures nobody holds on to anymore are kept for reuse, but only up to a byte budget.
+    // Past that the least recently used ones go away now instead of waiting for the timer.
+    size_t unusedBytes = 0;
+    for (auto& entry : m_textures) {
+        if (entry.m_texture->refCount() == 1)
+            unusedBytes += entry.m_texture->numberOfBytes();
+    }
+
+    while (unusedBytes > unusedTexturesByteBudget) {
+        Entry* oldestEntry = nullptr;
+        for (auto& entry : m_textures) {
+            if (entry.m_texture->refCount() == 1 && (!oldestEntry || entry.m_lastUsedTime < oldestEntry->m_lastUsedTime))
+                oldestEntry = &entry;
+        }
+        if (!oldestEntry)
+            break;
+
+        unusedBytes -= oldestEntry->m_texture->numberOfBytes();
+        m_textures.remove(oldestEntry - m_textures.begin());
+    }
 }
 
 void BitmapTexturePool::scheduleReleaseUnusedTextures()
@@ -89,6 +116,7 @@ void BitmapTexturePool::releaseUnusedTexturesTimerFired()
     m_textures.removeAllMatching([&minUsedTime](const Entry& entry) {
         return entry.canBeReleased(minUsedTime);
     });
+    releaseTexturesOverBudget();
 
     if (!m_textures.isEmpty())
         scheduleReleaseUnusedTextures();
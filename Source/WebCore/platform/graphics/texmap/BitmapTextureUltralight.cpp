@@ -7,13 +7,29 @@
 #include "GraphicsContext.h"
 #include "Image.h"
 #include "CanvasImage.h"
+#include "DisplayList.h"
+#include "DisplayListReplayer.h"
 #include "GraphicsLayer.h"
 #include "TextureMapper.h"
 #include <Ultralight/platform/Platform.h>
 #include <Ultralight/platform/Config.h>
+#include <atomic>
 
 namespace WebCore {
 
+static std::atomic<size_t> s_totalBackingStoreBytes;
+
+size_t BitmapTextureUltralight::totalBackingStoreBytes() {
+  return s_totalBackingStoreBytes.load(std::memory_order_relaxed);
+}
+
+void BitmapTextureUltralight::setBackingStoreSize(const IntSize& size) {
+  size_t bytes = size.isEmpty() ? 0 : static_cast<size_t>(size.width()) * size.height() * 4;
+  s_totalBackingStoreBytes -= backing_store_bytes_;
+  s_totalBackingStoreBytes += bytes;
+  backing_store_bytes_ = bytes;
+}
+
 BitmapTextureUltralight::BitmapTextureUltralight(const BitmapTexture::Flags flags) {
 }
 
@@ -22,10 +38,12 @@ BitmapTextureUltralight::~BitmapTextureUltralight() {
     canvas_->RecycleRenderTexture();
     canvas_ = nullptr;
   }
+  setBackingStoreSize(IntSize());
 }
 
 void BitmapTextureUltralight::didReset() {
   canvas_size_ = contentSize();
+  setBackingStoreSize(canvas_size_);
 
   if (canvas_) {
     if(canvas_size_.width() != canvas_->width() || canvas_size_.height() != canvas_->height())
@@ -86,6 +104,22 @@ void BitmapTextureUltralight::updateContents(Image* image,
 void BitmapTextureUltralight::updateContents(TextureMapper& textureMapper,
   GraphicsLayer* sourceLayer, const IntRect& targetRect,
   const IntPoint& offset, float scale) {
+  paintContents(targetRect, offset, scale, [sourceLayer](GraphicsContext& ctx, const FloatRect& sourceRect) {
+    sourceLayer->paintGraphicsLayerContents(ctx, sourceRect);
+  });
+}
+
+void BitmapTextureUltralight::updateContents(const DisplayList::DisplayList& displayList,
+  const IntRect& targetRect, const IntPoint& offset, float scale) {
+  paintContents(targetRect, offset, scale, [&displayList](GraphicsContext& ctx, const FloatRect& sourceRect) {
+    DisplayList::Replayer replayer(ctx, displayList);
+    replayer.replay(sourceRect);
+  });
+}
+
+void BitmapTextureUltralight::paintContents(const IntRect& targetRect,
+  const IntPoint& offset, float scale,
+  const WTF::Function<void(GraphicsContext&, const FloatRect&)>& painter) {
   IntRect sourceRect(targetRect);
   sourceRect.setLocation(offset);
   ultralight::IntRect scissorRect = { sourceRect.x(), sourceRect.y(), sourceRect.maxX(), sourceRect.maxY() };
@@ -110,7 +144,7 @@ void BitmapTextureUltralight::updateContents(TextureMapper& textureMapper,
     GraphicsContext ctx(canvas_);
     ctx.applyDeviceScaleFactor(scale);
 
-    sourceLayer->paintGraphicsLayerContents(ctx, sourceRect);
+    painter(ctx, sourceRect);
   }
   canvas_->Restore();
 
@@ -4,11 +4,18 @@
 
 #include "BitmapTexture.h"
 #include <Ultralight/private/Canvas.h>
+#include <wtf/Function.h>
 
 namespace WebCore {
 
-class TextureMapper;
 class FilterOperation;
+class FloatRect;
+class GraphicsContext;
+class TextureMapper;
+
+namespace DisplayList {
+class DisplayList;
+}
 
 class WEBCORE_EXPORT BitmapTextureUltralight : public BitmapTexture {
 public:
@@ -33,14 +40,30 @@ public:
     virtual void updateContents(const void*, const IntRect& target,
         const IntPoint& offset, int bytesPerLine) override;
 
+    // Same as the GraphicsLayer overload but replays layer contents recorded in
+    // unscaled layer coordinates instead of painting the layer.
+    void updateContents(const DisplayList::DisplayList&, const IntRect& targetRect,
+        const IntPoint& offset, float scale);
+
     virtual bool isValid() const override { return !!canvas_; }
 
     virtual RefPtr<BitmapTexture> applyFilters(TextureMapper&,
         const FilterOperations&) override;
 
+    // Total bytes of canvas backing store held by all live textures.
+    static size_t totalBackingStoreBytes();
+
 protected:
+    void setBackingStoreSize(const IntSize&);
+
+    // Clears the target area and hands |painter| a context set up to draw the layer
+    // contents in the given rect, in unscaled layer coordinates.
+    void paintContents(const IntRect& targetRect, const IntPoint& offset, float scale,
+        const WTF::Function<void(GraphicsContext&, const FloatRect&)>& painter);
+
     ultralight::RefPtr<ultralight::Canvas> canvas_;
     IntSize canvas_size_;
+    size_t backing_store_bytes_ = 0;
 };
 
 }  // namespace WebCore
@@ -34,6 +34,53 @@
 
 namespace WebCore {
 
+// Upper bound on the number of disjoint damage rects tracked per layer. Past this the
+// two rects whose union wastes the least area are merged.
+static const size_t MaxNeedsDisplayRects = 8;
+
+static float area(const FloatRect& rect)
+{
+    return rect.width() * rect.height();
+}
+
+static void addNeedsDisplayRect(Vector<FloatRect, 4>& rects, FloatRect rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    // Fold in every rect that costs nothing extra to paint together with the new one.
+    // This also drops rects contained in (or containing) the new one.
+    for (size_t i = 0; i < rects.size();) {
+        FloatRect united = unionRect(rects[i], rect);
+        if (area(united) > area(rects[i]) + area(rect)) {
+            ++i;
+            continue;
+        }
+        rect = united;
+        rects.remove(i);
+        i = 0;
+    }
+    rects.append(rect);
+
+    while (rects.size() > MaxNeedsDisplayRects) {
+        size_t bestI = 0;
+        size_t bestJ = 1;
+        float bestWaste = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < rects.size(); ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                float waste = area(unionRect(rects[i], rects[j])) - area(rects[i]) - area(rects[j]);
+                if (waste < bestWaste) {
+                    bestWaste = waste;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+        rects[bestI].unite(rects[bestJ]);
+        rects.remove(bestJ);
+    }
+}
+
 Ref<GraphicsLayer> GraphicsLayer::create(GraphicsLayerFactory* factory, GraphicsLayerClient& client, Type layerType)
 {
     if (!factory)
@@ -93,7 +140,7 @@ void GraphicsLayerTextureMapper::setNeedsDisplayInRect(const FloatRect& rect, Sh
 
     if (m_needsDisplay)
         return;
-    m_needsDisplayRect.unite(rect);
+    addNeedsDisplayRect(m_needsDisplayRects, rect);
     notifyChange(DisplayChange);
     addRepaintRect(rect);
 }
@@ -300,8 +347,10 @@ void GraphicsLayerTextureMapper::setContentsToImage(Image* image)
             return;
 
         m_compositedNativeImagePtr = newNativeImagePtr;
-        if (!m_compositedImage)
-            m_compositedImage = TextureMapperTiledBackingStore::create();
+        // Always start a new backing store, the previous one may still be drawn by
+        // TextureMapperThreadedCompositor and must not change under it. Its textures go
+        // back to the pool and are picked up again by the new tiles.
+        m_compositedImage = TextureMapperTiledBackingStore::create();
         m_compositedImage->setContentsToImage(image);
         m_compositedImage->updateContentsScale(pageScaleFactor() * deviceScaleFactor());
     } else {
@@ -362,6 +411,8 @@ void GraphicsLayerTextureMapper::prepareBackingStoreIfNeeded()
         if (!m_backingStore) {
             m_backingStore = TextureMapperTiledBackingStore::create();
             m_changeMask |= BackingStoreChange;
+            // The layer may have dropped its solid color without any new invalidation.
+            m_needsDisplay = true;
         }
     } else {
         if (m_backingStore) {
@@ -385,7 +436,7 @@ void GraphicsLayerTextureMapper::updateDebugBorderAndRepaintCount()
 #endif
 
     // When this has its own backing store (e.g. Qt WK1), update the repaint count before calling TextureMapperLayer::flushCompositingStateForThisLayerOnly().
-    bool needsToRepaint = shouldHaveBackingStore() && (m_needsDisplay || !m_needsDisplayRect.isEmpty() || is_forcing_repaint);
+    bool needsToRepaint = shouldHaveBackingStore() && (m_needsDisplay || !m_needsDisplayRects.isEmpty() || is_forcing_repaint);
     if (isShowingRepaintCounter() && needsToRepaint) {
         incrementRepaintCount();
         m_changeMask |= RepaintCountChange;
@@ -489,14 +540,54 @@ void GraphicsLayerTextureMapper::flushCompositingState(const FloatRect& rect)
     if (!m_layer.textureMapper())
         return;
 
+    flushCompositingStateRecursive(rect, TransformationMatrix(), false, false);
+}
+
+void GraphicsLayerTextureMapper::flushCompositingStateRecursive(const FloatRect& clipRect, const TransformationMatrix& parentTransform, bool hasAnimatedTransform, bool isReplicated)
+{
     flushCompositingStateForThisLayerOnly();
 
+    // Mirrors TextureMapperLayer::computeTransformsRecursive(), which only runs at paint time.
+    const float originX = anchorPoint().x() * size().width();
+    const float originY = anchorPoint().y() * size().height();
+
+    TransformationMatrix combined = parentTransform;
+    combined
+        .translate3d(originX + position().x(), originY + position().y(), anchorPoint().z())
+        .multiply(transform());
+
+    TransformationMatrix combinedForChildren = combined;
+    combined.translate3d(-originX, -originY, -anchorPoint().z());
+
+    if (!preserves3D())
+        combinedForChildren = combinedForChildren.to2dTransform();
+    combinedForChildren.multiply(childrenTransform());
+    combinedForChildren.translate3d(-originX, -originY, -anchorPoint().z());
+
+    hasAnimatedTransform |= m_animations.hasActiveAnimationsOfType(AnimatedPropertyTransform);
+    isReplicated |= !!replicaLayer();
+    updateVisibleRect(clipRect, combined, hasAnimatedTransform, isReplicated);
+
     if (maskLayer())
-        maskLayer()->flushCompositingState(rect);
+        downcast<GraphicsLayerTextureMapper>(*maskLayer()).flushCompositingStateRecursive(clipRect, combined, hasAnimatedTransform, isReplicated);
     if (replicaLayer())
-        replicaLayer()->flushCompositingState(rect);
+        downcast<GraphicsLayerTextureMapper>(*replicaLayer()).flushCompositingStateRecursive(clipRect, combined, hasAnimatedTransform, isReplicated);
     for (auto& child : children())
-        child->flushCompositingState(rect);
+        downcast<GraphicsLayerTextureMapper>(child.get()).flushCompositingStateRecursive(clipRect, combinedForChildren, hasAnimatedTransform, isReplicated);
+}
+
+void GraphicsLayerTextureMapper::updateVisibleRect(const FloatRect& clipRect, const TransformationMatrix& combined, bool hasAnimatedTransform, bool isReplicated)
+{
+    // Fall back to covering the whole layer whenever the on-screen position can't be
+    // trusted until paint time: animated or projective transforms, and layers in a
+    // replicated subtree, whose backing stores are drawn a second time somewhere else.
+    FloatRect visibleRect = FloatRect::infiniteRect();
+    if (!hasAnimatedTransform && !isReplicated && combined.isAffine() && !clipRect.isInfinite()) {
+        if (auto inverse = combined.inverse())
+            visibleRect = intersection(inverse.value().mapRect(clipRect), FloatRect(FloatPoint(), size()));
+    }
+
+    m_visibleRect = visibleRect;
 }
 
 void GraphicsLayerTextureMapper::updateBackingStoreIncludingSubLayers()
@@ -504,16 +595,28 @@ void GraphicsLayerTextureMapper::updateBackingStoreIncludingSubLayers()
     if (!m_layer.textureMapper())
         return;
 
-    updateBackingStoreIfNeeded();
+    updateBackingStoreAndCompositedImageIfNeeded();
 
     if (maskLayer())
-        downcast<GraphicsLayerTextureMapper>(*maskLayer()).updateBackingStoreIfNeeded();
+        downcast<GraphicsLayerTextureMapper>(*maskLayer()).updateBackingStoreAndCompositedImageIfNeeded();
     if (replicaLayer())
-        downcast<GraphicsLayerTextureMapper>(*replicaLayer()).updateBackingStoreIfNeeded();
+        downcast<GraphicsLayerTextureMapper>(*replicaLayer()).updateBackingStoreAndCompositedImageIfNeeded();
     for (auto& child : children())
         downcast<GraphicsLayerTextureMapper>(child.get()).updateBackingStoreIncludingSubLayers();
 }
 
+void GraphicsLayerTextureMapper::updateBackingStoreAndCompositedImageIfNeeded()
+{
+    updateBackingStoreIfNeeded();
+
+    // Upload a new composited image now rather than at paint time, which may happen on
+    // the compositor thread where the Image must not be touched.
+    if (m_compositedImage) {
+        if (auto* textureMapper = m_layer.textureMapper())
+            m_compositedImage->updateContentsFromImageIfNeeded(*textureMapper);
+    }
+}
+
 void GraphicsLayerTextureMapper::updateBackingStoreIfNeeded()
 {
     TextureMapper* textureMapper = m_layer.textureMapper();
@@ -539,27 +642,41 @@ void GraphicsLayerTextureMapper::updateBackingStoreIfNeeded()
     scaled_size.setWidth(std::round(scaled_size.width()));
     scaled_size.setHeight(std::round(scaled_size.height()));
 
-    IntRect dirtyRect = IntRect(FloatRect(FloatPoint::zero(), scaled_size));
-
-    FloatRect scaled_needsDisplayRect = m_needsDisplayRect;
-    scaled_needsDisplayRect.scale(pageScaleFactor() * deviceScaleFactor());
+    IntRect layerRect = IntRect(FloatRect(FloatPoint::zero(), scaled_size));
+
+    // Each damage rect is repainted separately so that small invalidations far apart
+    // don't repaint everything in between.
+    Vector<IntRect, 4> dirtyRects;
+    if (m_needsDisplay || is_forcing_repaint)
+        dirtyRects.append(layerRect);
+    else {
+        for (auto& rect : m_needsDisplayRects) {
+            FloatRect scaledRect = rect;
+            scaledRect.scale(pageScaleFactor() * deviceScaleFactor());
+            IntRect dirtyRect = intersection(layerRect, enclosingIntRect(scaledRect));
+            if (!dirtyRect.isEmpty())
+                dirtyRects.append(dirtyRect);
+        }
+    }
 
-    if (!is_forcing_repaint) {
-      if (!m_needsDisplay)
-        dirtyRect.intersect(enclosingIntRect(scaled_needsDisplayRect));
-      if (dirtyRect.isEmpty())
+    m_backingStore->setVisibleRect(m_visibleRect);
+    if (dirtyRects.isEmpty() && !m_backingStore->visibleRectChanged())
         return;
-    }
 
     m_backingStore->updateContentsScale(pageScaleFactor() * deviceScaleFactor());
-    m_backingStore->updateContents(*textureMapper, this, m_size, dirtyRect);
+    m_backingStore->updateContents(*textureMapper, this, m_size, dirtyRects);
 
     m_needsDisplay = false;
-    m_needsDisplayRect = IntRect();
+    m_needsDisplayRects.clear();
 }
 
 bool GraphicsLayerTextureMapper::shouldHaveBackingStore() const
 {
+    // TextureMapperLayer::paintSelf() draws a visible solid color as a quad and skips the
+    // backing store altogether, so there is no point in allocating or painting one.
+    if (m_solidColor.isValid() && m_solidColor.isVisible() && !contentsRect().isEmpty())
+        return false;
+
     return drawsContent() && contentsAreVisible() && !m_size.isEmpty();
 }
 
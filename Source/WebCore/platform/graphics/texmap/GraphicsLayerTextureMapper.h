@@ -87,6 +87,8 @@ public:
     void updateBackingStoreIncludingSubLayers();
 
     TextureMapperLayer& layer() { return m_layer; }
+    TextureMapperTiledBackingStore* backingStore() const { return m_backingStore.get(); }
+    TextureMapperTiledBackingStore* compositedImage() const { return m_compositedImage.get(); }
 
     Color debugBorderColor() const { return m_debugBorderColor; }
     float debugBorderWidth() const { return m_debugBorderWidth; }
@@ -100,8 +102,11 @@ private:
     void setPlatformLayerNeedsDisplay() override { setContentsNeedsDisplay(); }
 
     void commitLayerChanges();
+    void flushCompositingStateRecursive(const FloatRect& clipRect, const TransformationMatrix& parentTransform, bool hasAnimatedTransform, bool isReplicated);
+    void updateVisibleRect(const FloatRect& clipRect, const TransformationMatrix& combined, bool hasAnimatedTransform, bool isReplicated);
     void updateDebugBorderAndRepaintCount();
     void updateBackingStoreIfNeeded();
+    void updateBackingStoreAndCompositedImageIfNeeded();
     void prepareBackingStoreIfNeeded();
     bool shouldHaveBackingStore() const;
 
@@ -161,7 +166,8 @@ private:
     float m_debugBorderWidth;
 
     TextureMapperPlatformLayer* m_contentsLayer;
-    FloatRect m_needsDisplayRect;
+    Vector<FloatRect, 4> m_needsDisplayRects;
+    FloatRect m_visibleRect { FloatRect::infiniteRect() };
     TextureMapperAnimations m_animations;
     MonotonicTime m_animationStartTime;
 };
@@ -164,11 +164,22 @@ static const TimingFunction& timingFunctionForAnimationValue(const AnimationValu
     return CubicBezierTimingFunction::defaultTimingFunction();
 }
 
+// Animation's copy constructor shares the timing function and the name, but a copy may be
+// applied on another thread than the original.
+static Ref<Animation> isolatedCopy(const Animation& animation)
+{
+    auto copy = Animation::create(animation);
+    if (animation.timingFunction())
+        copy->setTimingFunction(animation.timingFunction()->clone());
+    copy->setName(animation.name().isolatedCopy(), animation.nameStyleScopeOrdinal());
+    return copy;
+}
+
 TextureMapperAnimation::TextureMapperAnimation(const String& name, const KeyframeValueList& keyframes, const FloatSize& boxSize, const Animation& animation, bool listsMatch, MonotonicTime startTime, Seconds pauseTime, AnimationState state)
     : m_name(name.isSafeToSendToAnotherThread() ? name : name.isolatedCopy())
     , m_keyframes(keyframes)
     , m_boxSize(boxSize)
-    , m_animation(Animation::create(animation))
+    , m_animation(isolatedCopy(animation))
     , m_listsMatch(listsMatch)
     , m_startTime(startTime)
     , m_pauseTime(pauseTime)
@@ -182,7 +193,7 @@ TextureMapperAnimation::TextureMapperAnimation(const TextureMapperAnimation& oth
     : m_name(other.m_name.isSafeToSendToAnotherThread() ? other.m_name : other.m_name.isolatedCopy())
     , m_keyframes(other.m_keyframes)
     , m_boxSize(other.m_boxSize)
-    , m_animation(Animation::create(*other.m_animation))
+    , m_animation(isolatedCopy(*other.m_animation))
     , m_listsMatch(other.m_listsMatch)
     , m_startTime(other.m_startTime)
     , m_pauseTime(other.m_pauseTime)
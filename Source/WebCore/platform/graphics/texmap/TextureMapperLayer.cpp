@@ -650,6 +650,59 @@ void TextureMapperLayer::setBackingStore(TextureMapperBackingStore* backingStore
     m_backingStore = backingStore;
 }
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+// The mirrored tree is drawn on the compositor thread, so it must not share any of the
+// RefCounted objects of the main thread tree.
+static Color isolatedCopy(const Color& color)
+{
+    if (!color.isExtended())
+        return color;
+
+    auto& extendedColor = color.asExtended();
+    return Color(extendedColor.red(), extendedColor.green(), extendedColor.blue(), extendedColor.alpha(), extendedColor.colorSpace());
+}
+
+static FilterOperations isolatedCopy(const FilterOperations& filters)
+{
+    // Reference filters, which can't be cloned, are never composited.
+    FilterOperations copy;
+    copy.operations().reserveInitialCapacity(filters.size());
+    for (auto& operation : filters.operations()) {
+        if (operation->type() == FilterOperation::DROP_SHADOW) {
+            auto& dropShadow = downcast<DropShadowFilterOperation>(*operation);
+            copy.operations().uncheckedAppend(DropShadowFilterOperation::create(dropShadow.location(), dropShadow.stdDeviation(), isolatedCopy(dropShadow.color())));
+        } else
+            copy.operations().uncheckedAppend(operation->clone());
+    }
+    return copy;
+}
+
+void TextureMapperLayer::syncStateFrom(const TextureMapperLayer& source)
+{
+    auto maskLayer = WTFMove(m_state.maskLayer);
+    auto replicaLayer = WTFMove(m_state.replicaLayer);
+    m_state = source.m_state;
+    m_state.maskLayer = WTFMove(maskLayer);
+    m_state.replicaLayer = WTFMove(replicaLayer);
+    m_state.solidColor = isolatedCopy(source.m_state.solidColor);
+    m_state.debugBorderColor = isolatedCopy(source.m_state.debugBorderColor);
+    m_state.filters = isolatedCopy(source.m_state.filters);
+
+    // Copy constructing a TextureMapperAnimation clones its keyframes and Animation,
+    // assigning one doesn't.
+    auto& animations = m_animations.animations();
+    animations.clear();
+    animations.reserveInitialCapacity(source.m_animations.size());
+    for (auto& animation : source.m_animations.animations())
+        animations.uncheckedAppend(animation);
+
+    m_currentOpacity = source.m_currentOpacity;
+    m_currentFilters = isolatedCopy(source.m_currentFilters);
+    m_layerTransforms.localTransform = source.m_layerTransforms.localTransform;
+    m_id = source.m_id;
+}
+#endif
+
 #if USE(COORDINATED_GRAPHICS)
 void TextureMapperLayer::setAnimatedBackingStoreClient(Nicosia::AnimatedBackingStoreClient* client)
 {
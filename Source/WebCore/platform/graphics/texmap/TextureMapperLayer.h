@@ -104,6 +104,12 @@ public:
 
     void addChild(TextureMapperLayer*);
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    // Copies everything except the layer hierarchy, the backing store and the contents
+    // layer from |source|. TextureMapperThreadedCompositor uses this to mirror the tree.
+    void syncStateFrom(const TextureMapperLayer& source);
+#endif
+
 private:
     const TextureMapperLayer& rootLayer() const
     {
@@ -0,0 +1,165 @@
+#include "config.h"
+#include "TextureMapperThreadedCompositor.h"
+
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+
+#include "GraphicsLayerTextureMapper.h"
+#include "TextureMapperLayer.h"
+#include "TextureMapperTiledBackingStore.h"
+#include "TextureMapperUltralight.h"
+#include <wtf/MainThread.h>
+
+namespace WebCore {
+
+TextureMapperThreadedCompositor::MirroredLayer::MirroredLayer()
+    : layer(std::make_unique<TextureMapperLayer>())
+{
+}
+
+TextureMapperThreadedCompositor::MirroredLayer::~MirroredLayer() = default;
+
+Ref<TextureMapperThreadedCompositor> TextureMapperThreadedCompositor::create(ultralight::RefPtr<ultralight::Canvas> surface, Function<void()>&& didComposite)
+{
+    return adoptRef(*new TextureMapperThreadedCompositor(surface, WTFMove(didComposite)));
+}
+
+TextureMapperThreadedCompositor::TextureMapperThreadedCompositor(ultralight::RefPtr<ultralight::Canvas> surface, Function<void()>&& didComposite)
+    : m_queue(WorkQueue::create("org.ultralight.ThreadedCompositor"))
+    , m_surface(surface)
+    , m_didComposite(WTFMove(didComposite))
+{
+    // The texture mapper owns a BitmapTexturePool whose release timer belongs to the
+    // run loop it is created on, so create it on the compositor thread.
+    m_queue->dispatch([this, protectedThis = makeRef(*this)] {
+        m_textureMapper = std::make_unique<TextureMapperUltralight>();
+        m_textureMapper->set_default_surface(m_surface);
+    });
+}
+
+TextureMapperThreadedCompositor::~TextureMapperThreadedCompositor()
+{
+    ASSERT(!m_rootLayer);
+}
+
+void TextureMapperThreadedCompositor::updateAndCommit(GraphicsLayerTextureMapper& rootLayer)
+{
+    ASSERT(isMainThread());
+
+    // Nothing here is drawn by the compositor: repainting leaves the textures of the
+    // committed snapshots alone, and the new tree isn't visible until it is swapped in.
+    rootLayer.updateBackingStoreIncludingSubLayers();
+
+    MirroredLayerMap layers;
+    auto& mirroredRootLayer = mirrorLayer(rootLayer, layers);
+    {
+        LockHolder locker(m_lock);
+        std::swap(m_layers, layers);
+        m_rootLayer = &mirroredRootLayer;
+    }
+
+    // The previous tree is destroyed here. The compositor only draws with the lock held,
+    // so it is done with it.
+    layers.clear();
+
+    scheduleFrame(0_s);
+}
+
+void TextureMapperThreadedCompositor::setFrameInterval(Seconds interval)
+{
+    LockHolder locker(m_lock);
+    m_frameInterval = interval;
+}
+
+void TextureMapperThreadedCompositor::invalidate()
+{
+    ASSERT(isMainThread());
+
+    MirroredLayerMap layers;
+    {
+        LockHolder locker(m_lock);
+        m_rootLayer = nullptr;
+        layers = WTFMove(m_layers);
+    }
+
+    m_queue->dispatch([this, protectedThis = makeRef(*this)] {
+        m_textureMapper = nullptr;
+    });
+}
+
+TextureMapperLayer& TextureMapperThreadedCompositor::mirrorLayer(GraphicsLayerTextureMapper& source, MirroredLayerMap& layers)
+{
+    auto mirrored = std::make_unique<MirroredLayer>();
+
+    TextureMapperLayer& layer = *mirrored->layer;
+    layer.syncStateFrom(source.layer());
+
+    if (auto* backingStore = source.backingStore())
+        mirrored->backingStore = backingStore->createSnapshot();
+    if (auto* compositedImage = source.compositedImage())
+        mirrored->compositedImage = compositedImage->createSnapshot();
+    layer.setBackingStore(mirrored->backingStore.get());
+    layer.setContentsLayer(mirrored->compositedImage.get());
+
+    auto* maskLayer = source.maskLayer();
+    layer.setMaskLayer(maskLayer ? &mirrorLayer(downcast<GraphicsLayerTextureMapper>(*maskLayer), layers) : nullptr);
+    auto* replicaLayer = source.replicaLayer();
+    layer.setReplicaLayer(replicaLayer ? &mirrorLayer(downcast<GraphicsLayerTextureMapper>(*replicaLayer), layers) : nullptr);
+
+    Vector<TextureMapperLayer*> children;
+    children.reserveInitialCapacity(source.children().size());
+    for (auto& child : source.children())
+        children.uncheckedAppend(&mirrorLayer(downcast<GraphicsLayerTextureMapper>(child.get()), layers));
+    layer.setChildren(children);
+
+    layers.set(&source, WTFMove(mirrored));
+    return layer;
+}
+
+void TextureMapperThreadedCompositor::scheduleFrame(Seconds delay)
+{
+    {
+        LockHolder locker(m_lock);
+        if (m_isFrameScheduled)
+            return;
+        m_isFrameScheduled = true;
+    }
+
+    m_queue->dispatchAfter(delay, [this, protectedThis = makeRef(*this)] {
+        composite();
+    });
+}
+
+void TextureMapperThreadedCompositor::composite()
+{
+    ASSERT(!isMainThread());
+
+    bool hasRunningAnimations = false;
+    Seconds frameInterval;
+    {
+        LockHolder locker(m_lock);
+        m_isFrameScheduled = false;
+        if (!m_rootLayer || !m_textureMapper || !m_surface)
+            return;
+
+        m_lastFrameTime = MonotonicTime::now();
+        frameInterval = m_frameInterval;
+        m_rootLayer->setTextureMapper(m_textureMapper.get());
+        hasRunningAnimations = m_rootLayer->applyAnimationsRecursively(m_lastFrameTime);
+
+        m_surface->Clear();
+        m_textureMapper->beginPainting();
+        m_rootLayer->paint();
+        m_textureMapper->endPainting();
+    }
+
+    if (m_didComposite)
+        m_didComposite();
+
+    // Keep ticking while animations run; otherwise wait for the next commit.
+    if (hasRunningAnimations)
+        scheduleFrame(std::max(0_s, frameInterval - (MonotonicTime::now() - m_lastFrameTime)));
+}
+
+} // namespace WebCore
+
+#endif // USE(TEXTURE_MAPPER_ULTRALIGHT)
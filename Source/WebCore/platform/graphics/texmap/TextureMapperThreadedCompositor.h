@@ -0,0 +1,81 @@
+#pragma once
+
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+
+#include <Ultralight/private/Canvas.h>
+#include <wtf/Function.h>
+#include <wtf/HashMap.h>
+#include <wtf/Lock.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/WorkQueue.h>
+
+namespace WebCore {
+
+class GraphicsLayerTextureMapper;
+class TextureMapperLayer;
+class TextureMapperTiledBackingStore;
+class TextureMapperUltralight;
+
+// Composites a mirror of the GraphicsLayerTextureMapper tree on its own thread so that
+// accelerated transform, opacity and filter animations keep running while the main
+// thread is busy. This is opt-in: an embedder that creates one calls updateAndCommit()
+// instead of painting the root TextureMapperLayer itself.
+//
+// Each commit builds a new mirrored tree that draws snapshots of the backing stores, so
+// the main thread repaints and mirrors without blocking on a frame; m_lock is only held
+// to swap the committed tree. Platform contents layers other than composited images are
+// not mirrored.
+class WEBCORE_EXPORT TextureMapperThreadedCompositor : public ThreadSafeRefCounted<TextureMapperThreadedCompositor> {
+public:
+    // |didComposite| is called on the compositor thread after each frame.
+    static Ref<TextureMapperThreadedCompositor> create(ultralight::RefPtr<ultralight::Canvas> surface, Function<void()>&& didComposite);
+    ~TextureMapperThreadedCompositor();
+
+    // Main thread. Repaints dirty backing stores, mirrors the tree rooted at |rootLayer|,
+    // then swaps it in and schedules a frame.
+    void updateAndCommit(GraphicsLayerTextureMapper& rootLayer);
+
+    // Main thread. Drops the mirrored tree; no frames are produced afterwards.
+    void invalidate();
+
+    void setFrameInterval(Seconds);
+
+private:
+    TextureMapperThreadedCompositor(ultralight::RefPtr<ultralight::Canvas>, Function<void()>&&);
+
+    struct MirroredLayer {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        MirroredLayer();
+        ~MirroredLayer();
+
+        std::unique_ptr<TextureMapperLayer> layer;
+        RefPtr<TextureMapperTiledBackingStore> backingStore;
+        RefPtr<TextureMapperTiledBackingStore> compositedImage;
+    };
+    using MirroredLayerMap = HashMap<const GraphicsLayerTextureMapper*, std::unique_ptr<MirroredLayer>>;
+
+    static TextureMapperLayer& mirrorLayer(GraphicsLayerTextureMapper&, MirroredLayerMap&);
+
+    void scheduleFrame(Seconds delay);
+    void composite();
+
+    Ref<WorkQueue> m_queue;
+    ultralight::RefPtr<ultralight::Canvas> m_surface;
+    Function<void()> m_didComposite;
+
+    // Compositor thread only.
+    std::unique_ptr<TextureMapperUltralight> m_textureMapper;
+    MonotonicTime m_lastFrameTime;
+
+    Lock m_lock;
+    Seconds m_frameInterval { 1_s / 60 };
+    MirroredLayerMap m_layers;
+    TextureMapperLayer* m_rootLayer { nullptr };
+    bool m_isFrameScheduled { false };
+};
+
+} // namespace WebCore
+
+#endif // USE(TEXTURE_MAPPER_ULTRALIGHT)
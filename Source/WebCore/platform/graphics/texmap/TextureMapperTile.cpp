@@ -23,6 +23,10 @@
 #include "Image.h"
 #include "TextureMapper.h"
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+#include "BitmapTextureUltralight.h"
+#endif
+
 namespace WebCore {
 
 class GraphicsLayer;
@@ -40,10 +44,8 @@ void TextureMapperTile::updateContents(TextureMapper& textureMapper, Image* imag
 
     // Normalize targetRect to the texture's coordinates.
     targetRect.move(-m_rect.x(), -m_rect.y());
-    if (!m_texture) {
-        m_texture = textureMapper.createTexture();
-        m_texture->reset(targetRect.size(), image->currentFrameKnownToBeOpaque() ? 0 : BitmapTexture::SupportsAlpha);
-    }
+    if (!m_texture)
+        m_texture = textureMapper.acquireTextureFromPool(targetRect.size(), image->currentFrameKnownToBeOpaque() ? 0 : BitmapTexture::SupportsAlpha);
 
     m_texture->updateContents(image, targetRect, sourceOffset);
 }
@@ -59,18 +61,35 @@ void TextureMapperTile::updateContents(TextureMapper& textureMapper, GraphicsLay
     // Normalize targetRect to the texture's coordinates.
     targetRect.move(-m_rect.x(), -m_rect.y());
 
-    if (!m_texture) {
-        m_texture = textureMapper.createTexture();
-        m_texture->reset(targetRect.size(), BitmapTexture::SupportsAlpha);
-    }
+    // Size the texture to the whole tile, the first dirty rect may only cover part of it.
+    if (!m_texture)
+        m_texture = textureMapper.acquireTextureFromPool(roundedIntSize(m_rect.size()), BitmapTexture::SupportsAlpha);
 
     m_texture->updateContents(textureMapper, sourceLayer, targetRect, sourceOffset, scale);
 }
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+void TextureMapperTile::updateContents(TextureMapper& textureMapper, const DisplayList::DisplayList& displayList, const IntRect& dirtyRect, float scale)
+{
+    IntRect targetRect = enclosingIntRect(m_rect);
+    targetRect.intersect(dirtyRect);
+    if (targetRect.isEmpty())
+        return;
+    IntPoint sourceOffset = targetRect.location();
+
+    targetRect.move(-m_rect.x(), -m_rect.y());
+
+    if (!m_texture)
+        m_texture = textureMapper.acquireTextureFromPool(roundedIntSize(m_rect.size()), BitmapTexture::SupportsAlpha);
+
+    static_cast<BitmapTextureUltralight&>(*m_texture).updateContents(displayList, targetRect, sourceOffset, scale);
+}
+#endif
+
 void TextureMapperTile::paint(TextureMapper& textureMapper, const TransformationMatrix& transform, float opacity, const unsigned exposedEdges)
 {
-    if (texture().get())
-        textureMapper.drawTexture(*texture().get(), rect(), transform, opacity, exposedEdges);
+    if (m_texture)
+        textureMapper.drawTexture(*m_texture, rect(), transform, opacity, exposedEdges);
 }
 
 } // namespace WebCore
@@ -29,6 +29,12 @@ namespace WebCore {
 
 class GraphicsLayer;
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+namespace DisplayList {
+class DisplayList;
+}
+#endif
+
 class TextureMapperTile {
 public:
     inline RefPtr<BitmapTexture> texture() const { return m_texture; }
@@ -36,8 +42,23 @@ public:
     inline void setTexture(BitmapTexture* texture) { m_texture = texture; }
     inline void setRect(const FloatRect& rect) { m_rect = rect; }
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    // Set while a snapshot for TextureMapperThreadedCompositor may draw the texture, which
+    // then must not be painted into. detachSharedTexture() lets the tile start over.
+    bool isTextureShared() const { return m_isTextureShared; }
+    void setTextureShared(bool isTextureShared) { m_isTextureShared = isTextureShared; }
+    void detachSharedTexture()
+    {
+        m_texture = nullptr;
+        m_isTextureShared = false;
+    }
+#endif
+
     void updateContents(TextureMapper&, Image*, const IntRect&);
     void updateContents(TextureMapper&, GraphicsLayer*, const IntRect&, float scale = 1);
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    void updateContents(TextureMapper&, const DisplayList::DisplayList&, const IntRect&, float scale = 1);
+#endif
     WEBCORE_EXPORT virtual void paint(TextureMapper&, const TransformationMatrix&, float, const unsigned exposedEdges);
     virtual ~TextureMapperTile() = default;
 
@@ -49,6 +70,9 @@ protected:
     RefPtr<BitmapTexture> m_texture;
 private:
     FloatRect m_rect;
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    bool m_isTextureShared { false };
+#endif
 };
 
 }
@@ -25,6 +25,12 @@
 #include "ImageObserver.h"
 #include "TextureMapper.h"
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+#include "DisplayListRecorder.h"
+#include "GraphicsContext.h"
+#include "GraphicsLayer.h"
+#endif
+
 namespace WebCore {
 
 class GraphicsLayer;
@@ -75,97 +81,269 @@ void TextureMapperTiledBackingStore::updateContentsScale(float scale)
 
     m_isScaleDirty = true;
     m_contentsScale = scale;
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    // Painting snaps to device pixels, a recording made at another scale doesn't match.
+    m_recordedContents = nullptr;
+#endif
+}
+
+void TextureMapperTiledBackingStore::setVisibleRect(const FloatRect& visibleRect)
+{
+    if (m_visibleRect == visibleRect)
+        return;
+
+    m_visibleRect = visibleRect;
+    m_isVisibleRectDirty = true;
 }
 
-void TextureMapperTiledBackingStore::createOrDestroyTilesIfNeeded(const FloatSize& size, const IntSize& tileSize, bool hasAlpha)
+void TextureMapperTiledBackingStore::createOrDestroyTilesIfNeeded(const FloatSize& size, const IntSize& tileSize)
 {
-    if (size == m_size && !m_isScaleDirty)
+    if (size == m_size && !m_isScaleDirty && !m_isVisibleRectDirty)
         return;
 
     m_size = size;
     m_isScaleDirty = false;
+    m_isVisibleRectDirty = false;
 
     FloatSize scaledSize(m_size);
     if (!m_image)
         scaledSize.scale(m_contentsScale);
 
+    // Only tiles near the visible rect get a texture. The margin of one tile on each side
+    // lets small scrolls reveal content that is already painted.
+    FloatRect coverRect(FloatPoint::zero(), scaledSize);
+    if (!m_visibleRect.isInfinite()) {
+        FloatRect scaledVisibleRect = m_visibleRect;
+        if (!m_image)
+            scaledVisibleRect.scale(m_contentsScale);
+        scaledVisibleRect.inflateX(tileSize.width());
+        scaledVisibleRect.inflateY(tileSize.height());
+        coverRect.intersect(scaledVisibleRect);
+    }
+
     Vector<FloatRect> tileRectsToAdd;
-    Vector<int> tileIndicesToRemove;
-    static const size_t TileEraseThreshold = 6;
-
-    // This method recycles tiles. We check which tiles we need to add, which to remove, and use as many
-    // removable tiles as replacement for new tiles when possible.
-    for (float y = 0; y < scaledSize.height(); y += tileSize.height()) {
-        for (float x = 0; x < scaledSize.width(); x += tileSize.width()) {
-            FloatRect tileRect(x, y, tileSize.width(), tileSize.height());
-            tileRect.intersect(rect());
-            tileRectsToAdd.append(tileRect);
+    if (!coverRect.isEmpty()) {
+        float startX = std::floor(coverRect.x() / tileSize.width()) * tileSize.width();
+        float startY = std::floor(coverRect.y() / tileSize.height()) * tileSize.height();
+        for (float y = startY; y < coverRect.maxY(); y += tileSize.height()) {
+            for (float x = startX; x < coverRect.maxX(); x += tileSize.width()) {
+                FloatRect tileRect(x, y, tileSize.width(), tileSize.height());
+                tileRect.intersect(rect());
+                tileRectsToAdd.append(tileRect);
+            }
         }
     }
 
-    // Check which tiles need to be removed, and which already exist.
-    for (int i = m_tiles.size() - 1; i >= 0; --i) {
-        FloatRect oldTile = m_tiles[i].rect();
-        bool existsAlready = false;
+    // Keep the tiles that are still needed. Dropped tiles hand their texture back to the
+    // texture pool, which recycles it for the tiles added below.
+    m_tiles.removeAllMatching([&tileRectsToAdd](const TextureMapperTile& tile) {
+        size_t index = tileRectsToAdd.find(tile.rect());
+        if (index == notFound)
+            return true;
+        tileRectsToAdd.remove(index);
+        return false;
+    });
+
+    for (auto& rect : tileRectsToAdd)
+        m_tiles.append(TextureMapperTile(rect));
+}
 
-        for (int j = tileRectsToAdd.size() - 1; j >= 0; --j) {
-            FloatRect newTile = tileRectsToAdd[j];
-            if (oldTile != newTile)
-                continue;
+void TextureMapperTiledBackingStore::updateContents(TextureMapper& textureMapper, Image* image, const FloatSize& totalSize, const IntRect& dirtyRect)
+{
+    createOrDestroyTilesIfNeeded(totalSize, textureMapper.maxTextureSize());
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    detachSharedTiles(dirtyRect);
+#endif
+    for (auto& tile : m_tiles)
+        tile.updateContents(textureMapper, image, dirtyRect);
+}
 
-            // A tile that we want to add already exists, no need to add or remove it.
-            existsAlready = true;
-            tileRectsToAdd.remove(j);
-            break;
+void TextureMapperTiledBackingStore::updateContents(TextureMapper& textureMapper, GraphicsLayer* sourceLayer, const FloatSize& totalSize, const Vector<IntRect, 4>& dirtyRects)
+{
+    IntSize tileSize = textureMapper.maxTextureSize().shrunkTo(IntSize(LayerTileSize, LayerTileSize));
+    createOrDestroyTilesIfNeeded(totalSize, tileSize);
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    for (auto& dirtyRect : dirtyRects)
+        detachSharedTiles(dirtyRect);
+    if (updateContentsFromDisplayList(textureMapper, *sourceLayer, dirtyRects))
+        return;
+#endif
+    for (auto& tile : m_tiles) {
+        // Tiles that just came into view have no content yet.
+        if (!tile.texture()) {
+            tile.updateContents(textureMapper, sourceLayer, enclosingIntRect(tile.rect()), m_contentsScale);
+            continue;
         }
 
-        // This tile is not needed.
-        if (!existsAlready)
-            tileIndicesToRemove.append(i);
+        for (auto& dirtyRect : dirtyRects)
+            tile.updateContents(textureMapper, sourceLayer, dirtyRect, m_contentsScale);
     }
+}
 
-    // Recycle removable tiles to be used for newly requested tiles.
-    for (auto& rect : tileRectsToAdd) {
-        if (!tileIndicesToRemove.isEmpty()) {
-            // We recycle an existing tile for usage with a new tile rect.
-            TextureMapperTile& tile = m_tiles[tileIndicesToRemove.last()];
-            tileIndicesToRemove.removeLast();
-            tile.setRect(rect);
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+Ref<TextureMapperTiledBackingStore> TextureMapperTiledBackingStore::createSnapshot()
+{
+    auto snapshot = create();
+    snapshot->m_tiles = m_tiles;
+    snapshot->m_size = m_size;
+    snapshot->m_contentsScale = m_contentsScale;
+
+    for (auto& tile : m_tiles)
+        tile.setTextureShared(true);
+    return snapshot;
+}
+
+void TextureMapperTiledBackingStore::detachSharedTiles(const IntRect& dirtyRect)
+{
+    // A detached tile has no texture, so it is painted whole like a tile that just came
+    // into view.
+    for (auto& tile : m_tiles) {
+        if (tile.isTextureShared() && tile.rect().intersects(dirtyRect))
+            tile.detachSharedTexture();
+    }
+}
 
-            if (tile.texture()) {
-              FloatSize texSize = tile.rect().size();
-              texSize.setWidth(std::round(texSize.width()));
-              texSize.setHeight(std::round(texSize.height()));
+// Past this many invalidations it is cheaper to record the contents again.
+static const size_t maxStaleRects = 8;
 
-              tile.texture()->reset(IntSize(texSize), hasAlpha ? BitmapTexture::SupportsAlpha : 0);
+bool TextureMapperTiledBackingStore::updateContentsFromDisplayList(TextureMapper& textureMapper, GraphicsLayer& sourceLayer, const Vector<IntRect, 4>& dirtyRects)
+{
+    IntRect layerRect(IntPoint(), roundedIntSize(rect().size()));
+    for (auto& dirtyRect : dirtyRects) {
+        if (dirtyRect.contains(layerRect)) {
+            m_recordedContents = nullptr;
+            m_hasUnrecordableContents = false;
+            break;
+        }
+        invalidateRecordedContents(unscaledRect(dirtyRect));
+    }
+
+    if (m_hasUnrecordableContents)
+        return false;
+
+    struct TileUpdate {
+        TextureMapperTile* tile;
+        IntRect rect;
+    };
+    Vector<TileUpdate> replayUpdates;
+    Vector<TileUpdate> recordUpdates;
+    FloatRect recordRect;
+    bool hasNewTiles = false;
+
+    // Rects are scaled here, but replaying paints a couple of pixels around them, see
+    // BitmapTextureUltralight::paintContents().
+    auto layerRectForUpdate = [this, &layerRect](const IntRect& updateRect) {
+        FloatRect scaledRect = updateRect;
+        scaledRect.inflate(2);
+        scaledRect.intersect(layerRect);
+        return unscaledRect(scaledRect);
+    };
+
+    for (auto& tile : m_tiles) {
+        IntRect tileRect = enclosingIntRect(tile.rect());
+        // Tiles that just came into view have no content yet.
+        if (!tile.texture()) {
+            if (canReplayRecordedContents(layerRectForUpdate(tileRect)))
+                replayUpdates.append({ &tile, tileRect });
+            else {
+                recordUpdates.append({ &tile, tileRect });
+                recordRect.unite(layerRectForUpdate(tileRect));
+                hasNewTiles = true;
             }
             continue;
         }
 
-        m_tiles.append(TextureMapperTile(rect));
+        for (auto& dirtyRect : dirtyRects) {
+            IntRect updateRect = intersection(tileRect, dirtyRect);
+            if (updateRect.isEmpty())
+                continue;
+            recordUpdates.append({ &tile, updateRect });
+            recordRect.unite(layerRectForUpdate(updateRect));
+        }
     }
 
-    // Remove unnecessary tiles, if they weren't recycled.
-    // We use a threshold to make sure we don't create/destroy tiles too eagerly.
-    for (auto& index : tileIndicesToRemove) {
-        if (m_tiles.size() <= TileEraseThreshold)
-            break;
-        m_tiles.remove(index);
+    for (auto& update : replayUpdates)
+        update.tile->updateContents(textureMapper, m_recordedContents->displayList, update.rect, m_contentsScale);
+
+    if (recordUpdates.isEmpty())
+        return true;
+
+    // When painting new tiles, record the tiles around them too so that the next scroll
+    // can be served from the recording.
+    if (hasNewTiles) {
+        IntSize tileSize = textureMapper.maxTextureSize().shrunkTo(IntSize(LayerTileSize, LayerTileSize));
+        FloatRect scaledRecordRect = recordRect;
+        scaledRecordRect.scale(m_contentsScale);
+        scaledRecordRect.inflateX(tileSize.width());
+        scaledRecordRect.inflateY(tileSize.height());
+        scaledRecordRect.intersect(layerRect);
+        recordRect.unite(unscaledRect(scaledRecordRect));
+    }
+
+    auto recordedContents = recordContents(sourceLayer, recordRect);
+    if (recordedContents->displayList.hasUnrecordableDrawing()) {
+        m_hasUnrecordableContents = true;
+        for (auto& update : recordUpdates)
+            update.tile->updateContents(textureMapper, &sourceLayer, update.rect, m_contentsScale);
+        return true;
     }
+
+    for (auto& update : recordUpdates)
+        update.tile->updateContents(textureMapper, recordedContents->displayList, update.rect, m_contentsScale);
+
+    if (hasNewTiles)
+        m_recordedContents = WTFMove(recordedContents);
+    return true;
 }
 
-void TextureMapperTiledBackingStore::updateContents(TextureMapper& textureMapper, Image* image, const FloatSize& totalSize, const IntRect& dirtyRect)
+std::unique_ptr<TextureMapperTiledBackingStore::RecordedContents> TextureMapperTiledBackingStore::recordContents(GraphicsLayer& sourceLayer, const FloatRect& rect)
 {
-    createOrDestroyTilesIfNeeded(totalSize, textureMapper.maxTextureSize(), !image->currentFrameKnownToBeOpaque());
-    for (auto& tile : m_tiles)
-        tile.updateContents(textureMapper, image, dirtyRect);
+    auto contents = std::make_unique<RecordedContents>();
+    contents->rect = rect;
+
+    // Record with the same base CTM as a direct paint into a tile so that device-pixel
+    // snapping and text rendering decisions made while painting match.
+    AffineTransform baseCTM;
+    baseCTM.scale(m_contentsScale);
+
+    GraphicsContext context([&](GraphicsContext& recordingContext) {
+        return std::make_unique<DisplayList::Recorder>(recordingContext, contents->displayList, GraphicsContextState(), rect, baseCTM);
+    });
+    sourceLayer.paintGraphicsLayerContents(context, rect);
+    return contents;
 }
 
-void TextureMapperTiledBackingStore::updateContents(TextureMapper& textureMapper, GraphicsLayer* sourceLayer, const FloatSize& totalSize, const IntRect& dirtyRect)
+bool TextureMapperTiledBackingStore::canReplayRecordedContents(const FloatRect& rect) const
 {
-    createOrDestroyTilesIfNeeded(totalSize, textureMapper.maxTextureSize(), true);
-    for (auto& tile : m_tiles)
-        tile.updateContents(textureMapper, sourceLayer, dirtyRect, m_contentsScale);
+    if (!m_recordedContents || !m_recordedContents->rect.contains(rect))
+        return false;
+
+    for (auto& staleRect : m_recordedContents->staleRects) {
+        if (staleRect.intersects(rect))
+            return false;
+    }
+    return true;
+}
+
+void TextureMapperTiledBackingStore::invalidateRecordedContents(const FloatRect& rect)
+{
+    if (!m_recordedContents || !m_recordedContents->rect.intersects(rect))
+        return;
+
+    // The recording stays usable outside of the invalidated rects.
+    if (m_recordedContents->staleRects.size() == maxStaleRects) {
+        m_recordedContents = nullptr;
+        return;
+    }
+    m_recordedContents->staleRects.append(rect);
+}
+
+FloatRect TextureMapperTiledBackingStore::unscaledRect(const FloatRect& scaledRect) const
+{
+    FloatRect rect = scaledRect;
+    rect.scale(1 / m_contentsScale);
+    return rect;
 }
+#endif
 
 } // namespace WebCore
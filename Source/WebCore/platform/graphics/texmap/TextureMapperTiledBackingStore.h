@@ -27,6 +27,10 @@
 #include <wtf/RefCounted.h>
 #include <wtf/RefPtr.h>
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+#include "DisplayList.h"
+#endif
+
 namespace WebCore {
 
 class TextureMapper;
@@ -42,15 +46,31 @@ public:
 
     void updateContentsScale(float);
     void updateContents(TextureMapper&, Image*, const FloatSize&, const IntRect&);
-    void updateContents(TextureMapper&, GraphicsLayer*, const FloatSize&, const IntRect&);
+    void updateContents(TextureMapper&, GraphicsLayer*, const FloatSize&, const Vector<IntRect, 4>&);
+
+    // Layer contents are only kept for the tiles around this rect, in unscaled layer coordinates.
+    void setVisibleRect(const FloatRect&);
+    bool visibleRectChanged() const { return m_isVisibleRectDirty; }
 
     void setContentsToImage(Image* image) { m_image = image; }
+    void updateContentsFromImageIfNeeded(TextureMapper&);
+
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    // A backing store that draws the current tiles and is never updated, for
+    // TextureMapperThreadedCompositor to draw on its thread. Tiles shared with it get a new
+    // texture, painted whole, the next time they are updated here.
+    Ref<TextureMapperTiledBackingStore> createSnapshot();
+#endif
 
 private:
     TextureMapperTiledBackingStore() = default;
 
-    void createOrDestroyTilesIfNeeded(const FloatSize& backingStoreSize, const IntSize& tileSize, bool hasAlpha);
-    void updateContentsFromImageIfNeeded(TextureMapper&);
+    static const int LayerTileSize = 512;
+
+    void createOrDestroyTilesIfNeeded(const FloatSize& backingStoreSize, const IntSize& tileSize);
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    void detachSharedTiles(const IntRect& dirtyRect);
+#endif
     TransformationMatrix adjustedTransformForRect(const FloatRect&);
     inline FloatRect rect() const
     {
@@ -59,11 +79,39 @@ private:
         return rect;
     }
 
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    // Layer contents are recorded once per update and replayed into each tile that needs
+    // them. The last recording that painted new tiles is kept, so tiles that come into
+    // view later can be painted from it without walking the render tree again.
+    struct RecordedContents {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        DisplayList::DisplayList displayList;
+        FloatRect rect; // In unscaled layer coordinates, like everything below.
+        Vector<FloatRect> staleRects;
+    };
+
+    // Returns false if the contents have to be painted directly.
+    bool updateContentsFromDisplayList(TextureMapper&, GraphicsLayer&, const Vector<IntRect, 4>& dirtyRects);
+    std::unique_ptr<RecordedContents> recordContents(GraphicsLayer&, const FloatRect&);
+    bool canReplayRecordedContents(const FloatRect&) const;
+    void invalidateRecordedContents(const FloatRect&);
+    FloatRect unscaledRect(const FloatRect&) const;
+#endif
+
     Vector<TextureMapperTile> m_tiles;
     FloatSize m_size;
     RefPtr<Image> m_image;
     float m_contentsScale { 1 };
     bool m_isScaleDirty { false };
+    FloatRect m_visibleRect { FloatRect::infiniteRect() };
+    bool m_isVisibleRectDirty { false };
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+    std::unique_ptr<RecordedContents> m_recordedContents;
+    // Set once the contents turned out to need a platform context; they are then painted
+    // directly until the whole layer is repainted.
+    bool m_hasUnrecordableContents { false };
+#endif
 };
 
 } // namespace WebCore
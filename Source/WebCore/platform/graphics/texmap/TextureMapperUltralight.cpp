@@ -21,8 +21,32 @@ void TextureMapperUltralight::set_default_surface(
   default_surface_ = canvas;
 }
 
-void TextureMapperUltralight::drawBorder(const Color&, float borderWidth,
-    const FloatRect&, const TransformationMatrix&) {}
+void TextureMapperUltralight::drawBorder(const Color& color, float borderWidth,
+    const FloatRect& rect, const TransformationMatrix& modelViewMatrix) {
+  if (!current_surface_ || !color.isVisible() || borderWidth <= 0)
+    return;
+
+  // Four quads along the inside of |rect|, the canvas has no stroke primitive for rects.
+  float insetWidth = std::min(borderWidth, rect.width() / 2);
+  float insetHeight = std::min(borderWidth, rect.height() / 2);
+  FloatRect edges[] = {
+    { rect.x(), rect.y(), rect.width(), insetHeight },
+    { rect.x(), rect.maxY() - insetHeight, rect.width(), insetHeight },
+    { rect.x(), rect.y() + insetHeight, insetWidth, rect.height() - 2 * insetHeight },
+    { rect.maxX() - insetWidth, rect.y() + insetHeight, insetWidth, rect.height() - 2 * insetHeight },
+  };
+
+  ultralight::Paint paint;
+  paint.color = UltralightRGBA(color.red(), color.green(), color.blue(), color.alpha());
+
+  current_surface_->Save();
+  current_surface_->Transform(modelViewMatrix);
+  for (auto& edge : edges) {
+    if (!edge.isEmpty())
+      current_surface_->DrawRect(edge, paint);
+  }
+  current_surface_->Restore();
+}
 
 void TextureMapperUltralight::drawNumber(int number, const Color&,
     const FloatPoint&, const TransformationMatrix&) {}
@@ -51,7 +75,27 @@ void TextureMapperUltralight::drawTexture(const BitmapTexture& texture,
     //current_surface_->DrawRect({ 20, 20, 30, 30 }, paint);
 }
 
-void TextureMapperUltralight::drawSolidColor(const FloatRect&, const TransformationMatrix&, const Color&, bool) {}
+void TextureMapperUltralight::drawSolidColor(const FloatRect& rect,
+    const TransformationMatrix& modelViewMatrix, const Color& color,
+    bool isBlendingAllowed) {
+  if (!current_surface_ || rect.isEmpty())
+    return;
+
+  ultralight::Paint paint;
+  paint.color = UltralightRGBA(color.red(), color.green(), color.blue(), color.alpha());
+
+  // Opaque colors replace the destination outright, which lets the canvas skip blending.
+  bool blend = isBlendingAllowed && !color.isOpaque();
+
+  current_surface_->Save();
+  current_surface_->Transform(modelViewMatrix);
+  if (!blend)
+    current_surface_->set_blending_enabled(false);
+  current_surface_->DrawRect(rect, paint);
+  if (!blend)
+    current_surface_->set_blending_enabled(true);
+  current_surface_->Restore();
+}
 
 void TextureMapperUltralight::clearColor(const Color&) {
   // TODO
@@ -22,12 +22,24 @@ CanvasImage::~CanvasImage() {
   ultralight::GetBitmapSurfaceFactory()->DestroySurface(m_surface);
 }
 
+ultralight::RefPtr<ultralight::Canvas> CanvasImage::canvas() {
+  m_context->platformContext()->flushGlyphs();
+  return m_canvas;
+}
+
 void CanvasImage::computeIntrinsicDimensions(Length& intrinsicWidth, Length& intrinsicHeight, FloatSize& intrinsicRatio) {
   Image::computeIntrinsicDimensions(intrinsicWidth, intrinsicHeight, intrinsicRatio);
   intrinsicRatio = FloatSize();
 }
 
 ImageDrawResult CanvasImage::draw(GraphicsContext& context, const FloatRect& dstRect, const FloatRect& srcRect, CompositeOperator op, BlendMode mode, DecodingMode decodingMode, ImageOrientationDescription orientation) {
+  // Recording contexts forward image draws to their display list, anything that reaches
+  // us without a platform context can't be drawn.
+  if (!context.platformContext()) {
+    context.didSkipUnrecordableDrawing();
+    return ImageDrawResult::DidNothing;
+  }
+
   bool snap_to_pixels = false;
   IntPoint pixel_coords;
 
@@ -53,6 +65,7 @@ ImageDrawResult CanvasImage::draw(GraphicsContext& context, const FloatRect& dst
   ultralight::Paint paint;
   paint.color = UltralightColorWHITE;
   ultralight::Rect src_uv = m_canvas->render_target().uv_coords;
+  m_context->platformContext()->flushGlyphs();
 
   if (snap_to_pixels) {
     ultralight::Matrix identity_mat;
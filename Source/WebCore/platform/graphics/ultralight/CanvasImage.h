@@ -18,7 +18,8 @@ public:
 
   virtual ~CanvasImage();
 
-  ultralight::RefPtr<ultralight::Canvas> canvas() { return m_canvas; }
+  // Returns the backing canvas with everything drawn through context() submitted to it.
+  ultralight::RefPtr<ultralight::Canvas> canvas();
 
   // Inherited from Image:
   bool hasSingleSecurityOrigin() const override { return true; }
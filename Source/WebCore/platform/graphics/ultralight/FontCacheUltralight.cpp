@@ -119,7 +119,7 @@ public:
 
         FT_Face face;
         FT_Error error;
-        CString path8 = Convert(font_file_path).utf8();
+        CString path8 = ConvertToStringView(font_file_path).utf8();
         error = FT_New_Face(freetype, path8.data(), 0, &face);
         assert(error == 0);
         if (error != 0)
@@ -156,6 +156,15 @@ public:
     }
   }
 
+  size_t MemoryUsage() const {
+    size_t bytes = 0;
+    for (auto& entry : font_db_) {
+      if (entry.second && entry.second->face() && entry.second->face()->stream)
+        bytes += entry.second->face()->stream->size;
+    }
+    return bytes;
+  }
+
 protected:
   FontDatabase() {}
   ~FontDatabase() {}
@@ -168,6 +177,10 @@ protected:
   const long long entry_keep_alive_ms_ = 7000;
 };
 
+size_t FontFaceMemoryUsage() {
+  return FontDatabase::instance().MemoryUsage();
+}
+
 }  // namespace ultralight
 
 namespace WebCore {
@@ -7,9 +7,16 @@
 #include "CharacterProperties.h"
 #include "GlyphBuffer.h"
 #include "FontCache.h"
+#include "ShadowBlur.h"
 //#include "HarfBuzzShaper.h"
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/MainThread.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/text/StringHasher.h>
 #include <Ultralight/Bitmap.h>
 #include <Ultralight/private/Canvas.h>
+#include <Ultralight/private/Image.h>
 #include <Ultralight/platform/Platform.h>
 #include <Ultralight/platform/Config.h>
 #include "FontRenderer.h"
@@ -32,6 +39,159 @@ inline float TwentySixDotSix2Float(const int i)
 
 namespace WebCore {
 
+namespace {
+
+// Masks bigger than this are not worth blurring on the CPU, those runs fall back to a
+// solid shadow.
+const int maxShadowMaskDimension = 2048;
+const size_t maxCachedShadowMaskBytes = 8 * 1024 * 1024;
+
+// A blurred text shadow, rasterized and blurred once and drawn as an image afterwards.
+// |rect| is relative to the pen position of the first glyph on the baseline.
+struct TextShadowMask {
+  WTF_MAKE_FAST_ALLOCATED;
+public:
+  Vector<int32_t> key;
+  IntRect rect;
+  ultralight::RefPtr<ultralight::Image> image;
+
+  size_t byteSize() const { return rect.width() * rect.height() * 4; }
+};
+
+struct RasterizedGlyph {
+  IntRect rect;
+  Vector<uint8_t> coverage;
+};
+
+// Renders the run's coverage with FreeType and blurs it with ShadowBlur. This happens at
+// the font's CSS pixel size: the result is a blur, so the lost resolution under a
+// scaling transform doesn't show.
+std::unique_ptr<TextShadowMask> createTextShadowMask(FT_Face face, const Vector<ultralight::Glyph>& glyphs, float blurRadius, const Color& color)
+{
+  const auto& [firstIndex, origin] = glyphs.first();
+  UNUSED_VARIABLE(firstIndex);
+  Vector<RasterizedGlyph> rasterized;
+  IntRect bounds;
+  for (auto& [index, x] : glyphs) {
+    if (FT_Load_Glyph(face, index, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT))
+      continue;
+    FT_Bitmap& bitmap = face->glyph->bitmap;
+    if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY || !bitmap.width || !bitmap.rows)
+      continue;
+
+    RasterizedGlyph result;
+    result.rect = IntRect(lroundf(x - origin) + face->glyph->bitmap_left, -face->glyph->bitmap_top, bitmap.width, bitmap.rows);
+    result.coverage.resize(bitmap.width * bitmap.rows);
+    for (unsigned row = 0; row < bitmap.rows; ++row)
+      memcpy(result.coverage.data() + row * bitmap.width, bitmap.buffer + row * bitmap.pitch, bitmap.width);
+    bounds.unite(result.rect);
+    rasterized.append(WTFMove(result));
+  }
+
+  // Same padding ShadowBlur::blurredEdgeSize() gives its layers.
+  int edge = std::max(2, static_cast<int>(ceilf(blurRadius)));
+  bounds.inflate(edge);
+  if (rasterized.isEmpty() || bounds.width() > maxShadowMaskDimension || bounds.height() > maxShadowMaskDimension)
+    return nullptr;
+
+  auto bitmap = ultralight::Bitmap::Create(bounds.width(), bounds.height(), ultralight::kBitmapFormat_BGRA8_UNORM_SRGB);
+  uint8_t* pixels = (uint8_t*)bitmap->LockPixels();
+  size_t rowBytes = bitmap->row_bytes();
+  memset(pixels, 0, rowBytes * bounds.height());
+
+  // The blur reads and writes the alpha channel, the other channels are scratch space.
+  for (auto& glyph : rasterized) {
+    for (int row = 0; row < glyph.rect.height(); ++row) {
+      uint8_t* dest = pixels + (glyph.rect.y() - bounds.y() + row) * rowBytes + (glyph.rect.x() - bounds.x()) * 4 + 3;
+      const uint8_t* src = glyph.coverage.data() + row * glyph.rect.width();
+      for (int column = 0; column < glyph.rect.width(); ++column, dest += 4)
+        *dest = std::max(*dest, src[column]);
+    }
+  }
+
+  ShadowBlur blur(FloatSize(blurRadius, blurRadius), FloatSize(), color);
+  blur.blurLayerImage(pixels, bounds.size(), rowBytes);
+
+  // Bake the premultiplied shadow color into the mask.
+  for (int row = 0; row < bounds.height(); ++row) {
+    uint8_t* pixel = pixels + row * rowBytes;
+    for (int column = 0; column < bounds.width(); ++column, pixel += 4) {
+      unsigned alpha = fastDivideBy255(pixel[3] * color.alpha());
+      pixel[0] = fastDivideBy255(color.blue() * alpha);
+      pixel[1] = fastDivideBy255(color.green() * alpha);
+      pixel[2] = fastDivideBy255(color.red() * alpha);
+      pixel[3] = alpha;
+    }
+  }
+  bitmap->UnlockPixels();
+
+  auto mask = std::make_unique<TextShadowMask>();
+  mask->rect = bounds;
+  mask->image = ultralight::Image::Create();
+  mask->image->SetFrame(0, 1, *bitmap, true);
+  return mask;
+}
+
+// Keeps the blurred shadows of recently drawn runs, so text that doesn't change between
+// frames is only blurred once.
+class TextShadowMaskCache {
+public:
+  static TextShadowMaskCache& singleton()
+  {
+    static NeverDestroyed<TextShadowMaskCache> cache;
+    return cache;
+  }
+
+  const TextShadowMask* maskForRun(const FontPlatformData& platformData, FT_Face face, const Vector<ultralight::Glyph>& glyphs, float blurRadius, const Color& color)
+  {
+    ASSERT(isMainThread());
+    ASSERT(!glyphs.isEmpty());
+
+    // Glyph positions are keyed relative to the first glyph, in 26.6 fixed point.
+    Vector<int32_t> key;
+    key.reserveInitialCapacity(3 + glyphs.size() * 2);
+    key.uncheckedAppend(platformData.hash());
+    key.uncheckedAppend(lroundf(blurRadius * 64));
+    key.uncheckedAppend(color.rgb());
+    const auto& [firstIndex, origin] = glyphs.first();
+    UNUSED_VARIABLE(firstIndex);
+    for (auto& [index, x] : glyphs) {
+      key.uncheckedAppend(index);
+      key.uncheckedAppend(lroundf((x - origin) * 64));
+    }
+
+    unsigned hash = StringHasher::hashMemory(key.data(), key.size() * sizeof(int32_t));
+    auto it = m_masks.find(hash);
+    if (it != m_masks.end() && it->value->key == key) {
+      m_recentlyUsed.appendOrMoveToLast(hash);
+      return it->value.get();
+    }
+
+    auto mask = createTextShadowMask(face, glyphs, blurRadius, color);
+    if (!mask)
+      return nullptr;
+    mask->key = WTFMove(key);
+
+    auto* result = mask.get();
+    if (it != m_masks.end())
+      m_byteSize -= it->value->byteSize();
+    m_byteSize += mask->byteSize();
+    m_masks.set(hash, WTFMove(mask));
+    m_recentlyUsed.appendOrMoveToLast(hash);
+
+    while (m_byteSize > maxCachedShadowMaskBytes && m_recentlyUsed.first() != hash)
+      m_byteSize -= m_masks.take(m_recentlyUsed.takeFirst())->byteSize();
+    return result;
+  }
+
+private:
+  HashMap<unsigned, std::unique_ptr<TextShadowMask>> m_masks;
+  ListHashSet<unsigned> m_recentlyUsed;
+  size_t m_byteSize { 0 };
+};
+
+} // namespace
+
 bool FontCascade::canReturnFallbackFontsForComplexText()
 {
   return true;
@@ -47,8 +207,7 @@ void FontCascade::drawGlyphs(GraphicsContext& context, const Font& font, const G
 {
   WebCore::FontPlatformData& platform_font = const_cast<WebCore::FontPlatformData&>(font.platformData());
   WebCore::PlatformContextUltralight* platformContext = context.platformContext();
-  PlatformCanvas canvas = platformContext->canvas();
-  platform_font.font()->set_device_scale_hint((float)canvas->DeviceScaleHint());
+  platform_font.font()->set_device_scale_hint((float)platformContext->deviceScaleHint());
   const GlyphBufferGlyph* glyphs = glyphBuffer.glyphs(from);
   const GlyphBufferAdvance* advances = glyphBuffer.advances(from);
   FT_Face face = platform_font.face();
@@ -82,42 +241,36 @@ void FontCascade::drawGlyphs(GraphicsContext& context, const Font& font, const G
 
   if (glyphBuf.size()) {
     if (context.hasVisibleShadow()) {
-      /**
-      // TODO: Handle text shadows properly with offscreen blur filter
-
       WebCore::FloatSize shadow_size;
       float shadow_blur;
       WebCore::Color shadow_color;
       context.getShadow(shadow_size, shadow_blur, shadow_color);
 
-      ultralight::Paint paint;
-      paint.color = UltralightRGBA(shadow_color.red(), shadow_color.green(), shadow_color.blue(), shadow_color.alpha());
-
-      ultralight::Point shadow_offset = { shadow_size.width(), shadow_size.height() };
+      const TextShadowMask* mask = nullptr;
+      if (shadow_blur > 0.0f)
+        mask = TextShadowMaskCache::singleton().maskForRun(platform_font, face, glyphBuf, shadow_blur, shadow_color);
 
-      // Draw SDF twice to multiply (lol such a hack)
-      canvas->DrawGlyphs(*ultraFont, paint, glyphBuf.data(), glyphBuf.size(), glyph_scale, shadow_blur > 0.0f, shadow_offset);
-      canvas->DrawGlyphs(*ultraFont, paint, glyphBuf.data(), glyphBuf.size(), glyph_scale, shadow_blur > 0.0f, shadow_offset);
-      */
-
-      // We are just drawing text shadows ignoring blur right now.
-      WebCore::FloatSize shadow_size;
-      float shadow_blur;
-      WebCore::Color shadow_color;
-      context.getShadow(shadow_size, shadow_blur, shadow_color);
+      if (mask) {
+        FloatRect dest = mask->rect;
+        dest.move(point.x() + shadow_size.width(), pen_y + shadow_size.height());
 
-      ultralight::Paint paint;
-      paint.color = UltralightRGBA(shadow_color.red(), shadow_color.green(), shadow_color.blue(), shadow_color.alpha());
+        ultralight::Paint paint;
+        paint.color = UltralightColorWHITE;
+        platformContext->canvas()->DrawImage(mask->image, 0, FloatRect(FloatPoint(), mask->rect.size()), dest, paint);
+      } else {
+        ultralight::Paint paint;
+        paint.color = UltralightRGBA(shadow_color.red(), shadow_color.green(), shadow_color.blue(), shadow_color.alpha());
 
-      ultralight::Point shadow_offset = { shadow_size.width(), shadow_size.height() };
-      canvas->DrawGlyphs(*ultraFont, paint, pen_y, glyphBuf.data(), glyphBuf.size(), shadow_offset);
+        ultralight::Point shadow_offset = { shadow_size.width(), shadow_size.height() };
+        platformContext->drawGlyphs(ultraFont, paint, pen_y, glyphBuf.data(), glyphBuf.size(), shadow_offset);
+      }
     }
 
     ultralight::Paint paint;
     WebCore::Color color = context.fillColor();
     paint.color = UltralightRGBA(color.red(), color.green(), color.blue(), color.alpha());
 
-    canvas->DrawGlyphs(*ultraFont, paint, pen_y, glyphBuf.data(), glyphBuf.size(), ultralight::Point(0.0f, 0.0f));
+    platformContext->drawGlyphs(ultraFont, paint, pen_y, glyphBuf.data(), glyphBuf.size(), ultralight::Point(0.0f, 0.0f));
     glyphBuf.resize(0);
   }
 
@@ -5,15 +5,178 @@
 #include "PlatformContextUltralight.h"
 #include "NotImplemented.h"
 #include <algorithm>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/MainThread.h>
+#include <wtf/MathExtras.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/text/StringHasher.h>
 #include <Ultralight/private/Paint.h>
 #include <Ultralight/private/Canvas.h>
+#include <Ultralight/private/Path.h>
 
 namespace WebCore {
 
+namespace {
+
+// The Ultralight gradient shader evaluates at most this many stops per draw.
+const size_t maxShaderStops = 12;
+// Resolution of the baked ramp that conic gradients are drawn from.
+const size_t rampResolution = 256;
+const unsigned maxCachedRamps = 128;
+
+struct RampStop {
+  float offset;
+  RGBA32 color;
+
+  bool operator==(const RampStop& other) const { return offset == other.offset && color == other.color; }
+};
+
+// Everything derived from a stop list that doesn't depend on the gradient geometry.
+// Elements styled with the same gradient (buttons, list rows) share one of these.
+struct GradientRamp {
+  WTF_MAKE_FAST_ALLOCATED;
+public:
+  Vector<RampStop> stops;
+  Vector<RampStop, maxShaderStops> shaderStops;
+  Vector<RGBA32> samples;
+};
+
+inline RGBA32 interpolate(RGBA32 from, RGBA32 to, float t)
+{
+  auto channel = [t](int a, int b) { return clampTo<int>(lroundf(a + (b - a) * t), 0, 255); };
+  return makeRGBA(channel(redChannel(from), redChannel(to)), channel(greenChannel(from), greenChannel(to)),
+    channel(blueChannel(from), blueChannel(to)), channel(alphaChannel(from), alphaChannel(to)));
+}
+
+// Evaluates the piecewise-linear ramp through |stops| (sorted by offset) at |t|.
+template<typename StopVector>
+RGBA32 colorAt(const StopVector& stops, float t)
+{
+  if (t <= stops.first().offset)
+    return stops.first().color;
+  if (t >= stops.last().offset)
+    return stops.last().color;
+
+  size_t next = 1;
+  while (stops[next].offset < t)
+    ++next;
+  auto& a = stops[next - 1];
+  auto& b = stops[next];
+  if (b.offset <= a.offset)
+    return b.color;
+  return interpolate(a.color, b.color, (t - a.offset) / (b.offset - a.offset));
+}
+
+inline int colorDistance(RGBA32 a, RGBA32 b)
+{
+  return std::max({ std::abs(redChannel(a) - redChannel(b)), std::abs(greenChannel(a) - greenChannel(b)),
+    std::abs(blueChannel(a) - blueChannel(b)), std::abs(alphaChannel(a) - alphaChannel(b)) });
+}
+
+// Picks the stops the shader should use. Lists that fit are used as is. Longer lists
+// are reduced greedily: starting from the end points, keep adding the stop that the
+// current selection reproduces worst. Both ramps are piecewise linear through stops
+// of the original list, so the error is largest at one of those stops.
+void computeShaderStops(GradientRamp& ramp)
+{
+  auto& stops = ramp.stops;
+  if (stops.size() <= maxShaderStops) {
+    ramp.shaderStops.appendRange(stops.begin(), stops.end());
+    return;
+  }
+
+  Vector<bool> selected(stops.size(), false);
+  selected.first() = true;
+  selected.last() = true;
+  Vector<RampStop, maxShaderStops> selection { stops.first(), stops.last() };
+
+  while (selection.size() < maxShaderStops) {
+    size_t worst = notFound;
+    int worstError = 0;
+    for (size_t i = 1; i < stops.size() - 1; ++i) {
+      if (selected[i])
+        continue;
+      int error = colorDistance(stops[i].color, colorAt(selection, stops[i].offset));
+      if (error > worstError) {
+        worst = i;
+        worstError = error;
+      }
+    }
+    if (worst == notFound)
+      break;
+
+    selected[worst] = true;
+    selection.clear();
+    for (size_t i = 0; i < stops.size(); ++i) {
+      if (selected[i])
+        selection.uncheckedAppend(stops[i]);
+    }
+  }
+
+  ramp.shaderStops = WTFMove(selection);
+}
+
+const Vector<RGBA32>& bakedSamples(GradientRamp& ramp)
+{
+  if (ramp.samples.isEmpty()) {
+    ramp.samples.reserveInitialCapacity(rampResolution);
+    for (size_t i = 0; i < rampResolution; ++i)
+      ramp.samples.uncheckedAppend(colorAt(ramp.stops, static_cast<float>(i) / (rampResolution - 1)));
+  }
+  return ramp.samples;
+}
+
+class GradientRampCache {
+public:
+  static GradientRampCache& singleton()
+  {
+    static NeverDestroyed<GradientRampCache> cache;
+    return cache;
+  }
+
+  GradientRamp& rampForStops(const Gradient::ColorStopVector& colorStops)
+  {
+    ASSERT(isMainThread());
+    ASSERT(!colorStops.isEmpty());
+
+    Vector<RampStop> stops;
+    stops.reserveInitialCapacity(colorStops.size());
+    for (auto& stop : colorStops)
+      stops.uncheckedAppend({ stop.offset, stop.color.rgb() });
+
+    unsigned hash = StringHasher::hashMemory(stops.data(), stops.size() * sizeof(RampStop));
+    auto it = m_ramps.find(hash);
+    if (it != m_ramps.end() && it->value->stops == stops) {
+      m_recentlyUsed.appendOrMoveToLast(hash);
+      return *it->value;
+    }
+
+    auto ramp = std::make_unique<GradientRamp>();
+    ramp->stops = WTFMove(stops);
+    computeShaderStops(*ramp);
+
+    auto& result = *ramp;
+    m_ramps.set(hash, WTFMove(ramp));
+    m_recentlyUsed.appendOrMoveToLast(hash);
+    if (m_recentlyUsed.size() > maxCachedRamps)
+      m_ramps.remove(m_recentlyUsed.takeFirst());
+    return result;
+  }
+
+private:
+  HashMap<unsigned, std::unique_ptr<GradientRamp>> m_ramps;
+  ListHashSet<unsigned> m_recentlyUsed;
+};
+
+} // namespace
+
   void Gradient::platformDestroy()
   {
     if (m_gradient)
       delete m_gradient;
+    m_gradient = nullptr;
   }
 
   PlatformGradient Gradient::platformGradient()
@@ -40,13 +203,12 @@ namespace WebCore {
         grad->r1 = data.endRadius;
         return grad;
       },
-        [&](const ConicData&)  -> PlatformGradient {
-        // FIXME: implement conic gradient rendering.
+      [&](const ConicData&)  -> PlatformGradient {
+        // Conic gradients have no shader, see fillConic().
         return nullptr;
       }
     );
 
-    // Bail here if we are conic. (TODO)
     if (!m_gradient)
       return m_gradient;
 
@@ -56,24 +218,93 @@ namespace WebCore {
     m_gradient->p0 = ultralight::Point(mapped_p0.x(), mapped_p0.y());
     m_gradient->p1 = ultralight::Point(mapped_p1.x(), mapped_p1.y());
 
-    size_t num_stops = m_stops.size();
-
-    // Clamp to 12 stops
-    if (num_stops > 12)
-      num_stops = 12;
+    sortStopsIfNecessary();
+    if (m_stops.isEmpty())
+      return m_gradient;
 
-    m_gradient->num_stops = num_stops;
-    for (size_t i = 0; i < num_stops; ++i) {
-      m_gradient->stops[i].stop = m_stops[i].offset;
-      m_gradient->stops[i].color = UltralightRGBA(m_stops[i].color.red(), m_stops[i].color.green(), m_stops[i].color.blue(), m_stops[i].color.alpha());
+    auto& stops = GradientRampCache::singleton().rampForStops(m_stops).shaderStops;
+    m_gradient->num_stops = stops.size();
+    for (size_t i = 0; i < stops.size(); ++i) {
+      m_gradient->stops[i].stop = stops[i].offset;
+      m_gradient->stops[i].color = UltralightRGBA(redChannel(stops[i].color), greenChannel(stops[i].color), blueChannel(stops[i].color), alphaChannel(stops[i].color));
     }
 
     return m_gradient;
   }
 
+  // Draws the conic gradient centered at |data.point0| over |rect| as a fan of solid
+  // wedges colored from the baked ramp. Runs of wedges with the same color are filled
+  // as one path, so simple gradients only take a few draws.
+  static void fillConic(ultralight::Canvas& canvas, const Gradient::ConicData& data, GradientRamp& ramp, const AffineTransform& gradientSpaceTransform, const FloatRect& rect)
+  {
+    auto inverse = gradientSpaceTransform.inverse();
+    if (!inverse)
+      return;
+
+    FloatRect gradientSpaceRect = inverse->mapRect(rect);
+    float radius = 0;
+    for (auto& corner : { gradientSpaceRect.minXMinYCorner(), gradientSpaceRect.maxXMinYCorner(), gradientSpaceRect.minXMaxYCorner(), gradientSpaceRect.maxXMaxYCorner() })
+      radius = std::max(radius, (corner - data.point0).diagonalLength());
+    if (!radius)
+      return;
+
+    // Roughly two units of arc per wedge at the far corner. The fan overshoots the corners
+    // so the wedge edges never cut into the rect.
+    unsigned wedgeCount = clampTo<unsigned>(ceilf(2 * piFloat * radius / 2), 32, 720);
+    radius *= 1.5f;
+
+    auto& samples = bakedSamples(ramp);
+    auto colorForWedge = [&](unsigned wedge) {
+      float t = (wedge + 0.5f) / wedgeCount;
+      return samples[std::min<size_t>(t * rampResolution, rampResolution - 1)];
+    };
+    // CSS angles start at 12 o'clock and run clockwise.
+    auto pointAt = [&](unsigned wedge) {
+      float angle = data.angleRadians + 2 * piFloat * wedge / wedgeCount - piOverTwoFloat;
+      return ultralight::Point(data.point0.x() + radius * cosf(angle), data.point0.y() + radius * sinf(angle));
+    };
+
+    canvas.Save();
+    canvas.Transform(gradientSpaceTransform);
+
+    unsigned runStart = 0;
+    while (runStart < wedgeCount) {
+      RGBA32 color = colorForWedge(runStart);
+      unsigned runEnd = runStart + 1;
+      while (runEnd < wedgeCount && colorForWedge(runEnd) == color)
+        ++runEnd;
+
+      auto path = ultralight::Path::Create();
+      path->MoveTo({ data.point0.x(), data.point0.y() });
+      for (unsigned wedge = runStart; wedge <= runEnd; ++wedge)
+        path->LineTo(pointAt(wedge));
+      path->Close();
+
+      ultralight::Paint paint;
+      paint.color = UltralightRGBA(redChannel(color), greenChannel(color), blueChannel(color), alphaChannel(color));
+      canvas.FillPath(path, paint, ultralight::kFillRule_NonZero);
+      runStart = runEnd;
+    }
+
+    canvas.Restore();
+  }
+
   void Gradient::fill(GraphicsContext& context, const FloatRect& rect)
   {
-    context.platformContext()->canvas()->DrawGradient(platformGradient(), rect);
+    auto& canvas = *context.platformContext()->canvas();
+    if (WTF::holds_alternative<ConicData>(m_data)) {
+      sortStopsIfNecessary();
+      if (m_stops.isEmpty())
+        return;
+
+      canvas.Save();
+      canvas.SetClip(rect, false);
+      fillConic(canvas, WTF::get<ConicData>(m_data), GradientRampCache::singleton().rampForStops(m_stops), m_gradientSpaceTransformation, rect);
+      canvas.Restore();
+      return;
+    }
+
+    canvas.DrawGradient(platformGradient(), rect);
   }
 
 } // namespace WebCore
@@ -52,11 +52,13 @@ void GraphicsContext::platformDestroy()
   delete m_data;
 }
 
-AffineTransform GraphicsContext::getCTM(IncludeDeviceScale) const
+AffineTransform GraphicsContext::getCTM(IncludeDeviceScale includeScale) const
 {
   if (paintingDisabled())
     return AffineTransform();
 
+  if (m_impl)
+    return m_impl->getCTM(includeScale);
 
   ASSERT(hasPlatformContext());
   ultralight::RefPtr<ultralight::Canvas> canvas = platformContext()->canvas();
@@ -66,7 +68,8 @@ AffineTransform GraphicsContext::getCTM(IncludeDeviceScale) const
 
 PlatformContextUltralight* GraphicsContext::platformContext() const
 {
-  return m_data->platformContext;
+  // Recording contexts have no platform context, see didSkipUnrecordableDrawing().
+  return m_data ? m_data->platformContext : nullptr;
 }
 
 void GraphicsContext::savePlatformState()
@@ -92,6 +95,11 @@ void GraphicsContext::drawRect(const FloatRect& rect, float borderThickness)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawRect(rect, borderThickness);
+    return;
+  }
+
   ASSERT(!rect.isEmpty());
   ASSERT(hasPlatformContext());
   fillRect(rect, platformContext()->fillColor());
@@ -103,6 +111,11 @@ void GraphicsContext::drawNativeImage(const NativeImagePtr& image, const FloatSi
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawNativeImage(image, imageSize, destRect, srcRect, op, blendMode, orientation);
+    return;
+  }
+
   // TODO
   notImplemented();
 }
@@ -113,6 +126,11 @@ void GraphicsContext::drawLine(const FloatPoint& point1, const FloatPoint& point
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawLine(point1, point2);
+    return;
+  }
+
   if (strokeStyle() == NoStroke)
     return;
 
@@ -126,6 +144,11 @@ void GraphicsContext::drawEllipse(const FloatRect& rect)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawEllipse(rect);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   ultralight::Paint paint;
   WebCore::Color color = fillColor();
@@ -149,6 +172,11 @@ void GraphicsContext::fillPath(const Path& path)
   if (paintingDisabled() || path.isEmpty())
     return;
 
+  if (m_impl) {
+    m_impl->fillPath(path);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   if (m_state.fillGradient) {
@@ -172,6 +200,11 @@ void GraphicsContext::strokePath(const Path& path)
   if (paintingDisabled() || path.isEmpty())
     return;
 
+  if (m_impl) {
+    m_impl->strokePath(path);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   ultralight::Paint paint;
@@ -212,6 +245,14 @@ void GraphicsContext::strokePath(const Path& path)
 
 void GraphicsContext::fillRect(const FloatRect& rect)
 {
+  if (paintingDisabled())
+    return;
+
+  if (m_impl) {
+    m_impl->fillRect(rect);
+    return;
+  }
+
   if (m_state.fillGradient) {
     platformContext()->save();
     m_state.fillGradient->fill(*this, rect);
@@ -227,6 +268,11 @@ void GraphicsContext::fillRect(const FloatRect& rect, const Color& color)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->fillRect(rect, color);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   if (hasShadow()) {
@@ -250,6 +296,11 @@ void GraphicsContext::clip(const FloatRect& rect)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clip(rect);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   platformContext()->canvas()->SetClip(rect, false);
 
@@ -279,6 +330,13 @@ void GraphicsContext::clipRoundedRect(const FloatRoundedRect& rect)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    Path path;
+    path.addRoundedRect(rect);
+    m_impl->clipPath(path, WindRule::NonZero);
+    return;
+  }
+
   ultralight::RoundedRect rrect;
   rrect.rect = rect.rect();
   rrect.radii_x[0] = rect.radii().topLeft().width();
@@ -298,6 +356,13 @@ void GraphicsContext::clipOutRoundedRect(const FloatRoundedRect& rect)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    Path path;
+    path.addRoundedRect(rect);
+    m_impl->clipOut(path);
+    return;
+  }
+
   if (!rect.isRounded()) {
     clipOut(rect.rect());
     return;
@@ -319,6 +384,12 @@ void GraphicsContext::clipOutRoundedRect(const FloatRoundedRect& rect)
 
 IntRect GraphicsContext::clipBounds() const
 {
+  if (paintingDisabled())
+    return IntRect();
+
+  if (m_impl)
+    return m_impl->clipBounds();
+
   return IntRect(platformContext()->canvas()->GetClipBounds());
 }
 
@@ -327,6 +398,11 @@ void GraphicsContext::clipPath(const Path& path, WindRule clipRule)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clipPath(path, clipRule);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   platformContext()->setMask(path, clipRule);
 }
@@ -336,6 +412,11 @@ void GraphicsContext::clipToImageBuffer(ImageBuffer& buffer, const FloatRect& de
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clipToImageBuffer(buffer, destRect);
+    return;
+  }
+
   // TODO
   notImplemented();
 }
@@ -375,11 +456,16 @@ static inline StrokeStyle focusRingStrokeStyle()
 #endif
 }
 
-void GraphicsContext::drawFocusRing(const Path& path, float width, float /* offset */, const Color& color)
+void GraphicsContext::drawFocusRing(const Path& path, float width, float offset, const Color& color)
 {
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawFocusRing(path, width, offset, color);
+    return;
+  }
+
   // FIXME: We should draw paths that describe a rectangle with rounded corners
   // so as to be consistent with how we draw rectangular focus rings.
   Color ringColor = color;
@@ -395,11 +481,16 @@ void GraphicsContext::drawFocusRing(const Path& path, float width, float /* offs
   platformContext()->canvas()->StrokePath(path.ultralightPath(), paint, width * 0.5 / scaleFactor().width());
 }
 
-void GraphicsContext::drawFocusRing(const Vector<FloatRect>& rects, float width, float /* offset */, const Color& color)
+void GraphicsContext::drawFocusRing(const Vector<FloatRect>& rects, float width, float offset, const Color& color)
 {
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawFocusRing(rects, width, offset, color);
+    return;
+  }
+
   unsigned rectCount = rects.size();
   int radius = (width - 1) / 2;
 
@@ -428,6 +519,11 @@ void GraphicsContext::drawLinesForText(const FloatPoint& point, float thickness,
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawLinesForText(point, thickness, widths, printing, doubleUnderlines);
+    return;
+  }
+
   if (widths.isEmpty())
     return;
 
@@ -479,17 +575,28 @@ void GraphicsContext::drawLinesForText(const FloatPoint& point, float thickness,
     platformContext()->canvas()->DrawRect(dash, paint);
 }
 
-void GraphicsContext::drawDotsForDocumentMarker(const FloatRect&, DocumentMarkerLineStyle)
+void GraphicsContext::drawDotsForDocumentMarker(const FloatRect& rect, DocumentMarkerLineStyle style)
 {
-	// TODO
-	notImplemented();
+  if (paintingDisabled())
+    return;
+
+  if (m_impl) {
+    m_impl->drawDotsForDocumentMarker(rect, style);
+    return;
+  }
+
+  // TODO
+  notImplemented();
 }
 
-FloatRect GraphicsContext::roundToDevicePixels(const FloatRect& frect, RoundingMode)
+FloatRect GraphicsContext::roundToDevicePixels(const FloatRect& frect, RoundingMode roundingMode)
 {
   if (paintingDisabled())
     return frect;
 
+  if (m_impl)
+    return m_impl->roundToDevicePixels(frect, roundingMode);
+
   // TODO
   notImplemented();
   return frect;
@@ -500,6 +607,11 @@ void GraphicsContext::translate(float x, float y)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->translate(x, y);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   AffineTransform transform;
   transform.translate(x, y);
@@ -572,6 +684,11 @@ void GraphicsContext::concatCTM(const AffineTransform& transform)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->concatCTM(transform);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   platformContext()->canvas()->Transform(transform);
 }
@@ -581,6 +698,11 @@ void GraphicsContext::setCTM(const AffineTransform& transform)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->setCTM(transform);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
   platformContext()->canvas()->SetMatrix(transform);
 }
@@ -641,6 +763,11 @@ void GraphicsContext::clearRect(const FloatRect& rect)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clearRect(rect);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   auto canvas = platformContext()->canvas();
@@ -678,6 +805,11 @@ void GraphicsContext::strokeRect(const FloatRect& rect, float width)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->strokeRect(rect, width);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   if (width < 0.001)
@@ -701,6 +833,11 @@ void GraphicsContext::setLineCap(LineCap lineCap)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->setLineCap(lineCap);
+    return;
+  }
+
   platformContext()->setLineCap(lineCap);
 }
 
@@ -718,6 +855,11 @@ void GraphicsContext::setLineDash(const DashArray& dashes, float dashOffset)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->setLineDash(dashes, dashOffset);
+    return;
+  }
+
   // TODO
   notImplemented();
 }
@@ -727,6 +869,11 @@ void GraphicsContext::setLineJoin(LineJoin lineJoin)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->setLineJoin(lineJoin);
+    return;
+  }
+
   platformContext()->setLineJoin(lineJoin);
 }
 
@@ -735,6 +882,11 @@ void GraphicsContext::setMiterLimit(float miter)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->setMiterLimit(miter);
+    return;
+  }
+
   platformContext()->setMiterLimit(miter);
 }
 
@@ -762,6 +914,11 @@ void GraphicsContext::clipOut(const Path& path)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clipOut(path);
+    return;
+  }
+
   ultralight::RefPtr<ultralight::Path> p = path.ultralightPath();
   // CoreGraphics seems to use EvenOdd rule here so we do the same.
   ultralight::FillRule fill_rule = ultralight::kFillRule_EvenOdd;
@@ -773,6 +930,11 @@ void GraphicsContext::rotate(float radians)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->rotate(radians);
+    return;
+  }
+
   double cosAngle = cos(radians);
   double sinAngle = sin(radians);
   AffineTransform transform(cosAngle, sinAngle, -sinAngle, cosAngle, 0, 0);
@@ -785,6 +947,11 @@ void GraphicsContext::scale(const FloatSize& size)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->scale(size);
+    return;
+  }
+
   AffineTransform transform;
   transform.scale(size);
 
@@ -796,6 +963,11 @@ void GraphicsContext::clipOut(const FloatRect& r)
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->clipOut(r);
+    return;
+  }
+
   platformContext()->canvas()->SetClip(r, true);
 }
 
@@ -835,11 +1007,36 @@ void GraphicsContext::platformFillRoundedRect(const FloatRoundedRect& rect, cons
   }
 }
 
+void GraphicsContext::drawBoxShadow(const FloatRoundedRect& rect, const FloatSize& offset, float radius, const Color& color, bool inset, const FloatRoundedRect& clipRect)
+{
+  if (paintingDisabled())
+    return;
+
+  if (m_impl) {
+    m_impl->drawBoxShadow(rect, offset, radius, color, inset, clipRect);
+    return;
+  }
+
+  ASSERT(hasPlatformContext());
+  platformContext()->DrawBoxShadow(rect, offset, radius, color, inset, clipRect);
+}
+
+void GraphicsContext::didSkipUnrecordableDrawing()
+{
+  if (m_impl)
+    m_impl->didSkipUnrecordableDrawing();
+}
+
 void GraphicsContext::fillRectWithRoundedHole(const FloatRect& rect, const FloatRoundedRect& roundedHoleRect, const Color& color)
 {
   if (paintingDisabled() || !color.isValid())
     return;
 
+  if (m_impl) {
+    m_impl->fillRectWithRoundedHole(rect, roundedHoleRect, color);
+    return;
+  }
+
   // AFAIK, this is only called from RenderBoxModelObject::paintBoxShadow when
   // it wants to draw an inset shadow.
 
@@ -876,6 +1073,11 @@ void GraphicsContext::drawPattern(Image& image, const FloatRect& destRect, const
   if (paintingDisabled())
     return;
 
+  if (m_impl) {
+    m_impl->drawPattern(image, destRect, tileRect, patternTransform, phase, spacing, op, blendMode);
+    return;
+  }
+
   ASSERT(hasPlatformContext());
 
   // Avoid NaN
@@ -14,21 +14,46 @@
 #include <Ultralight/private/Path.h>
 #include <math.h>
 #include <wtf/MathExtras.h>
+#include <wtf/Optional.h>
+#include <wtf/RefCounted.h>
 #include <wtf/text/WTFString.h>
 
 #include "NotImplemented.h"
 
 namespace WebCore {
 
-class UltralightPath {
+// Path storage is shared between copies of a WebCore::Path and only cloned when one
+// of them is about to change. SVG and border painting copy paths freely and usually
+// only read them. The bounding box is cached since layout and repaint ask for it
+// repeatedly.
+class UltralightPath : public RefCounted<UltralightPath> {
+  WTF_MAKE_FAST_ALLOCATED;
 public:
   UltralightPath() : m_path(ultralight::Path::Create()) {}
-  ~UltralightPath() {}
+
+  explicit UltralightPath(const UltralightPath& other)
+    : m_path(ultralight::Path::Create())
+    , m_boundingRect(other.m_boundingRect)
+  {
+    m_path->Set(other.m_path);
+  }
 
   ultralight::Ref<ultralight::Path> path() const { return m_path; }
 
+  FloatRect boundingRect() const
+  {
+    if (!m_boundingRect) {
+      auto aabb = m_path->aabb();
+      m_boundingRect = FloatRect(aabb.x(), aabb.y(), aabb.width(), aabb.height());
+    }
+    return *m_boundingRect;
+  }
+
+  void invalidateBounds() { m_boundingRect = WTF::nullopt; }
+
 private:
   ultralight::Ref<ultralight::Path> m_path;
+  mutable Optional<FloatRect> m_boundingRect;
   friend class Path;
 };
 
@@ -40,17 +65,14 @@ Path::Path()
 Path::~Path()
 {
   if (m_path)
-    delete m_path;
+    m_path->deref();
 }
 
 Path::Path(const Path& other)
-  : m_path(0)
+  : m_path(other.m_path)
 {
-  if (other.isNull())
-    return;
-
-  auto path = ensurePlatformPath()->path();
-  path->Set(other.platformPath()->path());
+  if (m_path)
+    m_path->ref();
 }
 
 Path::Path(Path&& other)
@@ -64,7 +86,7 @@ Path& Path::operator=(Path&& other)
 	if (this == &other)
 		return *this;
 	if (m_path)
-		delete m_path;
+		m_path->deref();
 	m_path = other.m_path;
 	other.m_path = nullptr;
 	return *this;
@@ -79,30 +101,43 @@ PlatformPathPtr Path::ensurePlatformPath() const
 
 Path& Path::operator=(const Path& other)
 {
-  if (&other == this)
+  if (m_path == other.m_path)
     return *this;
 
-  if (other.isNull()) {
-    if (m_path) {
-      delete m_path;
-      m_path = 0;
-    }
-  }
-  else {
-    auto path = ensurePlatformPath()->path();
-    path->Set(other.platformPath()->path());
-  }
+  if (other.m_path)
+    other.m_path->ref();
+  if (m_path)
+    m_path->deref();
+  m_path = other.m_path;
 
   return *this;
 }
 
+ultralight::Ref<ultralight::Path> Path::mutableUltralightPath()
+{
+  auto* storage = ensurePlatformPath();
+  if (!storage->hasOneRef()) {
+    m_path = new UltralightPath(*storage);
+    storage->deref();
+  }
+
+  m_path->invalidateBounds();
+  return m_path->path();
+}
+
 void Path::clear()
 {
   if (isNull())
     return;
 
-  auto path = ensurePlatformPath()->path();
-  path->Clear();
+  // No need to copy storage that is about to be emptied.
+  if (!m_path->hasOneRef()) {
+    m_path->deref();
+    m_path = new UltralightPath();
+    return;
+  }
+
+  mutableUltralightPath()->Clear();
 }
 
 bool Path::isEmpty() const
@@ -134,19 +169,19 @@ void Path::translate(const FloatSize& p)
 
 void Path::moveTo(const FloatPoint& p)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   path->MoveTo({ p.x(), p.y() });
 }
 
 void Path::addLineTo(const FloatPoint& p)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   path->LineTo({ p.x(), p.y() });
 }
 
 void Path::addRect(const FloatRect& rect)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   // Draw clockwise rectangle with LineTo
   path->MoveTo({ rect.x(), rect.y() });
   path->LineTo({ rect.x() + rect.width(), rect.y() });
@@ -158,14 +193,14 @@ void Path::addRect(const FloatRect& rect)
 
 void Path::addQuadCurveTo(const FloatPoint& controlPoint, const FloatPoint& point)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   path->ConicTo({ controlPoint.x(), controlPoint.y() }, 
                 { point.x(), point.y() });
 }
 
 void Path::addBezierCurveTo(const FloatPoint& controlPoint1, const FloatPoint& controlPoint2, const FloatPoint& controlPoint3)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   path->CubicTo({ controlPoint1.x(), controlPoint1.y() },
                 { controlPoint2.x(), controlPoint2.y() },
                 { controlPoint3.x(), controlPoint3.y() });
@@ -176,7 +211,7 @@ void Path::addArc(const FloatPoint& p, float r, float startAngle, float endAngle
   if (!std::isfinite(r) || !std::isfinite(startAngle) || !std::isfinite(endAngle))
     return;
 
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   float sweep = endAngle - startAngle;
   const float twoPI = 2 * piFloat;
   if ((sweep <= -twoPI || sweep >= twoPI)
@@ -203,7 +238,7 @@ static inline float areaOfTriangleFormedByPoints(const FloatPoint& p1, const Flo
 
 void Path::addArcTo(const FloatPoint& p1, const FloatPoint& p2, float radius)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
 
   ultralight::Point cur_p = path->current_point();                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                              
   FloatPoint p0(cur_p.x, cur_p.y);
@@ -279,7 +314,7 @@ void Path::addArcTo(const FloatPoint& p1, const FloatPoint& p2, float radius)
 
 void Path::addEllipse(FloatPoint point, float radiusX, float radiusY, float rotation, float startAngle, float endAngle, bool anticlockwise)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   auto& matrix = path->matrix();
   ultralight::Matrix old_matrix = matrix;
   matrix.Translate(point.x(), point.y());
@@ -291,7 +326,7 @@ void Path::addEllipse(FloatPoint point, float radiusX, float radiusY, float rota
 
 void Path::addEllipse(const FloatRect& rect)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   auto& matrix = path->matrix();
   ultralight::Matrix old_matrix = matrix;
   float yRadius = .5 * rect.height();
@@ -309,7 +344,7 @@ void Path::addPath(const Path& path, const AffineTransform& transform)
 
 void Path::closeSubpath()
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
   path->Close();
 }
 
@@ -319,8 +354,7 @@ FloatRect Path::boundingRect() const
   if (isNull())
     return FloatRect();
 
-  auto aabb = platformPath()->path()->aabb();
-  return FloatRect(aabb.x(), aabb.y(), aabb.width(), aabb.height());
+  return platformPath()->boundingRect();
 }
 
 FloatRect Path::strokeBoundingRect(StrokeStyleApplier* applier) const
@@ -401,7 +435,7 @@ void Path::apply(const PathApplierFunction& function) const
 
 void Path::transform(const AffineTransform& trans)
 {
-  auto path = ensurePlatformPath()->path();
+  auto path = mutableUltralightPath();
 
   // TODO: the Cairo port inverts the matrix right here, should we do the same??
 
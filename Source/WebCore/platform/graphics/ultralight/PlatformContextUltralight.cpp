@@ -53,14 +53,54 @@ PlatformContextUltralight::PlatformContextUltralight(PlatformCanvas canvas) : m_
 
 PlatformContextUltralight::~PlatformContextUltralight()
 {
+  flushGlyphs();
 }
 
 PlatformCanvas PlatformContextUltralight::canvas() {
+  flushGlyphs();
   return m_canvas;
 }
 
+double PlatformContextUltralight::deviceScaleHint() const
+{
+  return m_canvas->DeviceScaleHint();
+}
+
+void PlatformContextUltralight::drawGlyphs(ultralight::RefPtr<ultralight::Font> font, const ultralight::Paint& paint, float baseline,
+  const ultralight::Glyph* glyphs, size_t count, const ultralight::Point& offset)
+{
+  auto& batch = m_glyphBatch;
+  if (!batch.glyphs.isEmpty()) {
+    bool canAppend = batch.font.get() == font.get() && batch.paint.color == paint.color && batch.baseline == baseline
+      && batch.offset.x == offset.x && batch.offset.y == offset.y;
+    if (!canAppend)
+      flushGlyphs();
+  }
+
+  if (batch.glyphs.isEmpty()) {
+    batch.font = font;
+    batch.paint = paint;
+    batch.baseline = baseline;
+    batch.offset = offset;
+  }
+  batch.glyphs.append(glyphs, count);
+}
+
+void PlatformContextUltralight::flushGlyphs()
+{
+  auto& batch = m_glyphBatch;
+  if (batch.glyphs.isEmpty())
+    return;
+
+  m_canvas->DrawGlyphs(*batch.font, batch.paint, batch.baseline, batch.glyphs.data(), batch.glyphs.size(), batch.offset);
+  // Keep the capacity around, the next line of text will need it.
+  batch.glyphs.shrink(0);
+  batch.font = nullptr;
+}
+
 void PlatformContextUltralight::save()
 {
+  flushGlyphs();
   m_stateStack.append(State(*m_state));
   m_state = &m_stateStack.last();
 
@@ -69,6 +109,7 @@ void PlatformContextUltralight::save()
 
 void PlatformContextUltralight::restore()
 {
+  flushGlyphs();
   m_canvas->Restore();
 
   m_stateStack.removeLast();
@@ -78,6 +119,7 @@ void PlatformContextUltralight::restore()
 
 void PlatformContextUltralight::setGlobalAlpha(float globalAlpha)
 {
+  flushGlyphs();
   m_canvas->SetAlpha(globalAlpha);
 }
 
@@ -95,6 +137,7 @@ bool PlatformContextUltralight::shouldAntialias() const {
 }
 
 void PlatformContextUltralight::setCompositeOperator(CompositeOperator op) {
+  flushGlyphs();
   m_canvas->SetCompositeOp((ultralight::CompositeOp)op);
 }
 
@@ -103,6 +146,7 @@ CompositeOperator PlatformContextUltralight::compositeOperator() const {
 }
 
 void PlatformContextUltralight::setBlendMode(BlendMode mode) {
+  flushGlyphs();
   m_canvas->SetBlendMode((ultralight::BlendMode)mode);
 }
 
@@ -274,6 +318,7 @@ void PlatformContextUltralight::DrawBoxDecorations(const FloatRect& layout_rect,
 
   ultralight::Color bgColor = UltralightRGBA(fill_color.red(), fill_color.green(), fill_color.blue(), fill_color.alpha());
 
+  flushGlyphs();
   m_canvas->DrawBoxDecorations(layout_rect, rrect1, rrect2, border_top, border_right, border_bottom, border_left, bgColor);
 }
 
@@ -300,6 +345,7 @@ void PlatformContextUltralight::DrawRoundedRect(const FloatRect& layout_rect, co
   Color fill_color, float stroke_width, Color stroke_color) {
   ultralight::Paint paint;
   paint.color = ToColor(fill_color);
+  flushGlyphs();
   m_canvas->DrawRoundedRect(ToRoundedRect(rrect), paint, stroke_width, ToColor(stroke_color));
 }
 
@@ -319,6 +365,7 @@ void PlatformContextUltralight::DrawBoxShadow(const FloatRoundedRect& rect, cons
 
   ultralight::Paint paint;
   paint.color = ToColor(shadowColor);
+  flushGlyphs();
   m_canvas->DrawBoxShadow(paintRect, ToRoundedRect(rect), ToRoundedRect(clip_rect), insetShadow,
     { shadowOffset.width(), shadowOffset.height() }, shadowBlur, paint);
 }
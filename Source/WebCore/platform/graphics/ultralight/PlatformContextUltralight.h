@@ -26,8 +26,12 @@ namespace WebCore {
     PlatformContextUltralight(PlatformCanvas);
     ~PlatformContextUltralight();
 
+    // Flushes any batched glyphs before handing out the canvas, so callers can draw
+    // into it directly without reordering against pending text.
     PlatformCanvas canvas();
 
+    double deviceScaleHint() const;
+
     ShadowBlur& shadowBlur() { return m_shadowBlur; }
 
     void save();
@@ -83,6 +87,13 @@ namespace WebCore {
     void DrawBoxShadow(const FloatRoundedRect& rect, const FloatSize& shadowOffset, float shadowBlur,
       const Color& shadowColor, bool insetShadow, const FloatRoundedRect& clip_rect);
 
+    // Queues a glyph run. Consecutive runs that share font, paint color, baseline and offset
+    // are submitted to the canvas as a single DrawGlyphs call. The batch is flushed by
+    // any other use of the canvas.
+    void drawGlyphs(ultralight::RefPtr<ultralight::Font> font, const ultralight::Paint& paint, float baseline,
+      const ultralight::Glyph* glyphs, size_t count, const ultralight::Point& offset);
+    void flushGlyphs();
+
   private:
     void clipForPatternFilling(const GraphicsContextState&);
 
@@ -96,6 +107,14 @@ namespace WebCore {
     // so it does not need to be on the state stack.
     ShadowBlur m_shadowBlur;
 
+    struct GlyphBatch {
+      ultralight::RefPtr<ultralight::Font> font;
+      ultralight::Paint paint;
+      float baseline;
+      ultralight::Point offset;
+      WTF::Vector<ultralight::Glyph> glyphs;
+    };
+    GlyphBatch m_glyphBatch;
   };
 
 } // namespace WebCore
@@ -2,10 +2,15 @@
 
 #if USE(ULTRALIGHT)
 
+#include <stddef.h>
+
 namespace ultralight {
 
 void EnsurePlatformFontFactory();
 
+// Bytes of font data held by the faces currently loaded in the font database.
+size_t FontFaceMemoryUsage();
+
 }  // namespace ultralight
 
 #endif  // USE(ULTRALIGHT)
@@ -30,12 +30,15 @@
 #include "PublicSuffix.h"
 #include "RegistrableDomain.h"
 #include "SQLiteFileSystem.h"
+#include "SQLiteTransaction.h"
 #include <wtf/FileSystem.h>
-#include <wtf/MonotonicTime.h>
 #include <wtf/Optional.h>
 #include <wtf/URL.h>
 #include <wtf/Vector.h>
+#include <wtf/WallTime.h>
+#include <wtf/WorkQueue.h>
 #include <wtf/text/StringConcatenateNumbers.h>
+#include <wtf/threads/BinarySemaphore.h>
 
 namespace WebCore {
 
@@ -61,10 +64,6 @@ namespace WebCore {
     "CREATE INDEX IF NOT EXISTS domain_index ON Cookie(domain);"
 #define CREATE_PATH_INDEX_SQL \
     "CREATE INDEX IF NOT EXISTS path_index ON Cookie(path);"
-#define CHECK_EXISTS_COOKIE_SQL \
-    "SELECT domain FROM Cookie WHERE ((domain = ?) OR (domain GLOB ?));"
-#define CHECK_EXISTS_HTTPONLY_COOKIE_SQL \
-    "SELECT name FROM Cookie WHERE (name = ?) AND (domain = ?) AND (path = ?) AND (httponly = 1);"
 #define SET_COOKIE_SQL \
     "INSERT OR REPLACE INTO Cookie (name, value, domain, path, expires, size, session, httponly, secure) "\
     "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
@@ -72,6 +71,10 @@ namespace WebCore {
     "DELETE FROM Cookie WHERE name = ? AND domain = ? AND path = ?;"
 #define DELETE_COOKIE_BY_NAME_DOMAIN_SQL \
     "DELETE FROM Cookie WHERE name = ? AND domain = ?;"
+#define SELECT_ALL_COOKIES_SQL \
+    "SELECT name, value, domain, path, expires, httponly, secure, session FROM Cookie "\
+    "WHERE NOT ((session = 0) AND (datetime(expires, 'unixepoch') < datetime('now'))) "\
+    "ORDER BY lastupdated;"
 #define DELETE_ALL_SESSION_COOKIE_SQL \
     "DELETE FROM Cookie WHERE session = 1;"
 #define DELETE_ALL_COOKIE_SQL \
@@ -83,23 +86,82 @@ namespace WebCore {
 // - Add upgrade logic in verifySchemaVersion to migrate databases from the previous schema version
 static constexpr int schemaVersion = 1;
 
+// The whole cookie file normally fits in the map, so lookups read it in place. Read pages then
+// don't need the page cache, which mostly holds pages waiting to be written.
+static constexpr int64_t memoryMapSize = 4 * MB;
+static constexpr int64_t cacheSize = 512 * KB;
+
+// Changes are held for this long so a burst of them is written in one transaction.
+static const Seconds databaseUpdateInterval { 1_s };
+
+// Past this many pending changes the batch is written right away, to bound the memory they use.
+static const size_t maximumPendingChanges = 1000;
+
+static WorkQueue& cookieDatabaseQueue()
+{
+    static auto& queue = WorkQueue::create("org.webkit.CookieJarDB", WorkQueue::Type::Serial, WorkQueue::QOS::Background).leakRef();
+    return queue;
+}
+
+// Copies the fields the database keeps. The strings are isolated copies, so the result can be
+// handed to the database queue.
+static Cookie storedCookie(const Cookie& cookie)
+{
+    Cookie result;
+    result.name = cookie.name.isolatedCopy();
+    result.value = cookie.value.isolatedCopy();
+    result.domain = cookie.domain.isolatedCopy();
+    result.path = cookie.path.isolatedCopy();
+    result.expires = cookie.session ? 0 : static_cast<double>(static_cast<int64_t>(cookie.expires));
+    result.httpOnly = cookie.httpOnly;
+    result.secure = cookie.secure;
+    result.session = cookie.session;
+    return result;
+}
 
 CookieJarDB::CookieJarDB(const String& databasePath)
-    : m_databasePath(databasePath)
+    : m_databasePath(databasePath.isolatedCopy())
+    , m_databaseUpdateTimer(*this, &CookieJarDB::updateDatabase)
 {
 }
 
 CookieJarDB::~CookieJarDB()
 {
-    closeDatabase();
+    updateDatabase();
+
+    // The queue uses this object, wait for the writes above before going away.
+    BinarySemaphore semaphore;
+    cookieDatabaseQueue().dispatch([this, &semaphore] {
+        closeDatabase();
+        semaphore.signal();
+    });
+    semaphore.wait();
 }
 
 void CookieJarDB::open()
 {
-    if (!m_database.isOpen()) {
-        checkDatabaseCorruptionAndRemoveIfNeeded();
-        openDatabase();
-    }
+    if (m_isOpen)
+        return;
+
+    // Nothing can be answered without the stored cookies, so this is the one place that waits
+    // for the queue. The cookies are only referenced from the vector, so it can be moved back.
+    bool isOpen = false;
+    Vector<Cookie> cookies;
+    BinarySemaphore semaphore;
+    cookieDatabaseQueue().dispatch([this, &isOpen, &cookies, &semaphore] {
+        if (!m_database.isOpen()) {
+            checkDatabaseCorruptionAndRemoveIfNeeded();
+            if (openDatabase())
+                cookies = readCookies();
+        }
+        isOpen = m_database.isOpen();
+        semaphore.signal();
+    });
+    semaphore.wait();
+
+    m_isOpen = isOpen;
+    for (auto& cookie : cookies)
+        m_memoryStore.set(WTFMove(cookie));
 }
 
 bool CookieJarDB::openDatabase()
@@ -139,6 +201,9 @@ bool CookieJarDB::openDatabase()
     if (!m_database.isOpen())
         return false;
 
+    // The queue doesn't promise to run every task on the same thread.
+    m_database.disableThreadingChecks();
+
     if (!isOnMemory() && !m_database.turnOnIncrementalAutoVacuum())
         LOG_ERROR("Unable to turn on incremental auto-vacuum (%d %s)", m_database.lastError(), m_database.lastErrorMsg());
 
@@ -156,11 +221,12 @@ bool CookieJarDB::openDatabase()
     }
 
     m_database.setSynchronous(SQLiteDatabase::SyncNormal);
+    if (!isOnMemory())
+        m_database.setMemoryMapSize(memoryMapSize);
+    m_database.setCacheSize(cacheSize);
 
     // create prepared statements
     createPrepareStatement(SET_COOKIE_SQL);
-    createPrepareStatement(CHECK_EXISTS_COOKIE_SQL);
-    createPrepareStatement(CHECK_EXISTS_HTTPONLY_COOKIE_SQL);
     createPrepareStatement(DELETE_COOKIE_BY_NAME_DOMAIN_PATH_SQL);
     createPrepareStatement(DELETE_COOKIE_BY_NAME_DOMAIN_SQL);
 
@@ -169,12 +235,8 @@ bool CookieJarDB::openDatabase()
 
 void CookieJarDB::closeDatabase()
 {
-    if (m_database.isOpen()) {
-        for (const auto& statement : m_statements)
-            statement.value.get()->finalize();
-        m_statements.clear();
+    if (m_database.isOpen())
         m_database.close();
-    }
 }
 
 void CookieJarDB::verifySchemaVersion()
@@ -343,23 +405,12 @@ bool CookieJarDB::hasCookies(const URL& url)
         return false;
 #endif
 
-    RegistrableDomain registrableDomain { url };
-    auto& statement = preparedStatement(CHECK_EXISTS_COOKIE_SQL);
-
-    if (CookieUtil::isIPAddress(host) || !host.contains('.') || registrableDomain.isEmpty()) {
-        statement.bindText(1, host);
-        statement.bindNull(2);
-    } else {
-        statement.bindText(1, registrableDomain.string());
-        statement.bindText(2, String("*.") + registrableDomain.string());
-    }
-
-    return statement.step() == SQLITE_ROW;
+    return m_memoryStore.hasCookies(host);
 }
 
 Optional<Vector<Cookie>> CookieJarDB::searchCookies(const URL& firstParty, const URL& requestUrl, const Optional<bool>& httpOnly, const Optional<bool>& secure, const Optional<bool>& session)
 {
-    if (!isEnabled() || !m_database.isOpen())
+    if (!isEnabled() || !m_isOpen)
         return WTF::nullopt;
 
     String requestHost = requestUrl.host().convertToASCIILowercase();
@@ -373,89 +424,15 @@ Optional<Vector<Cookie>> CookieJarDB::searchCookies(const URL& firstParty, const
     if (requestPath.isEmpty())
         requestPath = "/";
 
-    RegistrableDomain registrableDomain { requestUrl };
-
-    const String sql =
-        "SELECT name, value, domain, path, expires, httponly, secure, session FROM Cookie WHERE "\
-        "(NOT ((session = 0) AND (datetime(expires, 'unixepoch') < datetime('now')))) "\
-        "AND (httponly = COALESCE(NULLIF(?, -1), httponly)) "\
-        "AND (secure = COALESCE(NULLIF(?, -1), secure)) "\
-        "AND (session = COALESCE(NULLIF(?, -1), session)) "\
-        "AND ((domain = ?) OR (domain GLOB ?)) "\
-        "ORDER BY length(path) DESC, lastupdated";
-
-    auto pstmt = std::make_unique<SQLiteStatement>(m_database, sql);
-    if (!pstmt)
-        return WTF::nullopt;
-
-    pstmt->prepare();
-    pstmt->bindInt(1, httpOnly ? *httpOnly : -1);
-    pstmt->bindInt(2, secure ? *secure : -1);
-    pstmt->bindInt(3, session ? *session : -1);
-    pstmt->bindText(4, requestHost);
+    auto results = m_memoryStore.search(requestHost, requestPath, httpOnly, secure, session, MAX_COOKIE_PER_DOMAIN);
 
-    if (CookieUtil::isIPAddress(requestHost) || !requestHost.contains('.') || registrableDomain.isEmpty())
-        pstmt->bindNull(5);
-    else
-        pstmt->bindText(5, String("*.") + registrableDomain.string());
-
-    if (!pstmt)
-        return WTF::nullopt;
-
-    Vector<Cookie> results;
-
-    while (pstmt->step() == SQLITE_ROW) {
-
-        if (results.size() > MAX_COOKIE_PER_DOMAIN)
-            break;
-
-        String cookieName = pstmt->getColumnText(0);
-        String cookieValue = pstmt->getColumnText(1);
-        String cookieDomain = pstmt->getColumnText(2).convertToASCIILowercase();
-        String cookiePath = pstmt->getColumnText(3);
-        double cookieExpires = (double)pstmt->getColumnInt64(4) * 1000;
-        bool cookieHttpOnly = (pstmt->getColumnInt(5) == 1);
-        bool cookieSecure = (pstmt->getColumnInt(6) == 1);
-        bool cookieSession = (pstmt->getColumnInt(7) == 1);
-
-        if (!CookieUtil::domainMatch(cookieDomain, requestHost))
-            continue;
-
-        // https://tools.ietf.org/html/rfc6265#section-5.1.4 "Paths and Path-Match"
-        bool isPathMatched = cookiePath == requestPath
-            || (requestPath.startsWith(cookiePath) && cookiePath.endsWith('/'))
-            || (requestPath.startsWith(cookiePath) && (requestPath.characterAt(cookiePath.length()) == '/'));
-
-        if (!isPathMatched)
-            continue;
-
-        Cookie cookie;
-        cookie.name = cookieName;
-        cookie.value = cookieValue;
-        cookie.domain = cookieDomain;
-        cookie.path = cookiePath;
-        cookie.expires = cookieExpires;
-        cookie.httpOnly = cookieHttpOnly;
-        cookie.secure = cookieSecure;
-        cookie.session = cookieSession;
-        results.append(WTFMove(cookie));
-    }
-    pstmt->finalize();
+    // The jar keeps expiration dates in seconds, Cookie expects milliseconds.
+    for (auto& cookie : results)
+        cookie.expires *= 1000;
 
     return results;
 }
 
-bool CookieJarDB::hasHttpOnlyCookie(const String& name, const String& domain, const String& path)
-{
-    auto& statement = preparedStatement(CHECK_EXISTS_HTTPONLY_COOKIE_SQL);
-
-    statement.bindText(1, name);
-    statement.bindText(2, domain);
-    statement.bindText(3, path);
-
-    return statement.step() == SQLITE_ROW;
-}
-
 bool CookieJarDB::canAcceptCookie(const Cookie& cookie, const URL& firstParty, const URL& url, CookieJarDB::Source source)
 {
 #if ENABLE(PUBLIC_SUFFIX_LIST)
@@ -464,7 +441,7 @@ bool CookieJarDB::canAcceptCookie(const Cookie& cookie, const URL& firstParty, c
 #endif
 
     bool fromJavaScript = source == CookieJarDB::Source::Script;
-    if (fromJavaScript && (cookie.httpOnly || hasHttpOnlyCookie(cookie.name, cookie.domain, cookie.path)))
+    if (fromJavaScript && (cookie.httpOnly || m_memoryStore.hasHttpOnlyCookie(cookie.name, cookie.domain, cookie.path)))
         return false;
 
     if (!CookieUtil::domainMatch(cookie.domain, url.host().convertToASCIILowercase()))
@@ -478,27 +455,18 @@ bool CookieJarDB::canAcceptCookie(const Cookie& cookie, const URL& firstParty, c
 
 bool CookieJarDB::setCookie(const Cookie& cookie)
 {
-    if (!cookie.session && MonotonicTime::fromRawSeconds(cookie.expires) <= MonotonicTime::now())
+    if (!cookie.session && WallTime::fromRawSeconds(cookie.expires) <= WallTime::now())
         return deleteCookieInternal(cookie.name, cookie.domain, cookie.path);
 
-    auto& statement = preparedStatement(SET_COOKIE_SQL);
-
     // FIXME: We should have some eviction policy when a domain goes over MAX_COOKIE_PER_DOMAIN
-    statement.bindText(1, cookie.name);
-    statement.bindText(2, cookie.value);
-    statement.bindText(3, cookie.domain);
-    statement.bindText(4, cookie.path);
-    statement.bindInt64(5, cookie.session ? 0 : static_cast<int64_t>(cookie.expires));
-    statement.bindInt(6, cookie.value.length());
-    statement.bindInt(7, cookie.session ? 1 : 0);
-    statement.bindInt(8, cookie.httpOnly ? 1 : 0);
-    statement.bindInt(9, cookie.secure ? 1 : 0);
-    return checkSQLiteReturnCode(statement.step());
+    m_memoryStore.set(storedCookie(cookie));
+    addDatabaseChange({ storedCookie(cookie), false });
+    return true;
 }
 
 bool CookieJarDB::setCookie(const URL& firstParty, const URL& url, const String& body, CookieJarDB::Source source)
 {
-    if (!isEnabled() || !m_database.isOpen())
+    if (!isEnabled() || !m_isOpen)
         return false;
 
     if (url.isEmpty() || body.isEmpty())
@@ -522,7 +490,7 @@ bool CookieJarDB::setCookie(const URL& firstParty, const URL& url, const String&
 
 bool CookieJarDB::deleteCookie(const String& url, const String& name)
 {
-    if (!isEnabled() || !m_database.isOpen())
+    if (!isEnabled() || !m_isOpen)
         return false;
 
     String urlCopied = String(url);
@@ -541,12 +509,14 @@ bool CookieJarDB::deleteCookie(const String& url, const String& name)
 
 bool CookieJarDB::deleteCookieInternal(const String& name, const String& domain, const String& path)
 {
-    auto& statement = preparedStatement(path.isEmpty() ? DELETE_COOKIE_BY_NAME_DOMAIN_SQL : DELETE_COOKIE_BY_NAME_DOMAIN_PATH_SQL);
-    statement.bindText(1, name);
-    statement.bindText(2, domain);
-    if (!path.isEmpty())
-        statement.bindText(3, path);
-    return checkSQLiteReturnCode(statement.step());
+    m_memoryStore.remove(name, domain, path);
+
+    Cookie removedCookie;
+    removedCookie.name = name.isolatedCopy();
+    removedCookie.domain = domain.isolatedCopy();
+    removedCookie.path = path.isolatedCopy();
+    addDatabaseChange({ WTFMove(removedCookie), true });
+    return true;
 }
 
 bool CookieJarDB::deleteCookies(const String&)
@@ -558,26 +528,146 @@ bool CookieJarDB::deleteCookies(const String&)
 
 bool CookieJarDB::deleteAllCookies()
 {
-    if (!isEnabled() || !m_database.isOpen())
+    if (!isEnabled() || !m_isOpen)
         return false;
 
-    return executeSql(DELETE_ALL_COOKIE_SQL);
+    m_memoryStore.clear();
+
+    // Earlier changes would all be undone by the delete anyway.
+    m_pendingChanges.clear();
+    m_pendingClear = true;
+    scheduleDatabaseUpdate();
+    return true;
+}
+
+void CookieJarDB::addDatabaseChange(DatabaseChange&& change)
+{
+    m_pendingChanges.append(WTFMove(change));
+    scheduleDatabaseUpdate();
+}
+
+void CookieJarDB::scheduleDatabaseUpdate()
+{
+    if (m_pendingChanges.size() >= maximumPendingChanges) {
+        updateDatabase();
+        return;
+    }
+
+    if (!m_databaseUpdateTimer.isActive())
+        m_databaseUpdateTimer.startOneShot(databaseUpdateInterval);
+}
+
+void CookieJarDB::updateDatabase()
+{
+    m_databaseUpdateTimer.stop();
+
+    if (!m_pendingClear && m_pendingChanges.isEmpty())
+        return;
+
+    cookieDatabaseQueue().dispatch([this, clearCookies = m_pendingClear, changes = WTFMove(m_pendingChanges)] {
+        writeChanges(clearCookies, changes);
+    });
+
+    m_pendingChanges = { };
+    m_pendingClear = false;
+}
+
+Vector<Cookie> CookieJarDB::readCookies()
+{
+    Vector<Cookie> cookies;
+
+    SQLiteStatement statement(m_database, SELECT_ALL_COOKIES_SQL);
+    if (!checkSQLiteReturnCode(statement.prepare())) {
+        LOG_ERROR("Failed to prepare the cookie import statement - %s", m_database.lastErrorMsg());
+        return cookies;
+    }
+
+    int result;
+    while ((result = statement.step()) == SQLITE_ROW) {
+        Cookie cookie;
+        cookie.name = statement.getColumnText(0);
+        cookie.value = statement.getColumnText(1);
+        cookie.domain = statement.getColumnText(2);
+        cookie.path = statement.getColumnText(3);
+        cookie.expires = statement.getColumnInt64(4);
+        cookie.httpOnly = statement.getColumnInt(5) == 1;
+        cookie.secure = statement.getColumnInt(6) == 1;
+        cookie.session = statement.getColumnInt(7) == 1;
+        cookies.append(WTFMove(cookie));
+    }
+
+    if (!checkSQLiteReturnCode(result))
+        LOG_ERROR("Failed to read all cookies (%d) - %s", result, m_database.lastErrorMsg());
+
+    return cookies;
+}
+
+void CookieJarDB::writeChanges(bool clearCookies, const Vector<DatabaseChange>& changes)
+{
+    if (!m_database.isOpen())
+        return;
+
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+
+    if (clearCookies)
+        executeSql(DELETE_ALL_COOKIE_SQL);
+
+    // A failed change is logged and skipped, like it was when every change had its own transaction.
+    for (auto& change : changes) {
+        bool succeeded = change.isRemoval ? deleteCookieFromDatabase(change.cookie.name, change.cookie.domain, change.cookie.path) : setCookieInDatabase(change.cookie);
+        if (!succeeded)
+            LOG_ERROR("Failed to update cookie %s - %s", change.cookie.name.utf8().data(), m_database.lastErrorMsg());
+    }
+
+    transaction.commit();
+}
+
+bool CookieJarDB::setCookieInDatabase(const Cookie& cookie)
+{
+    auto* statement = preparedStatement(SET_COOKIE_SQL);
+    if (!statement)
+        return false;
+
+    statement->bindText(1, cookie.name);
+    statement->bindText(2, cookie.value);
+    statement->bindText(3, cookie.domain);
+    statement->bindText(4, cookie.path);
+    statement->bindInt64(5, static_cast<int64_t>(cookie.expires));
+    statement->bindInt(6, cookie.value.length());
+    statement->bindInt(7, cookie.session ? 1 : 0);
+    statement->bindInt(8, cookie.httpOnly ? 1 : 0);
+    statement->bindInt(9, cookie.secure ? 1 : 0);
+    return checkSQLiteReturnCode(statement->step());
+}
+
+bool CookieJarDB::deleteCookieFromDatabase(const String& name, const String& domain, const String& path)
+{
+    auto* statement = preparedStatement(path.isEmpty() ? DELETE_COOKIE_BY_NAME_DOMAIN_SQL : DELETE_COOKIE_BY_NAME_DOMAIN_PATH_SQL);
+    if (!statement)
+        return false;
+
+    statement->bindText(1, name);
+    statement->bindText(2, domain);
+    if (!path.isEmpty())
+        statement->bindText(3, path);
+    return checkSQLiteReturnCode(statement->step());
 }
 
 void CookieJarDB::createPrepareStatement(const String& sql)
 {
-    auto statement = std::make_unique<SQLiteStatement>(m_database, sql);
-    int ret = statement->prepare();
-    ASSERT(ret == SQLITE_OK);
-    m_statements.add(sql, WTFMove(statement));
+    auto* statement = m_database.cachedStatement(sql);
+    ASSERT_UNUSED(statement, statement);
 }
 
-SQLiteStatement& CookieJarDB::preparedStatement(const String& sql)
+SQLiteStatement* CookieJarDB::preparedStatement(const String& sql)
 {
-    const auto& statement = m_statements.get(sql);
-    ASSERT(statement);
-    statement->reset();
-    return *statement;
+    // The cache prepares the statement again after a failed step, which fails on a corrupted
+    // database like the step did.
+    auto* statement = m_database.cachedStatement(sql);
+    if (!statement)
+        checkSQLiteReturnCode(m_database.lastError());
+    return statement;
 }
 
 bool CookieJarDB::executeSql(const String& sql)
@@ -25,8 +25,10 @@
 #pragma once
 
 #include "Cookie.h"
+#include "CookieJarMemoryStore.h"
 #include "SQLiteDatabase.h"
 #include "SQLiteStatement.h"
+#include "Timer.h"
 #include <wtf/HashMap.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/text/StringHash.h>
@@ -40,6 +42,9 @@ enum class CookieAcceptPolicy {
     ExclusivelyFromMainDocumentDomain
 };
 
+// Cookies are read from the SQLite file once, when the jar is opened, and served from memory
+// after that. Changes are applied to memory right away and written to the file in batches on a
+// background queue, so the request path never waits for SQLite.
 class CookieJarDB {
     WTF_MAKE_NONCOPYABLE(CookieJarDB);
 
@@ -67,6 +72,13 @@ public:
     WEBCORE_EXPORT ~CookieJarDB();
 
 private:
+    // A cookie to store, or if isRemoval is set, the name, domain and path of the cookies to
+    // delete. An empty path deletes the cookies under every path.
+    struct DatabaseChange {
+        Cookie cookie;
+        bool isRemoval { false };
+    };
+
     CookieAcceptPolicy m_acceptPolicy { CookieAcceptPolicy::Always };
     String m_databasePath;
 
@@ -74,9 +86,24 @@ private:
 
     bool isOnMemory() const { return (m_databasePath == ":memory:"); };
 
+    bool deleteCookieInternal(const String& name, const String& domain, const String& path);
+    bool canAcceptCookie(const Cookie&, const URL& firstParty, const URL&, CookieJarDB::Source);
+    bool checkCookieAcceptPolicy(const URL& firstParty, const URL&);
+    bool hasCookies(const URL&);
+
+    void addDatabaseChange(DatabaseChange&&);
+    void scheduleDatabaseUpdate();
+    void updateDatabase();
+
+    // The functions below only run on the database queue.
     bool openDatabase();
     void closeDatabase();
 
+    Vector<Cookie> readCookies();
+    void writeChanges(bool clearCookies, const Vector<DatabaseChange>&);
+    bool setCookieInDatabase(const Cookie&);
+    bool deleteCookieFromDatabase(const String& name, const String& domain, const String& path);
+
     bool checkSQLiteReturnCode(int);
     void flagDatabaseCorruption();
     bool checkDatabaseCorruptionAndRemoveIfNeeded();
@@ -89,17 +116,17 @@ private:
     void deleteAllTables();
 
     void createPrepareStatement(const String&);
-    SQLiteStatement& preparedStatement(const String&);
+    SQLiteStatement* preparedStatement(const String&);
     bool executeSql(const String&);
 
-    bool deleteCookieInternal(const String& name, const String& domain, const String& path);
-    bool hasHttpOnlyCookie(const String& name, const String& domain, const String& path);
-    bool canAcceptCookie(const Cookie&, const URL& firstParty, const URL&, CookieJarDB::Source);
-    bool checkCookieAcceptPolicy(const URL& firstParty, const URL&);
-    bool hasCookies(const URL&);
-
     SQLiteDatabase m_database;
-    HashMap<String, std::unique_ptr<SQLiteStatement>> m_statements;
+
+    // Only used on the caller's thread.
+    CookieJarMemoryStore m_memoryStore;
+    bool m_isOpen { false };
+    Vector<DatabaseChange> m_pendingChanges;
+    bool m_pendingClear { false };
+    Timer m_databaseUpdateTimer;
 };
 
 } // namespace WebCore
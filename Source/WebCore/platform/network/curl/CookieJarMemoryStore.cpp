@@ -0,0 +1,100 @@
+#include "config.h"
+#include "CookieJarMemoryStore.h"
+
+#include "CookieUtil.h"
+#include "RegistrableDomain.h"
+#include <algorithm>
+#include <wtf/WallTime.h>
+
+namespace WebCore {
+
+String CookieJarMemoryStore::indexKey(const String& domain)
+{
+    // Curl marks cookies valid on subdomains with a leading '.'.
+    String host = domain.startsWith('.') ? domain.substring(1) : domain;
+    if (host.isEmpty() || CookieUtil::isIPAddress(host) || !host.contains('.'))
+        return host;
+
+    // Falls back to the host itself when it is a public suffix, or without a public suffix list.
+    return RegistrableDomain::uncheckedCreateFromHost(host).string();
+}
+
+static bool pathMatches(const String& cookiePath, const String& requestPath)
+{
+    // https://tools.ietf.org/html/rfc6265#section-5.1.4 "Paths and Path-Match"
+    return cookiePath == requestPath
+        || (requestPath.startsWith(cookiePath) && cookiePath.endsWith('/'))
+        || (requestPath.startsWith(cookiePath) && (requestPath.characterAt(cookiePath.length()) == '/'));
+}
+
+Vector<Cookie> CookieJarMemoryStore::search(const String& host, const String& path, const Optional<bool>& httpOnly, const Optional<bool>& secure, const Optional<bool>& session, size_t maximumCount) const
+{
+    Vector<Cookie> results;
+
+    auto iterator = m_cookiesByDomain.find(indexKey(host));
+    if (iterator == m_cookiesByDomain.end())
+        return results;
+
+    double now = WallTime::now().secondsSinceEpoch().seconds();
+    for (auto& cookie : iterator->value) {
+        if (!cookie.session && cookie.expires < now)
+            continue;
+        if ((httpOnly && cookie.httpOnly != *httpOnly) || (secure && cookie.secure != *secure) || (session && cookie.session != *session))
+            continue;
+        if (!CookieUtil::domainMatch(cookie.domain, host) || !pathMatches(cookie.path, path))
+            continue;
+        results.append(cookie);
+    }
+
+    std::stable_sort(results.begin(), results.end(), [](auto& a, auto& b) {
+        return a.path.length() > b.path.length();
+    });
+
+    if (results.size() > maximumCount)
+        results.shrink(maximumCount);
+
+    return results;
+}
+
+bool CookieJarMemoryStore::hasCookies(const String& host) const
+{
+    return m_cookiesByDomain.contains(indexKey(host));
+}
+
+bool CookieJarMemoryStore::hasHttpOnlyCookie(const String& name, const String& domain, const String& path) const
+{
+    auto iterator = m_cookiesByDomain.find(indexKey(domain));
+    if (iterator == m_cookiesByDomain.end())
+        return false;
+
+    return iterator->value.findMatching([&](auto& cookie) {
+        return cookie.httpOnly && cookie.name == name && cookie.domain == domain && cookie.path == path;
+    }) != notFound;
+}
+
+void CookieJarMemoryStore::set(Cookie&& cookie)
+{
+    auto& cookies = m_cookiesByDomain.add(indexKey(cookie.domain), Vector<Cookie> { }).iterator->value;
+    cookies.removeFirstMatching([&](auto& existingCookie) {
+        return existingCookie.isKeyEqual(cookie);
+    });
+    cookies.append(WTFMove(cookie));
+}
+
+bool CookieJarMemoryStore::remove(const String& name, const String& domain, const String& path)
+{
+    auto iterator = m_cookiesByDomain.find(indexKey(domain));
+    if (iterator == m_cookiesByDomain.end())
+        return false;
+
+    bool removed = iterator->value.removeAllMatching([&](auto& cookie) {
+        return cookie.name == name && cookie.domain == domain && (path.isEmpty() || cookie.path == path);
+    });
+
+    if (iterator->value.isEmpty())
+        m_cookiesByDomain.remove(iterator);
+
+    return removed;
+}
+
+} // namespace WebCore
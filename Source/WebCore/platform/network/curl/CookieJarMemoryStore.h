@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Cookie.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Optional.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// The cookies of a CookieJarDB, indexed by the registrable domain of their domain so a lookup
+// only looks at the cookies of one site. Cookies are kept the way CookieJarDB stores them, with
+// expires in seconds since the epoch.
+class CookieJarMemoryStore {
+    WTF_MAKE_NONCOPYABLE(CookieJarMemoryStore);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    CookieJarMemoryStore() = default;
+
+    // The unexpired cookies that match host and path, longest path first and then least
+    // recently set first, at most maximumCount of them.
+    Vector<Cookie> search(const String& host, const String& path, const Optional<bool>& httpOnly, const Optional<bool>& secure, const Optional<bool>& session, size_t maximumCount) const;
+
+    // Whether any cookie is set for the site host belongs to.
+    bool hasCookies(const String& host) const;
+    bool hasHttpOnlyCookie(const String& name, const String& domain, const String& path) const;
+
+    // Adds the cookie, replacing the one with the same name, domain and path.
+    void set(Cookie&&);
+
+    // Removes the cookies with this name and domain, with any path if path is empty.
+    bool remove(const String& name, const String& domain, const String& path);
+
+    void clear() { m_cookiesByDomain.clear(); }
+
+private:
+    static String indexKey(const String& domain);
+
+    // Each list is in the order its cookies were set.
+    HashMap<String, Vector<Cookie>> m_cookiesByDomain;
+};
+
+} // namespace WebCore
@@ -32,6 +32,7 @@
 #include "CurlRequestScheduler.h"
 #include "CurlSSLHandle.h"
 #include "CurlSSLVerifier.h"
+#include "CurlStreamScheduler.h"
 #include "HTTPHeaderMap.h"
 #include <NetworkLoadMetrics.h>
 #include <mutex>
@@ -116,6 +117,7 @@ CurlContext::CurlContext()
         maxHostConnections = *value;
 
     m_scheduler = std::make_unique<CurlRequestScheduler>(maxConnects, maxTotalConnections, maxHostConnections);
+    m_streamScheduler = std::make_unique<CurlStreamScheduler>();
 
 #ifndef NDEBUG
     m_verbose = envVar.defined("DEBUG_CURL");
@@ -626,6 +628,15 @@ void CurlHandle::setWriteCallbackFunction(curl_write_callback callbackFunc, void
     curl_easy_setopt(m_handle, CURLOPT_WRITEDATA, userData);
 }
 
+void CurlHandle::setUploadBufferSize(long size)
+{
+#if LIBCURL_VERSION_NUM >= 0x073e00
+    curl_easy_setopt(m_handle, CURLOPT_UPLOAD_BUFFERSIZE, size);
+#else
+    UNUSED_PARAM(size);
+#endif
+}
+
 void CurlHandle::setReadCallbackFunction(curl_read_callback callbackFunc, void* userData)
 {
     curl_easy_setopt(m_handle, CURLOPT_READFUNCTION, callbackFunc);
@@ -902,15 +913,19 @@ CurlSocketHandle::CurlSocketHandle(const URL& url, Function<void(CURLcode)>&& er
     enableConnectionOnly();
 }
 
-bool CurlSocketHandle::connect()
+Optional<curl_socket_t> CurlSocketHandle::activeSocket()
 {
-    CURLcode errorCode = perform();
+    curl_socket_t socket;
+    CURLcode errorCode = curl_easy_getinfo(handle(), CURLINFO_ACTIVESOCKET, &socket);
+    if (errorCode == CURLE_OK && socket == CURL_SOCKET_BAD)
+        errorCode = CURLE_COULDNT_CONNECT;
+
     if (errorCode != CURLE_OK) {
         m_errorHandler(errorCode);
-        return false;
+        return WTF::nullopt;
     }
 
-    return true;
+    return socket;
 }
 
 size_t CurlSocketHandle::send(const uint8_t* buffer, size_t size)
@@ -947,56 +962,6 @@ Optional<size_t> CurlSocketHandle::receive(uint8_t* buffer, size_t bufferSize)
     return bytesRead;
 }
 
-Optional<CurlSocketHandle::WaitResult> CurlSocketHandle::wait(const Seconds& timeout, bool alsoWaitForWrite)
-{
-    curl_socket_t socket;
-    CURLcode errorCode = curl_easy_getinfo(handle(), CURLINFO_ACTIVESOCKET, &socket);
-    if (errorCode != CURLE_OK) {
-        m_errorHandler(errorCode);
-        return WTF::nullopt;
-    }
-
-    int64_t usec = timeout.microsecondsAs<int64_t>();
-
-    struct timeval selectTimeout;
-    if (usec <= 0) {
-        selectTimeout.tv_sec = 0;
-        selectTimeout.tv_usec = 0;
-    } else {
-        selectTimeout.tv_sec = usec / 1000000;
-        selectTimeout.tv_usec = usec % 1000000;
-    }
-
-    int rc = 0;
-    int maxfd = static_cast<int>(socket) + 1;
-    fd_set fdread;
-    fd_set fdwrite;
-    fd_set fderr;
-
-    // Retry 'select' if it was interrupted by a process signal.
-    do {
-        FD_ZERO(&fdread);
-        FD_SET(socket, &fdread);
-
-        FD_ZERO(&fdwrite);
-        if (alsoWaitForWrite)
-            FD_SET(socket, &fdwrite);
-
-        FD_ZERO(&fderr);
-        FD_SET(socket, &fderr);
-
-        rc = ::select(maxfd, &fdread, &fdwrite, &fderr, &selectTimeout);
-    } while (rc == -1 && errno == EINTR);
-
-    if (rc <= 0)
-        return WTF::nullopt;
-
-    WaitResult result;
-    result.readable = FD_ISSET(socket, &fdread) || FD_ISSET(socket, &fderr);
-    result.writable = FD_ISSET(socket, &fdwrite);
-    return result;
-}
-
 }
 
 #endif
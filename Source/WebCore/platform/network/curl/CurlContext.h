@@ -89,6 +89,7 @@ private:
 // CurlContext --------------------------------------------
 
 class CurlRequestScheduler;
+class CurlStreamScheduler;
 
 class CurlContext : public CurlGlobal {
     WTF_MAKE_NONCOPYABLE(CurlContext);
@@ -101,6 +102,7 @@ public:
     const CurlShareHandle& shareHandle() { return m_shareHandle; }
 
     CurlRequestScheduler& scheduler() { return *m_scheduler; }
+    CurlStreamScheduler& streamScheduler() { return *m_streamScheduler; }
 
     // Proxy
     const CurlProxySettings& proxySettings() const { return m_proxySettings; }
@@ -133,6 +135,7 @@ private:
     CurlShareHandle m_shareHandle;
     CurlSSLHandle m_sslHandle;
     std::unique_ptr<CurlRequestScheduler> m_scheduler;
+    std::unique_ptr<CurlStreamScheduler> m_streamScheduler;
 
     Seconds m_dnsCacheTimeout { Seconds::fromMinutes(5) };
     Seconds m_connectTimeout { 30.0 };
@@ -272,6 +275,7 @@ public:
     void setHeaderCallbackFunction(curl_write_callback, void*);
     void setWriteCallbackFunction(curl_write_callback, void*);
     void setReadCallbackFunction(curl_read_callback, void*);
+    void setUploadBufferSize(long);
     void setSslCtxCallbackFunction(curl_ssl_ctx_callback, void*);
     void setDebugCallbackFunction(curl_debug_callback, void*);
 
@@ -315,17 +319,13 @@ class CurlSocketHandle : public CurlHandle {
     WTF_MAKE_NONCOPYABLE(CurlSocketHandle);
 
 public:
-    struct WaitResult {
-        bool readable { false };
-        bool writable { false };
-    };
-
     CurlSocketHandle(const URL&, Function<void(CURLcode)>&& errorHandler);
 
-    bool connect();
+    // Call once the connection has been established through a CurlMultiHandle.
+    Optional<curl_socket_t> activeSocket();
+
     size_t send(const uint8_t*, size_t);
     Optional<size_t> receive(uint8_t*, size_t);
-    Optional<WaitResult> wait(const Seconds& timeout, bool alsoWaitForWrite);
 
 private:
     Function<void(CURLcode)> m_errorHandler;
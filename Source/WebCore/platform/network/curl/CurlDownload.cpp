@@ -130,20 +130,15 @@ void CurlDownload::curlDidFailWithError(CurlRequest& request, ResourceError&&, C
         m_listener->didFail();
 }
 
-void CurlDownload::curlConsumeReceiveQueue(CurlRequest&, WTF::ReaderWriterQueue<RefPtr<SharedBuffer>>& queue)
+void CurlDownload::curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&& buffer)
 {
     ASSERT(isMainThread());
 
     if (m_isCancelled)
         return;
 
-    if (m_listener) {
-        RefPtr<SharedBuffer> buffer;
-        while (queue.try_dequeue(buffer)) {
-            if (buffer->size())
-                m_listener->didReceiveDataOfLength(buffer->size());
-        }
-    }
+    if (m_listener)
+        m_listener->didReceiveDataOfLength(buffer->size());
 }
 
 bool CurlDownload::shouldRedirectAsGET(const ResourceRequest& request, bool crossOrigin)
@@ -79,7 +79,7 @@ private:
     void curlDidComplete(CurlRequest&, NetworkLoadMetrics&&) override;
     void curlDidFailWithError(CurlRequest&, ResourceError&&, CertificateInfo&&) override;
 
-    void curlConsumeReceiveQueue(CurlRequest&, WTF::ReaderWriterQueue<RefPtr<SharedBuffer>>& queue) override final;
+    void curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&&) override final;
 
     bool shouldRedirectAsGET(const ResourceRequest&, bool crossOrigin);
     void willSendRequest();
@@ -34,6 +34,7 @@
 
 #if USE(CURL)
 
+#include "BlobData.h"
 #include "BlobRegistry.h"
 #include "CurlContext.h"
 #include "Logging.h"
@@ -64,10 +65,7 @@ void CurlFormDataStream::clean()
     if (m_postData)
         m_postData = nullptr;
 
-    if (m_fileHandle != FileSystem::invalidPlatformFileHandle) {
-        FileSystem::closeFile(m_fileHandle);
-        m_fileHandle = FileSystem::invalidPlatformFileHandle;
-    }
+    closeFile();
 }
 
 const Vector<char>* CurlFormDataStream::getPostData()
@@ -75,6 +73,11 @@ const Vector<char>* CurlFormDataStream::getPostData()
     if (!m_formData)
         return nullptr;
 
+    // A body made of a single run of bytes is handed to curl as it is, without copying it.
+    // A single file has nothing to flatten and has to be streamed.
+    if (m_formData->elements().size() == 1)
+        return WTF::get_if<Vector<char>>(m_formData->elements().first().data);
+
     if (!m_postData)
         m_postData = std::make_unique<Vector<char>>(m_formData->flatten());
 
@@ -145,28 +148,87 @@ Optional<size_t> CurlFormDataStream::read(char* buffer, size_t size)
     return totalReadBytes;
 }
 
-Optional<size_t> CurlFormDataStream::readFromFile(const FormDataElement::EncodedFileData& fileData, char* buffer, size_t size)
+bool CurlFormDataStream::openFile(const FormDataElement::EncodedFileData& fileData)
 {
-    if (m_fileHandle == FileSystem::invalidPlatformFileHandle)
-        m_fileHandle = FileSystem::openFile(fileData.filename, FileSystem::FileOpenMode::Read);
+    ASSERT(!m_isReadingFile);
 
-    if (!FileSystem::isHandleValid(m_fileHandle)) {
-        LOG(Network, "Curl - Failed while trying to open %s for upload\n", fileData.filename.utf8().data());
-        m_fileHandle = FileSystem::invalidPlatformFileHandle;
-        return WTF::nullopt;
+    const auto& path = fileData.shouldGenerateFile ? fileData.generatedFilename : fileData.filename;
+
+    long long fileSize;
+    if (!FileSystem::getFileSize(path, fileSize)) {
+        LOG(Network, "Curl - Failed while trying to open %s for upload\n", path.utf8().data());
+        return false;
+    }
+
+    // Blob slices only send their range of the file.
+    unsigned long long start = std::min<unsigned long long>(std::max<long long>(fileData.fileStart, 0), fileSize);
+    unsigned long long length = fileSize - start;
+    if (fileData.fileLength != BlobDataItem::toEndOfFile)
+        length = std::min<unsigned long long>(std::max<long long>(fileData.fileLength, 0), length);
+
+    m_isReadingFile = true;
+    m_fileBytesRemaining = length;
+    if (!length)
+        return true;
+
+    // A mapped file is copied straight into curl's buffer, without a read call for every chunk.
+    bool mappingSucceeded = false;
+    FileSystem::MappedFileData mappedFile(path, mappingSucceeded);
+    if (mappingSucceeded && mappedFile && mappedFile.size() >= start + length) {
+        m_mappedFile = WTFMove(mappedFile);
+        m_dataOffset = start;
+        return true;
     }
 
-    auto readBytes = FileSystem::readFromFile(m_fileHandle, buffer, size);
-    if (readBytes < 0) {
-        LOG(Network, "Curl - Failed while trying to read %s for upload\n", fileData.filename.utf8().data());
+    // Files too large to map, or on file systems that can't be mapped, are read instead.
+    m_fileHandle = FileSystem::openFile(path, FileSystem::FileOpenMode::Read);
+    if (!FileSystem::isHandleValid(m_fileHandle) || (start && FileSystem::seekFile(m_fileHandle, start, FileSystem::FileSeekOrigin::Beginning) < 0)) {
+        LOG(Network, "Curl - Failed while trying to open %s for upload\n", path.utf8().data());
+        closeFile();
+        return false;
+    }
+
+    return true;
+}
+
+void CurlFormDataStream::closeFile()
+{
+    if (m_fileHandle != FileSystem::invalidPlatformFileHandle) {
         FileSystem::closeFile(m_fileHandle);
         m_fileHandle = FileSystem::invalidPlatformFileHandle;
+    }
+
+    m_mappedFile = { };
+    m_fileBytesRemaining = 0;
+    m_isReadingFile = false;
+}
+
+Optional<size_t> CurlFormDataStream::readFromFile(const FormDataElement::EncodedFileData& fileData, char* buffer, size_t size)
+{
+    if (!m_isReadingFile && !openFile(fileData))
         return WTF::nullopt;
+
+    size_t readBytes = static_cast<size_t>(std::min<unsigned long long>(size, m_fileBytesRemaining));
+    if (m_mappedFile) {
+        memcpy(buffer, static_cast<const char*>(m_mappedFile.data()) + m_dataOffset, readBytes);
+        m_dataOffset += readBytes;
+        m_fileBytesRemaining -= readBytes;
+    } else if (readBytes) {
+        auto result = FileSystem::readFromFile(m_fileHandle, buffer, readBytes);
+        if (result < 0) {
+            LOG(Network, "Curl - Failed while trying to read %s for upload\n", fileData.filename.utf8().data());
+            closeFile();
+            return WTF::nullopt;
+        }
+
+        readBytes = result;
+        // The file got shorter since its size was taken, there is nothing more to send.
+        m_fileBytesRemaining = result ? m_fileBytesRemaining - result : 0;
     }
 
-    if (!readBytes) {
-        FileSystem::closeFile(m_fileHandle);
-        m_fileHandle = FileSystem::invalidPlatformFileHandle;
+    if (!m_fileBytesRemaining) {
+        closeFile();
+        m_dataOffset = 0;
         m_elementPosition++;
     }
 
@@ -54,6 +54,9 @@ private:
     Optional<size_t> readFromFile(const FormDataElement::EncodedFileData&, char*, size_t);
     Optional<size_t> readFromData(const Vector<char>&, char*, size_t);
 
+    bool openFile(const FormDataElement::EncodedFileData&);
+    void closeFile();
+
     RefPtr<FormData> m_formData;
 
     std::unique_ptr<Vector<char>> m_postData;
@@ -64,7 +67,14 @@ private:
 
     size_t m_elementPosition { 0 };
 
+    // The file element being read. Its range is copied straight out of m_mappedFile when the
+    // file could be mapped, and read through m_fileHandle otherwise.
+    bool m_isReadingFile { false };
+    FileSystem::MappedFileData m_mappedFile;
     FileSystem::PlatformFileHandle m_fileHandle { FileSystem::invalidPlatformFileHandle };
+    unsigned long long m_fileBytesRemaining { 0 };
+
+    // Offset into the current data element, or into m_mappedFile.
     size_t m_dataOffset { 0 };
 };
 
@@ -43,7 +43,7 @@ public:
     CurlMultipartHandle(CurlMultipartHandleClient&, const String&);
     ~CurlMultipartHandle() { }
 
-    void didReceiveData(const SharedBuffer&);
+    void didReceiveData(const char*, size_t);
     void didComplete();
 
 private:
@@ -40,6 +40,14 @@
 
 namespace WebCore {
 
+// curl asks for an upload one buffer at a time, 64 KB by default. Larger requests mean fewer read
+// callbacks for big bodies. curl caps the buffer at 2 MB.
+static const long uploadBufferSize = 512 * KB;
+
+// Received data is packed into segments of this size, so a large body reaches the client in a
+// handful of segments instead of one per write callback.
+static const size_t receiveSegmentSize = 64 * KB;
+
 CurlRequest::CurlRequest(const ResourceRequest&request, CurlRequestClient* client, ShouldSuspend shouldSuspend, EnableMultipart enableMultipart, CaptureNetworkLoadMetrics captureExtraMetrics, MessageQueue<Function<void()>>* messageQueue)
     : m_client(client)
     , m_messageQueue(messageQueue)
@@ -372,7 +380,7 @@ size_t CurlRequest::didReceiveHeader(String&& header)
 
 // called with data after all headers have been processed via headerCallback
 
-size_t CurlRequest::didReceiveData(Ref<SharedBuffer>&& buffer)
+size_t CurlRequest::didReceiveData(const char* data, size_t receiveBytes)
 {
     ASSERT(!isMainThread());
 
@@ -389,25 +397,15 @@ size_t CurlRequest::didReceiveData(Ref<SharedBuffer>&& buffer)
         return CURL_WRITEFUNC_PAUSE;
     }
 
-    auto receiveBytes = buffer->size();
     m_totalReceivedSize += receiveBytes;
 
-    writeDataToDownloadFileIfEnabled(buffer);
+    writeDataToDownloadFileIfEnabled(data, receiveBytes);
 
     if (receiveBytes) {
-        if (m_multipartHandle) {
-
-            m_multipartHandle->didReceiveData(buffer);
-        } else {
-            m_receiveBufferQueue.enqueue(std::move(buffer));
-            if (!m_pendingConsumeRequest) {
-                m_pendingConsumeRequest.store(true);
-                callClient([&](CurlRequest& request, CurlRequestClient& client) mutable {
-                    m_pendingConsumeRequest.store(false);
-                    client.curlConsumeReceiveQueue(request, m_receiveBufferQueue);
-                });
-            }
-        }
+        if (m_multipartHandle)
+            m_multipartHandle->didReceiveData(data, receiveBytes);
+        else
+            appendReceivedData(data, receiveBytes);
     }
 
     return receiveBytes;
@@ -435,18 +433,58 @@ void CurlRequest::didReceiveDataFromMultipart(Ref<SharedBuffer>&& buffer)
     if (isCompletedOrCancelled())
         return;
 
-    auto receiveBytes = buffer->size();
+    if (buffer->size())
+        appendReceivedData(buffer->data(), buffer->size());
+}
 
-    if (receiveBytes) {
-        m_receiveBufferQueue.enqueue(std::move(buffer));
-        if (!m_pendingConsumeRequest) {
-            m_pendingConsumeRequest.store(true);
-            callClient([=](CurlRequest& request, CurlRequestClient& client) mutable {
-                m_pendingConsumeRequest.store(false);
-                client.curlConsumeReceiveQueue(request, m_receiveBufferQueue);
-            });
+void CurlRequest::appendReceivedData(const char* data, size_t size)
+{
+    ASSERT(!isMainThread());
+
+    {
+        LockHolder locker(m_receivedDataLock);
+
+        if (m_receivedSegments.isEmpty() || m_receivedSegments.last().size() + size > m_receivedSegments.last().capacity()) {
+            Vector<char> segment;
+            segment.reserveInitialCapacity(std::max(size, receiveSegmentSize));
+            m_receivedSegments.append(WTFMove(segment));
         }
+
+        m_receivedSegments.last().append(data, size);
+    }
+
+    // One pending request takes everything appended before it runs.
+    if (m_pendingConsumeRequest.exchange(true))
+        return;
+
+    callClient([](CurlRequest& request, CurlRequestClient& client) {
+        request.m_pendingConsumeRequest.store(false);
+        if (auto buffer = request.takeReceivedData())
+            client.curlDidReceiveBuffer(request, buffer.releaseNonNull());
+    });
+}
+
+RefPtr<SharedBuffer> CurlRequest::takeReceivedData()
+{
+    Vector<Vector<char>> segments;
+    {
+        LockHolder locker(m_receivedDataLock);
+        segments = WTFMove(m_receivedSegments);
+    }
+
+    if (segments.isEmpty())
+        return nullptr;
+
+    auto buffer = SharedBuffer::create();
+    for (auto& segment : segments) {
+        // The buffer may be kept as long as the resource is, so don't keep a mostly empty
+        // segment's capacity alive with it.
+        if (segment.size() <= segment.capacity() / 2)
+            segment.shrinkToFit();
+        buffer->append(WTFMove(segment));
     }
+
+    return buffer;
 }
 
 void CurlRequest::didCompleteTransfer(CURLcode result)
@@ -573,11 +611,14 @@ void CurlRequest::setupPOST(ResourceRequest& request)
 
     // Do not stream for simple POST data
     if (elementSize == 1) {
-        const auto* postData = m_formDataStream.getPostData();
-        if (postData && postData->size())
-            m_curlHandle->setPostFields(postData->data(), postData->size());
-    } else
-        setupSendData(false);
+        if (const auto* postData = m_formDataStream.getPostData()) {
+            if (postData->size())
+                m_curlHandle->setPostFields(postData->data(), postData->size());
+            return;
+        }
+    }
+
+    setupSendData(false);
 }
 
 void CurlRequest::setupSendData(bool forPutMethod)
@@ -593,6 +634,7 @@ void CurlRequest::setupSendData(bool forPutMethod)
     }
 
     m_curlHandle->setReadCallbackFunction(willSendDataCallback, this);
+    m_curlHandle->setUploadBufferSize(uploadBufferSize);
 }
 
 void CurlRequest::invokeDidReceiveResponseForFile(URL& url)
@@ -766,7 +808,7 @@ const String& CurlRequest::getDownloadedFilePath()
     return m_downloadFilePath;
 }
 
-void CurlRequest::writeDataToDownloadFileIfEnabled(const SharedBuffer& buffer)
+void CurlRequest::writeDataToDownloadFileIfEnabled(const char* data, size_t size)
 {
     {
         LockHolder locker(m_downloadMutex);
@@ -779,7 +821,7 @@ void CurlRequest::writeDataToDownloadFileIfEnabled(const SharedBuffer& buffer)
     }
 
     if (m_downloadFileHandle != FileSystem::invalidPlatformFileHandle)
-        FileSystem::writeToFile(m_downloadFileHandle, buffer.data(), buffer.size());
+        FileSystem::writeToFile(m_downloadFileHandle, data, size);
 }
 
 void CurlRequest::closeDownloadFile()
@@ -815,7 +857,7 @@ size_t CurlRequest::didReceiveHeaderCallback(char* ptr, size_t blockSize, size_t
 
 size_t CurlRequest::didReceiveDataCallback(char* ptr, size_t blockSize, size_t numberOfBlocks, void* userData)
 {
-    return static_cast<CurlRequest*>(userData)->didReceiveData(SharedBuffer::create(ptr, blockSize * numberOfBlocks));
+    return static_cast<CurlRequest*>(userData)->didReceiveData(ptr, blockSize * numberOfBlocks);
 }
 
 int CurlRequest::didReceiveDebugInfoCallback(CURL*, curl_infotype type, char* data, size_t size, void* userData)
@@ -37,7 +37,6 @@
 #include <wtf/MonotonicTime.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/Lock.h>
-#include <wtf/lockfree/ReaderWriterQueue.h>
 
 namespace WebCore {
 
@@ -124,7 +123,7 @@ private:
     CURL* setupTransfer() override;
     size_t willSendData(char*, size_t, size_t);
     size_t didReceiveHeader(String&&);
-    size_t didReceiveData(Ref<SharedBuffer>&&);
+    size_t didReceiveData(const char*, size_t);
     void didReceiveHeaderFromMultipart(const Vector<String>&) override;
     void didReceiveDataFromMultipart(Ref<SharedBuffer>&&) override;
     void didCompleteTransfer(CURLcode) override;
@@ -134,6 +133,10 @@ private:
 
     int didReceiveDebugInfo(curl_infotype, char*, size_t);
 
+    // Response body handoff to the client
+    void appendReceivedData(const char*, size_t);
+    RefPtr<SharedBuffer> takeReceivedData();
+
     // For setup 
     void appendAcceptLanguageHeader(HTTPHeaderMap&);
     void setupPOST(ResourceRequest&);
@@ -155,7 +158,7 @@ private:
     NetworkLoadMetrics networkLoadMetrics();
 
     // Download
-    void writeDataToDownloadFileIfEnabled(const SharedBuffer&);
+    void writeDataToDownloadFileIfEnabled(const char*, size_t);
     void closeDownloadFile();
     void cleanupDownloadFile();
 
@@ -216,7 +219,11 @@ private:
     MonotonicTime m_performStartTime;
     size_t m_totalReceivedSize { 0 };
 
-    WTF::ReaderWriterQueue<RefPtr<SharedBuffer>> m_receiveBufferQueue;
+    // Body data the client hasn't taken yet. libcurl hands over the decoded body a few KB at a
+    // time; the worker thread packs it into large segments that become the client's SharedBuffer
+    // without another copy.
+    Lock m_receivedDataLock;
+    Vector<Vector<char>> m_receivedSegments;
     std::atomic<bool> m_pendingConsumeRequest = false;
 };
 
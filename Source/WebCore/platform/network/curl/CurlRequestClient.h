@@ -27,7 +27,6 @@
 #pragma once
 
 #include <wtf/Ref.h>
-#include <wtf/lockfree/ReaderWriterQueue.h>
 
 namespace WebCore {
 
@@ -48,7 +47,8 @@ public:
     virtual void curlDidComplete(CurlRequest&, NetworkLoadMetrics&&) = 0;
     virtual void curlDidFailWithError(CurlRequest&, ResourceError&&, CertificateInfo&&) = 0;
 
-    virtual void curlConsumeReceiveQueue(CurlRequest&, WTF::ReaderWriterQueue<RefPtr<SharedBuffer>>& queue) = 0;
+    // Called on the main thread with all the body data received since the last call.
+    virtual void curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&&) = 0;
 };
 
 } // namespace WebCore
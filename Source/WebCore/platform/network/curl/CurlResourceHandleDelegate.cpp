@@ -166,23 +166,20 @@ void CurlResourceHandleDelegate::curlDidFailWithError(CurlRequest&, ResourceErro
     client()->didFail(&m_handle, resourceError);
 }
 
-void CurlResourceHandleDelegate::curlConsumeReceiveQueue(CurlRequest&, WTF::ReaderWriterQueue<RefPtr<SharedBuffer>>& queue)
+void CurlResourceHandleDelegate::curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&& buffer)
 {
     ASSERT(isMainThread());
 
     if (cancelledOrClientless())
         return;
 
-    Ref<SharedBuffer> buffer = SharedBuffer::create();
-    RefPtr<SharedBuffer> tempBuffer;
-    while (queue.try_dequeue(tempBuffer)) {
-        buffer->append(*tempBuffer);
-    }
+    // Hand the segments over as they are; calling data() here would copy the whole batch into
+    // one segment on the main thread.
+    for (auto& entry : buffer.get())
+        CurlCacheManager::singleton().didReceiveData(m_handle, entry.segment->data(), entry.segment->size());
 
-    if (buffer->size()) {
-        CurlCacheManager::singleton().didReceiveData(m_handle, buffer->data(), buffer->size());
-        client()->didReceiveBuffer(&m_handle, WTFMove(buffer), buffer->size());
-    }
+    auto size = buffer->size();
+    client()->didReceiveBuffer(&m_handle, WTFMove(buffer), size);
 }
 
 } // namespace WebCore
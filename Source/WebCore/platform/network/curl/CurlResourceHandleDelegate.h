@@ -58,7 +58,7 @@ public:
     void curlDidComplete(CurlRequest&, NetworkLoadMetrics&&) override final;
     void curlDidFailWithError(CurlRequest&, ResourceError&&, CertificateInfo&&) override final;
 
-    void curlConsumeReceiveQueue(CurlRequest&, WTF::ReaderWriterQueue<RefPtr<SharedBuffer>>& queue) override final;
+    void curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&&) override final;
 
 private:
     ResourceHandle& m_handle;
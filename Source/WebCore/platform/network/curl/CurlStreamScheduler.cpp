@@ -0,0 +1,466 @@
+#include "config.h"
+#include "CurlStreamScheduler.h"
+
+#if USE(CURL)
+
+#include <wtf/MainThread.h>
+#include <wtf/Seconds.h>
+
+#if OS(WINDOWS)
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace WebCore {
+
+static const size_t readBufferSize = 16 * 1024;
+// Cap on what one stream may read per iteration, so a busy stream can't starve the others.
+static const size_t maxReceiveSizePerIteration = 256 * 1024;
+// Curl has to be polled while connections are being established.
+static const int connectingPollIntervalMS = 5;
+// Fallback when the wake-up socket couldn't be created.
+static const int taskPollIntervalMS = 20;
+
+struct CurlStreamScheduler::Stream {
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    Stream(StreamID streamID)
+        : streamID(streamID)
+    {
+    }
+
+    StreamID streamID;
+    std::unique_ptr<CurlSocketHandle> handle;
+    curl_socket_t socket { CURL_SOCKET_BAD };
+    bool isFinished { false };
+
+    UniqueArray<uint8_t> writeBuffer;
+    size_t writeBufferSize { 0 };
+    size_t writeBufferOffset { 0 };
+};
+
+static void closeSocket(curl_socket_t socket)
+{
+#if OS(WINDOWS)
+    ::closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+// A loopback datagram socket connected to itself. It sits in the worker's read set,
+// so the main thread can interrupt select() by sending it a byte.
+static curl_socket_t createWakeUpSocket()
+{
+    curl_socket_t wakeUpSocket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (wakeUpSocket == CURL_SOCKET_BAD)
+        return CURL_SOCKET_BAD;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+
+    if (::bind(wakeUpSocket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))
+        || ::getsockname(wakeUpSocket, reinterpret_cast<struct sockaddr*>(&address), &addressLength)
+        || ::connect(wakeUpSocket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))) {
+        closeSocket(wakeUpSocket);
+        return CURL_SOCKET_BAD;
+    }
+
+    return wakeUpSocket;
+}
+
+CurlStreamScheduler::CurlStreamScheduler()
+    : m_wakeUpSocket(createWakeUpSocket())
+{
+}
+
+CurlStreamScheduler::~CurlStreamScheduler()
+{
+    stopThread();
+
+    if (m_wakeUpSocket != CURL_SOCKET_BAD)
+        closeSocket(m_wakeUpSocket);
+}
+
+CurlStreamScheduler::StreamID CurlStreamScheduler::open(const URL& url, Client& client)
+{
+    ASSERT(isMainThread());
+
+    auto streamID = m_nextStreamID++;
+    m_clients.add(streamID, &client);
+
+    callOnWorkerThread([this, streamID, url = url.isolatedCopy()] {
+        connectStream(streamID, url);
+    });
+
+    return streamID;
+}
+
+void CurlStreamScheduler::close(StreamID streamID)
+{
+    ASSERT(isMainThread());
+
+    if (!m_clients.remove(streamID))
+        return;
+
+    callOnWorkerThread([this, streamID] {
+        destroyStream(streamID);
+    });
+}
+
+void CurlStreamScheduler::send(StreamID streamID, UniqueArray<uint8_t>&& data, size_t size)
+{
+    ASSERT(isMainThread());
+
+    callOnWorkerThread([this, streamID, data = WTFMove(data), size]() mutable {
+        auto* stream = m_streams.get(streamID);
+        if (!stream)
+            return;
+
+        ASSERT(!stream->writeBuffer);
+        stream->writeBuffer = WTFMove(data);
+        stream->writeBufferSize = size;
+        stream->writeBufferOffset = 0;
+    });
+}
+
+void CurlStreamScheduler::callOnWorkerThread(Function<void()>&& task)
+{
+    ASSERT(isMainThread());
+
+    bool shouldWakeUp = false;
+    {
+        auto locker = holdLock(m_mutex);
+        m_taskQueue.append(WTFMove(task));
+        shouldWakeUp = !std::exchange(m_wakeUpPending, true);
+    }
+
+    startThreadIfNeeded();
+
+    if (shouldWakeUp && m_wakeUpSocket != CURL_SOCKET_BAD) {
+        char byte = 0;
+        ::send(m_wakeUpSocket, &byte, 1, 0);
+    }
+}
+
+void CurlStreamScheduler::callClientOnMainThread(StreamID streamID, Function<void(Client&)>&& task)
+{
+    ASSERT(!isMainThread());
+
+    // Collected for the whole iteration and delivered in one main thread dispatch.
+    m_mainThreadCallbacks.append([this, streamID, task = WTFMove(task)] {
+        if (auto* client = m_clients.get(streamID))
+            task(*client);
+    });
+}
+
+void CurlStreamScheduler::startThreadIfNeeded()
+{
+    ASSERT(isMainThread());
+
+    {
+        auto locker = holdLock(m_mutex);
+        if (m_runThread)
+            return;
+    }
+
+    if (m_thread)
+        m_thread->waitForCompletion();
+
+    {
+        auto locker = holdLock(m_mutex);
+        m_runThread = true;
+    }
+
+    m_thread = Thread::create("WebSocket thread", [this] {
+        workerThread();
+    });
+}
+
+void CurlStreamScheduler::stopThread()
+{
+    {
+        auto locker = holdLock(m_mutex);
+        m_runThread = false;
+    }
+
+    if (m_wakeUpSocket != CURL_SOCKET_BAD) {
+        char byte = 0;
+        ::send(m_wakeUpSocket, &byte, 1, 0);
+    }
+
+    if (m_thread) {
+        m_thread->waitForCompletion();
+        m_thread = nullptr;
+    }
+}
+
+void CurlStreamScheduler::executeTasks()
+{
+    ASSERT(!isMainThread());
+
+    Vector<Function<void()>> taskQueue;
+
+    {
+        auto locker = holdLock(m_mutex);
+        taskQueue = WTFMove(m_taskQueue);
+    }
+
+    for (auto& task : taskQueue)
+        task();
+}
+
+void CurlStreamScheduler::drainWakeUpSocket()
+{
+    char buffer[16];
+    ::recv(m_wakeUpSocket, buffer, sizeof(buffer), 0);
+
+    auto locker = holdLock(m_mutex);
+    m_wakeUpPending = false;
+}
+
+void CurlStreamScheduler::workerThread()
+{
+    ASSERT(!isMainThread());
+
+    m_curlMultiHandle = std::make_unique<CurlMultiHandle>();
+    m_readBuffer = makeUniqueArray<uint8_t>(readBufferSize);
+
+    while (true) {
+        executeTasks();
+
+        {
+            auto locker = holdLock(m_mutex);
+            if (m_streams.isEmpty() && m_taskQueue.isEmpty())
+                m_runThread = false;
+            if (!m_runThread)
+                break;
+        }
+
+        fd_set readfds;
+        fd_set writefds;
+        fd_set exceptfds;
+        int maxfd = -1;
+
+        // Retry 'select' if it was interrupted by a process signal.
+        int rc = 0;
+        do {
+            m_curlMultiHandle->getFdSet(readfds, writefds, exceptfds, maxfd);
+
+            auto addSocket = [&](curl_socket_t socket, bool alsoWaitForWrite) {
+                FD_SET(socket, &readfds);
+                FD_SET(socket, &exceptfds);
+                if (alsoWaitForWrite)
+                    FD_SET(socket, &writefds);
+                maxfd = std::max(maxfd, static_cast<int>(socket));
+            };
+
+            if (m_wakeUpSocket != CURL_SOCKET_BAD)
+                addSocket(m_wakeUpSocket, false);
+            for (auto& stream : m_streams.values()) {
+                if (stream->socket != CURL_SOCKET_BAD && !stream->isFinished)
+                    addSocket(stream->socket, !!stream->writeBuffer);
+            }
+
+            struct timeval timeout;
+            timeout.tv_sec = 0;
+            timeout.tv_usec = 0;
+            bool shouldPoll = true;
+            if (!m_connectingStreams.isEmpty())
+                timeout.tv_usec = connectingPollIntervalMS * 1000;
+            else if (m_wakeUpSocket == CURL_SOCKET_BAD)
+                timeout.tv_usec = taskPollIntervalMS * 1000;
+            else
+                shouldPoll = false;
+
+            // When the 3 file descriptors are empty, winsock will return -1
+            // and bail out. So make sure we have valid file descriptors before calling select.
+            if (maxfd >= 0)
+                rc = ::select(maxfd + 1, &readfds, &writefds, &exceptfds, shouldPoll ? &timeout : nullptr);
+            else {
+                // Nothing to wait on, which means there is no wake-up socket either. Sleep
+                // for the poll interval rather than spinning.
+                WTF::sleep(Seconds::fromMicroseconds(timeout.tv_usec));
+            }
+        } while (rc == -1 && errno == EINTR);
+
+        if (rc <= 0) {
+            FD_ZERO(&readfds);
+            FD_ZERO(&writefds);
+            FD_ZERO(&exceptfds);
+        }
+
+        if (m_wakeUpSocket != CURL_SOCKET_BAD && FD_ISSET(m_wakeUpSocket, &readfds))
+            drainWakeUpSocket();
+
+        if (!m_connectingStreams.isEmpty()) {
+            int activeCount = 0;
+            while (m_curlMultiHandle->perform(activeCount) == CURLM_CALL_MULTI_PERFORM) { }
+
+            while (true) {
+                int messagesInQueue = 0;
+                CURLMsg* msg = m_curlMultiHandle->readInfo(messagesInQueue);
+                if (!msg)
+                    break;
+
+                if (msg->msg == CURLMSG_DONE)
+                    completeConnection(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        for (auto& stream : m_streams.values())
+            transfer(*stream, readfds, writefds, exceptfds);
+
+        if (!m_mainThreadCallbacks.isEmpty()) {
+            callOnMainThread([callbacks = WTFMove(m_mainThreadCallbacks)] {
+                for (auto& callback : callbacks)
+                    callback();
+            });
+        }
+    }
+
+    for (auto streamID : copyToVector(m_streams.keys()))
+        destroyStream(streamID);
+    m_curlMultiHandle = nullptr;
+    m_readBuffer = nullptr;
+}
+
+void CurlStreamScheduler::connectStream(StreamID streamID, const URL& url)
+{
+    ASSERT(!isMainThread());
+
+    auto stream = std::make_unique<Stream>(streamID);
+    stream->handle = std::make_unique<CurlSocketHandle>(url, [this, streamID](CURLcode errorCode) {
+        if (auto* stream = m_streams.get(streamID))
+            failStream(*stream, errorCode);
+    });
+
+    CURL* handle = stream->handle->handle();
+    auto& result = *m_streams.add(streamID, WTFMove(stream)).iterator->value;
+    if (m_curlMultiHandle->addHandle(handle) != CURLM_OK) {
+        failStream(result, CURLE_FAILED_INIT);
+        return;
+    }
+
+    m_connectingStreams.add(handle, streamID);
+}
+
+void CurlStreamScheduler::destroyStream(StreamID streamID)
+{
+    ASSERT(!isMainThread());
+
+    auto stream = m_streams.take(streamID);
+    if (!stream)
+        return;
+
+    CURL* handle = stream->handle->handle();
+    m_connectingStreams.remove(handle);
+    m_curlMultiHandle->removeHandle(handle);
+}
+
+void CurlStreamScheduler::completeConnection(CURL* handle, CURLcode result)
+{
+    ASSERT(!isMainThread());
+
+    auto streamID = m_connectingStreams.take(handle);
+    auto* stream = m_streams.get(streamID);
+    if (!stream)
+        return;
+
+    if (result != CURLE_OK) {
+        failStream(*stream, result);
+        return;
+    }
+
+    auto socket = stream->handle->activeSocket();
+    if (!socket)
+        return;
+
+    // The handle stays on the multi handle until the stream is destroyed, the connection
+    // belongs to it.
+    stream->socket = *socket;
+    callClientOnMainThread(streamID, [](Client& client) {
+        client.didOpen();
+    });
+}
+
+void CurlStreamScheduler::failStream(Stream& stream, CURLcode errorCode)
+{
+    ASSERT(!isMainThread());
+
+    if (stream.isFinished)
+        return;
+    stream.isFinished = true;
+
+    callClientOnMainThread(stream.streamID, [errorCode](Client& client) {
+        client.didFail(errorCode);
+    });
+}
+
+void CurlStreamScheduler::transfer(Stream& stream, const fd_set& readfds, const fd_set& writefds, const fd_set& exceptfds)
+{
+    ASSERT(!isMainThread());
+
+    if (stream.isFinished || stream.socket == CURL_SOCKET_BAD)
+        return;
+
+    if (stream.writeBuffer && FD_ISSET(stream.socket, &writefds)) {
+        stream.writeBufferOffset += stream.handle->send(stream.writeBuffer.get() + stream.writeBufferOffset, stream.writeBufferSize - stream.writeBufferOffset);
+        if (stream.isFinished)
+            return;
+
+        if (stream.writeBufferSize <= stream.writeBufferOffset) {
+            stream.writeBuffer = nullptr;
+            stream.writeBufferSize = 0;
+            stream.writeBufferOffset = 0;
+
+            callClientOnMainThread(stream.streamID, [](Client& client) {
+                client.didSendData();
+            });
+        }
+    }
+
+    if (!FD_ISSET(stream.socket, &readfds) && !FD_ISSET(stream.socket, &exceptfds))
+        return;
+
+    Vector<uint8_t> receivedData;
+    bool didClose = false;
+    while (receivedData.size() < maxReceiveSizePerIteration) {
+        auto bytesRead = stream.handle->receive(m_readBuffer.get(), readBufferSize);
+        // `nullopt` result means nothing more to read at this moment, or an error that
+        // has already been reported.
+        if (!bytesRead)
+            break;
+
+        // 0 bytes indicates a closed connection.
+        if (!*bytesRead) {
+            didClose = true;
+            break;
+        }
+
+        receivedData.append(m_readBuffer.get(), *bytesRead);
+    }
+
+    if (!receivedData.isEmpty()) {
+        callClientOnMainThread(stream.streamID, [data = WTFMove(receivedData)](Client& client) {
+            client.didReceiveData(data.data(), data.size());
+        });
+    }
+
+    if (didClose && !stream.isFinished) {
+        stream.isFinished = true;
+        callClientOnMainThread(stream.streamID, [](Client& client) {
+            client.didClose();
+        });
+    }
+}
+
+} // namespace WebCore
+
+#endif
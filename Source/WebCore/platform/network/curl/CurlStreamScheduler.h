@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CurlContext.h"
+#include <wtf/HashMap.h>
+#include <wtf/Lock.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/UniqueArray.h>
+
+namespace WebCore {
+
+// Runs the I/O of every WebSocket stream on one worker thread. Connections are made
+// through a curl multi handle and the connected sockets are multiplexed with select().
+// The thread sleeps until a socket is ready or the main thread queues work, and exits
+// once the last stream is closed.
+class CurlStreamScheduler {
+    WTF_MAKE_NONCOPYABLE(CurlStreamScheduler);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    using StreamID = uint64_t;
+
+    // All callbacks are made on the main thread, never after close().
+    class Client {
+    public:
+        virtual void didOpen() = 0;
+        virtual void didSendData() = 0;
+        virtual void didReceiveData(const uint8_t*, size_t) = 0;
+        virtual void didClose() = 0;
+        virtual void didFail(CURLcode) = 0;
+
+    protected:
+        ~Client() { }
+    };
+
+    CurlStreamScheduler();
+    ~CurlStreamScheduler();
+
+    StreamID open(const URL&, Client&);
+    void close(StreamID);
+
+    // Only one send may be in flight per stream, the next one can be queued once the
+    // client got didSendData().
+    void send(StreamID, UniqueArray<uint8_t>&&, size_t);
+
+private:
+    struct Stream;
+
+    void callOnWorkerThread(Function<void()>&&);
+    void callClientOnMainThread(StreamID, Function<void(Client&)>&&);
+
+    void startThreadIfNeeded();
+    void stopThread();
+    void workerThread();
+    void executeTasks();
+    void drainWakeUpSocket();
+
+    void connectStream(StreamID, const URL&);
+    void destroyStream(StreamID);
+    void completeConnection(CURL*, CURLcode);
+    void failStream(Stream&, CURLcode);
+    void transfer(Stream&, const fd_set& readfds, const fd_set& writefds, const fd_set& exceptfds);
+
+    // Main thread.
+    StreamID m_nextStreamID { 1 };
+    HashMap<StreamID, Client*> m_clients;
+
+    Lock m_mutex;
+    RefPtr<Thread> m_thread;
+    bool m_runThread { false };
+    Vector<Function<void()>> m_taskQueue;
+    bool m_wakeUpPending { false };
+    curl_socket_t m_wakeUpSocket { CURL_SOCKET_BAD };
+
+    // Worker thread.
+    std::unique_ptr<CurlMultiHandle> m_curlMultiHandle;
+    HashMap<StreamID, std::unique_ptr<Stream>> m_streams;
+    HashMap<CURL*, StreamID> m_connectingStreams;
+    Vector<Function<void()>> m_mainThreadCallbacks;
+    UniqueArray<uint8_t> m_readBuffer;
+};
+
+} // namespace WebCore
@@ -32,22 +32,19 @@
 #pragma once
 
 #include "CurlContext.h"
+#include "CurlStreamScheduler.h"
 #include "SocketStreamHandle.h"
 #include <pal/SessionID.h>
 #include <wtf/Function.h>
-#include <wtf/Lock.h>
-#include <wtf/MessageQueue.h>
 #include <wtf/RefCounted.h>
 #include <wtf/StreamBuffer.h>
-#include <wtf/Threading.h>
-#include <wtf/UniqueArray.h>
 
 namespace WebCore {
 
 class SocketStreamHandleClient;
 class StorageSessionProvider;
 
-class SocketStreamHandleImpl : public SocketStreamHandle {
+class SocketStreamHandleImpl : public SocketStreamHandle, public CurlStreamScheduler::Client {
 public:
     static Ref<SocketStreamHandleImpl> create(const URL& url, SocketStreamHandleClient& client, PAL::SessionID, const String&, SourceApplicationAuditToken&&, const StorageSessionProvider* provider) { return adoptRef(*new SocketStreamHandleImpl(url, client, provider)); }
 
@@ -64,25 +61,16 @@ private:
     Optional<size_t> platformSendInternal(const uint8_t*, size_t);
     bool sendPendingData();
 
-    void threadEntryPoint();
-    void handleError(CURLcode);
-    void stopThread();
-
-    void callOnWorkerThread(Function<void()>&&);
-    void executeTasks();
-
-    static const size_t kReadBufferSize = 4 * 1024;
+    // CurlStreamScheduler::Client
+    void didOpen() final;
+    void didSendData() final;
+    void didReceiveData(const uint8_t*, size_t) final;
+    void didClose() final;
+    void didFail(CURLcode) final;
 
     RefPtr<const StorageSessionProvider> m_storageSessionProvider;
-    RefPtr<Thread> m_workerThread;
-    std::atomic<bool> m_running { true };
-
-    MessageQueue<Function<void()>> m_taskQueue;
-
+    CurlStreamScheduler::StreamID m_streamID { 0 };
     bool m_hasPendingWriteData { false };
-    size_t m_writeBufferSize { 0 };
-    size_t m_writeBufferOffset { 0 };
-    UniqueArray<uint8_t> m_writeBuffer;
 
     StreamBuffer<uint8_t, 1024 * 1024> m_buffer;
     static const unsigned maxBufferSize = 100 * 1024 * 1024;
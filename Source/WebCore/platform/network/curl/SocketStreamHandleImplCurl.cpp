@@ -57,15 +57,13 @@ SocketStreamHandleImpl::SocketStreamHandleImpl(const URL& url, SocketStreamHandl
     if (m_url.protocolIs("wss") && DeprecatedGlobalSettings::allowsAnySSLCertificate())
         CurlContext::singleton().sslHandle().setIgnoreSSLErrors(true);
 
-    m_workerThread = Thread::create("WebSocket thread", [this, protectedThis = makeRef(*this)] {
-        threadEntryPoint();
-    });
+    m_streamID = CurlContext::singleton().streamScheduler().open(m_url, *this);
 }
 
 SocketStreamHandleImpl::~SocketStreamHandleImpl()
 {
     LOG(Network, "SocketStreamHandle %p delete", this);
-    stopThread();
+    CurlContext::singleton().streamScheduler().close(m_streamID);
 }
 
 Optional<size_t> SocketStreamHandleImpl::platformSendInternal(const uint8_t* data, size_t length)
@@ -81,13 +79,7 @@ Optional<size_t> SocketStreamHandleImpl::platformSendInternal(const uint8_t* dat
     auto writeBuffer = makeUniqueArray<uint8_t>(length);
     memcpy(writeBuffer.get(), data, length);
 
-    callOnWorkerThread([this, writeBuffer = WTFMove(writeBuffer), writeBufferSize = length]() mutable {
-        ASSERT(!isMainThread());
-        m_writeBuffer = WTFMove(writeBuffer);
-        m_writeBufferSize = writeBufferSize;
-        m_writeBufferOffset = 0;
-    });
-
+    CurlContext::singleton().streamScheduler().send(m_streamID, WTFMove(writeBuffer), length);
     return length;
 }
 
@@ -100,118 +92,52 @@ void SocketStreamHandleImpl::platformClose()
         return;
     m_state = Closed;
 
-    stopThread();
+    CurlContext::singleton().streamScheduler().close(m_streamID);
     m_client.didCloseSocketStream(*this);
 }
 
-void SocketStreamHandleImpl::threadEntryPoint()
+void SocketStreamHandleImpl::didOpen()
 {
-    ASSERT(!isMainThread());
-
-    CurlSocketHandle socket { m_url.isolatedCopy(), [this](CURLcode errorCode) {
-        handleError(errorCode);
-    }};
-
-    // Connect to host
-    if (!socket.connect())
+    if (m_state != Connecting)
         return;
 
-    callOnMainThread([this, protectedThis = makeRef(*this)] {
-        if (m_state == Connecting) {
-            m_state = Open;
-            m_client.didOpenSocketStream(*this);
-        }
-    });
-
-    while (m_running) {
-        executeTasks();
-
-        auto result = socket.wait(20_ms, m_writeBuffer.get());
-        if (!result)
-            continue;
-
-        // These logic only run when there's data waiting.
-        if (result->writable && m_running) {
-            auto bytesSent = socket.send(m_writeBuffer.get() + m_writeBufferOffset, m_writeBufferSize - m_writeBufferOffset);
-            m_writeBufferOffset += bytesSent;
-
-            if (m_writeBufferSize <= m_writeBufferOffset) {
-                m_writeBuffer = nullptr;
-                m_writeBufferSize = 0;
-                m_writeBufferOffset = 0;
-
-                callOnMainThread([this, protectedThis = makeRef(*this)] {
-                    m_hasPendingWriteData = false;
-                    sendPendingData();
-                });
-            }
-        }
-
-        if (result->readable && m_running) {
-            auto readBuffer = makeUniqueArray<uint8_t>(kReadBufferSize);
-            auto bytesRead = socket.receive(readBuffer.get(), kReadBufferSize);
-            // `nullopt` result means nothing to handle at this moment.
-            if (!bytesRead)
-                continue;
-
-            // 0 bytes indicates a closed connection.
-            if (!*bytesRead) {
-                m_running = false;
-                callOnMainThread([this, protectedThis = makeRef(*this)] {
-                    close();
-                });
-                break;
-            }
-
-            callOnMainThread([this, protectedThis = makeRef(*this), buffer = WTFMove(readBuffer), size = *bytesRead ] {
-                if (m_state == Open)
-                    m_client.didReceiveSocketStreamData(*this, reinterpret_cast<const char*>(buffer.get()), size);
-            });
-        }
-    }
-
-    m_writeBuffer = nullptr;
+    auto protectedThis = makeRef(*this);
+    m_state = Open;
+    m_client.didOpenSocketStream(*this);
 }
 
-void SocketStreamHandleImpl::handleError(CURLcode errorCode)
+void SocketStreamHandleImpl::didSendData()
 {
-    m_running = false;
-    callOnMainThread([this, protectedThis = makeRef(*this), errorCode, localizedDescription = CurlHandle::errorDescription(errorCode).isolatedCopy()] {
-        if (m_state == Closed)
-            return;
-
-        if (errorCode == CURLE_RECV_ERROR)
-            m_client.didFailToReceiveSocketStreamData(*this);
-        else
-            m_client.didFailSocketStream(*this, SocketStreamError(static_cast<int>(errorCode), { }, localizedDescription));
-    });
+    auto protectedThis = makeRef(*this);
+    m_hasPendingWriteData = false;
+    sendPendingData();
 }
 
-void SocketStreamHandleImpl::stopThread()
+void SocketStreamHandleImpl::didReceiveData(const uint8_t* data, size_t length)
 {
-    ASSERT(isMainThread());
-
-    m_running = false;
+    if (m_state != Open)
+        return;
 
-    if (m_workerThread) {
-        m_workerThread->waitForCompletion();
-        m_workerThread = nullptr;
-    }
+    auto protectedThis = makeRef(*this);
+    m_client.didReceiveSocketStreamData(*this, reinterpret_cast<const char*>(data), length);
 }
 
-void SocketStreamHandleImpl::callOnWorkerThread(Function<void()>&& task)
+void SocketStreamHandleImpl::didClose()
 {
-    ASSERT(isMainThread());
-    m_taskQueue.append(std::make_unique<Function<void()>>(WTFMove(task)));
+    auto protectedThis = makeRef(*this);
+    close();
 }
 
-void SocketStreamHandleImpl::executeTasks()
+void SocketStreamHandleImpl::didFail(CURLcode errorCode)
 {
-    ASSERT(!isMainThread());
+    if (m_state == Closed)
+        return;
 
-    auto tasks = m_taskQueue.takeAllMessages();
-    for (auto& task : tasks)
-        (*task)();
+    auto protectedThis = makeRef(*this);
+    if (errorCode == CURLE_RECV_ERROR)
+        m_client.didFailToReceiveSocketStreamData(*this);
+    else
+        m_client.didFailSocketStream(*this, SocketStreamError(static_cast<int>(errorCode), { }, CurlHandle::errorDescription(errorCode)));
 }
 
 } // namespace WebCore
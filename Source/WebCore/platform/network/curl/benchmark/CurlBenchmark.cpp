@@ -0,0 +1,559 @@
+// CurlBenchmark drives the curl network stack against a LocalHTTPServer on 127.0.0.1, once
+// over HTTP/1.1 and once over HTTP/2, and prints what a page loading many resources at once
+// would see:
+//
+//  - A load test that keeps --concurrency CurlRequests in flight through the
+//    CurlRequestScheduler until --requests of them have finished. It reports throughput,
+//    time to first byte by resource priority, and the CPU time the main thread spent.
+//  - A cache test that loads --cache-entries cacheable URLs through ResourceHandle, then
+//    loads them again so CurlCacheManager revalidates them and serves them from disk.
+//
+// Nothing leaves the machine. Run it on an otherwise idle box and compare runs on the same one.
+
+#include "config.h"
+
+#include "CurlCacheManager.h"
+#include "CurlContext.h"
+#include "CurlRequest.h"
+#include "CurlRequestClient.h"
+#include "CurlResponse.h"
+#include "LocalHTTPServer.h"
+#include "NetworkLoadMetrics.h"
+#include "NetworkStorageSession.h"
+#include "NetworkingContext.h"
+#include "ResourceError.h"
+#include "ResourceHandle.h"
+#include "ResourceHandleClient.h"
+#include "ResourceLoadPriority.h"
+#include "ResourceRequest.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include <pal/SessionID.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <wtf/FileSystem.h>
+#include <wtf/HashSet.h>
+#include <wtf/MainThread.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/RunLoop.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/text/CString.h>
+
+using namespace WebCore;
+
+namespace {
+
+struct Options {
+    unsigned requestCount { 5000 };
+    unsigned concurrency { 1000 };
+    unsigned cacheEntryCount { 200 };
+    bool runHTTP1 { true };
+    bool runHTTP2 { true };
+};
+
+// The mix of a typical page: many small resources needed first, a few large ones needed last.
+struct ResourceKind {
+    size_t size;
+    ResourceLoadPriority priority;
+    unsigned percentage;
+};
+
+static const ResourceKind resourceMix[] = {
+    { 1 * KB, ResourceLoadPriority::VeryHigh, 20 },
+    { 16 * KB, ResourceLoadPriority::High, 40 },
+    { 128 * KB, ResourceLoadPriority::Medium, 25 },
+    { 1 * MB, ResourceLoadPriority::Low, 10 },
+    { 8 * MB, ResourceLoadPriority::VeryLow, 5 },
+};
+
+static const char* priorityName(ResourceLoadPriority priority)
+{
+    switch (priority) {
+    case ResourceLoadPriority::VeryLow:
+        return "very low";
+    case ResourceLoadPriority::Low:
+        return "low";
+    case ResourceLoadPriority::Medium:
+        return "medium";
+    case ResourceLoadPriority::High:
+        return "high";
+    case ResourceLoadPriority::VeryHigh:
+        return "very high";
+    }
+    return "";
+}
+
+static const ResourceKind& resourceKindForRequest(unsigned index)
+{
+    // 37 is coprime to 100, so every run of 100 requests has the exact mix, spread out.
+    unsigned slot = (index * 37) % 100;
+    for (auto& kind : resourceMix) {
+        if (slot < kind.percentage)
+            return kind;
+        slot -= kind.percentage;
+    }
+    return resourceMix[0];
+}
+
+static const size_t cacheEntrySize = 32 * KB;
+
+static Seconds mainThreadCPUTime()
+{
+    ASSERT(isMainThread());
+
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return Seconds(time.tv_sec + time.tv_nsec / 1e9);
+}
+
+static void sortLatencies(Vector<Seconds>& latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+}
+
+// Expects sorted latencies.
+static double percentileInMilliseconds(const Vector<Seconds>& latencies, double fraction)
+{
+    if (latencies.isEmpty())
+        return 0;
+    return latencies[std::min<size_t>(latencies.size() - 1, latencies.size() * fraction)].milliseconds();
+}
+
+static const char* protocolName(LocalHTTPServer::Protocol protocol)
+{
+    return protocol == LocalHTTPServer::Protocol::HTTP2 ? "HTTP/2" : "HTTP/1.1";
+}
+
+class LoadTest;
+
+class BenchmarkRequest final : public ThreadSafeRefCounted<BenchmarkRequest>, public CurlRequestClient {
+public:
+    static Ref<BenchmarkRequest> create(LoadTest& test, const ResourceRequest& request)
+    {
+        return adoptRef(*new BenchmarkRequest(test, request));
+    }
+
+    ~BenchmarkRequest()
+    {
+        m_curlRequest->invalidateClient();
+    }
+
+    void ref() final { ThreadSafeRefCounted<BenchmarkRequest>::ref(); }
+    void deref() final { ThreadSafeRefCounted<BenchmarkRequest>::deref(); }
+
+    void start()
+    {
+        m_startTime = MonotonicTime::now();
+        m_curlRequest->start();
+    }
+
+    ResourceLoadPriority priority() const { return m_curlRequest->resourceRequest().priority(); }
+    Seconds timeToFirstByte() const { return m_timeToFirstByte; }
+    uint64_t receivedBytes() const { return m_receivedBytes; }
+
+private:
+    BenchmarkRequest(LoadTest&, const ResourceRequest&);
+
+    void curlDidSendData(CurlRequest&, unsigned long long, unsigned long long) final { }
+    void curlDidReceiveResponse(CurlRequest&, CurlResponse&&) final;
+    void curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&&) final;
+    void curlDidComplete(CurlRequest&, NetworkLoadMetrics&&) final;
+    void curlDidFailWithError(CurlRequest&, ResourceError&&, CertificateInfo&&) final;
+
+    LoadTest& m_test;
+    Ref<CurlRequest> m_curlRequest;
+    MonotonicTime m_startTime;
+    Seconds m_timeToFirstByte;
+    long m_statusCode { 0 };
+    uint64_t m_receivedBytes { 0 };
+};
+
+class LoadTest {
+    WTF_MAKE_NONCOPYABLE(LoadTest);
+public:
+    LoadTest(const LocalHTTPServer&, const Options&);
+
+    void run();
+    void printResults() const;
+
+    void requestDidFinish(BenchmarkRequest&, bool succeeded);
+
+private:
+    void startNextRequest();
+
+    const LocalHTTPServer& m_server;
+    const Options& m_options;
+
+    HashSet<RefPtr<BenchmarkRequest>> m_activeRequests;
+    unsigned m_startedCount { 0 };
+    unsigned m_finishedCount { 0 };
+    unsigned m_failedCount { 0 };
+    uint64_t m_receivedBytes { 0 };
+    Vector<Seconds> m_timesToFirstByte;
+    Vector<Seconds> m_timesToFirstByteByPriority[resourceLoadPriorityCount];
+
+    Seconds m_duration;
+    Seconds m_mainThreadTime;
+};
+
+BenchmarkRequest::BenchmarkRequest(LoadTest& test, const ResourceRequest& request)
+    : m_test(test)
+    , m_curlRequest(CurlRequest::create(request, *this))
+{
+}
+
+void BenchmarkRequest::curlDidReceiveResponse(CurlRequest& request, CurlResponse&& response)
+{
+    m_timeToFirstByte = MonotonicTime::now() - m_startTime;
+    m_statusCode = response.statusCode;
+    request.completeDidReceiveResponse();
+}
+
+void BenchmarkRequest::curlDidReceiveBuffer(CurlRequest&, Ref<SharedBuffer>&& buffer)
+{
+    m_receivedBytes += buffer->size();
+}
+
+void BenchmarkRequest::curlDidComplete(CurlRequest&, NetworkLoadMetrics&&)
+{
+    m_test.requestDidFinish(*this, m_statusCode == 200);
+}
+
+void BenchmarkRequest::curlDidFailWithError(CurlRequest&, ResourceError&&, CertificateInfo&&)
+{
+    m_test.requestDidFinish(*this, false);
+}
+
+LoadTest::LoadTest(const LocalHTTPServer& server, const Options& options)
+    : m_server(server)
+    , m_options(options)
+{
+    m_timesToFirstByte.reserveInitialCapacity(options.requestCount);
+}
+
+void LoadTest::run()
+{
+    auto startTime = MonotonicTime::now();
+    auto startCPUTime = mainThreadCPUTime();
+
+    while (m_startedCount < m_options.requestCount && m_activeRequests.size() < m_options.concurrency)
+        startNextRequest();
+    RunLoop::run();
+
+    m_duration = MonotonicTime::now() - startTime;
+    m_mainThreadTime = mainThreadCPUTime() - startCPUTime;
+
+    sortLatencies(m_timesToFirstByte);
+    for (auto& latencies : m_timesToFirstByteByPriority)
+        sortLatencies(latencies);
+}
+
+void LoadTest::startNextRequest()
+{
+    auto& kind = resourceKindForRequest(m_startedCount);
+
+    // The query keeps curl from treating two requests for the same size as one resource.
+    ResourceRequest request(URL(URL(), makeString(m_server.baseURL(), "/bytes/", String::number(static_cast<uint64_t>(kind.size)), "?", String::number(m_startedCount))));
+    request.setPriority(kind.priority);
+
+    auto benchmarkRequest = BenchmarkRequest::create(*this, request);
+    m_activeRequests.add(benchmarkRequest.copyRef());
+    ++m_startedCount;
+    benchmarkRequest->start();
+}
+
+void LoadTest::requestDidFinish(BenchmarkRequest& request, bool succeeded)
+{
+    ++m_finishedCount;
+    m_receivedBytes += request.receivedBytes();
+
+    if (succeeded) {
+        m_timesToFirstByte.append(request.timeToFirstByte());
+        m_timesToFirstByteByPriority[static_cast<unsigned>(request.priority())].append(request.timeToFirstByte());
+    } else
+        ++m_failedCount;
+
+    m_activeRequests.remove(&request);
+
+    if (m_startedCount < m_options.requestCount)
+        startNextRequest();
+    else if (m_finishedCount == m_options.requestCount)
+        RunLoop::main().stop();
+}
+
+void LoadTest::printResults() const
+{
+    printf("%s load test: %u requests, %u at a time, %u failed\n", protocolName(m_server.protocol()), m_finishedCount, m_options.concurrency, m_failedCount);
+    printf("  duration          %10.1f ms\n", m_duration.milliseconds());
+    printf("  throughput        %10.1f requests/s  %8.1f MB/s\n", m_finishedCount / m_duration.seconds(), m_receivedBytes / m_duration.seconds() / MB);
+    printf("  first byte        %10.2f ms p50  %8.2f ms p99\n", percentileInMilliseconds(m_timesToFirstByte, 0.5), percentileInMilliseconds(m_timesToFirstByte, 0.99));
+
+    // The scheduler doesn't order requests by priority yet; this shows whether a change does.
+    for (unsigned i = resourceLoadPriorityCount; i--; ) {
+        auto& latencies = m_timesToFirstByteByPriority[i];
+        if (latencies.isEmpty())
+            continue;
+        printf("    %-15s %10.2f ms p50  %8.2f ms p99  (%zu requests)\n", priorityName(static_cast<ResourceLoadPriority>(i)), percentileInMilliseconds(latencies, 0.5), percentileInMilliseconds(latencies, 0.99), latencies.size());
+    }
+
+    printf("  main thread CPU   %10.1f ms  %8.1f us/request\n", m_mainThreadTime.milliseconds(), m_finishedCount ? m_mainThreadTime.microseconds() / m_finishedCount : 0);
+}
+
+// Just enough of a NetworkingContext for ResourceHandle: cookies go to an in-memory CookieJarDB.
+class BenchmarkNetworkingContext final : public NetworkingContext {
+public:
+    static Ref<BenchmarkNetworkingContext> create()
+    {
+        return adoptRef(*new BenchmarkNetworkingContext);
+    }
+
+    bool shouldClearReferrerOnHTTPSToHTTPRedirect() const final { return true; }
+    NetworkStorageSession* storageSession() const final { return m_storageSession.get(); }
+
+private:
+    BenchmarkNetworkingContext()
+        : m_storageSession(std::make_unique<NetworkStorageSession>(PAL::SessionID::defaultSessionID(), ":memory:"_s))
+    {
+    }
+
+    std::unique_ptr<NetworkStorageSession> m_storageSession;
+};
+
+// Loads are sequential so every entry is complete, and so cached, before it is loaded again.
+class CacheTest final : public ResourceHandleClient {
+    WTF_MAKE_NONCOPYABLE(CacheTest);
+public:
+    CacheTest(const LocalHTTPServer&, const Options&, NetworkingContext&);
+
+    void run();
+    void printResults() const;
+
+private:
+    void startNextLoad();
+    void loadDidFinish(bool succeeded);
+
+    void willSendRequestAsync(ResourceHandle*, ResourceRequest&&, ResourceResponse&&, CompletionHandler<void(ResourceRequest&&)>&&) final;
+    void didReceiveResponseAsync(ResourceHandle*, ResourceResponse&&, CompletionHandler<void()>&&) final;
+#if USE(PROTECTION_SPACE_AUTH_CALLBACK)
+    void canAuthenticateAgainstProtectionSpaceAsync(ResourceHandle*, const ProtectionSpace&, CompletionHandler<void(bool)>&&) final;
+#endif
+    void didFinishLoading(ResourceHandle*) final { loadDidFinish(true); }
+    void didFail(ResourceHandle*, const ResourceError&) final { loadDidFinish(false); }
+
+    const LocalHTTPServer& m_server;
+    const Options& m_options;
+    NetworkingContext& m_context;
+
+    RefPtr<ResourceHandle> m_handle;
+    unsigned m_loadCount { 0 };
+    MonotonicTime m_loadStartTime;
+    bool m_loadWasServedFromCache { false };
+
+    Vector<Seconds> m_missLatencies;
+    Vector<Seconds> m_hitLatencies;
+    unsigned m_unexpectedMissCount { 0 };
+    unsigned m_failedCount { 0 };
+};
+
+CacheTest::CacheTest(const LocalHTTPServer& server, const Options& options, NetworkingContext& context)
+    : m_server(server)
+    , m_options(options)
+    , m_context(context)
+{
+}
+
+void CacheTest::run()
+{
+    if (!m_options.cacheEntryCount)
+        return;
+
+    startNextLoad();
+    RunLoop::run();
+
+    sortLatencies(m_missLatencies);
+    sortLatencies(m_hitLatencies);
+}
+
+void CacheTest::startNextLoad()
+{
+    // The first pass fills the cache and the second one hits it.
+    unsigned entry = m_loadCount % m_options.cacheEntryCount;
+    ResourceRequest request(URL(URL(), makeString(m_server.baseURL(), "/cacheable/", String::number(static_cast<uint64_t>(cacheEntrySize)), "?", String::number(entry))));
+
+    m_loadWasServedFromCache = false;
+    m_loadStartTime = MonotonicTime::now();
+    m_handle = ResourceHandle::create(&m_context, request, this, false, false, false);
+}
+
+void CacheTest::loadDidFinish(bool succeeded)
+{
+    auto latency = MonotonicTime::now() - m_loadStartTime;
+    bool isSecondPass = m_loadCount >= m_options.cacheEntryCount;
+
+    if (!succeeded)
+        ++m_failedCount;
+    else if (!isSecondPass)
+        m_missLatencies.append(latency);
+    else if (m_loadWasServedFromCache)
+        m_hitLatencies.append(latency);
+    else
+        ++m_unexpectedMissCount;
+
+    // The handle is still on the stack, so it is released and replaced on the next turn.
+    callOnMainThread([this] {
+        m_handle = nullptr;
+        if (++m_loadCount < 2 * m_options.cacheEntryCount)
+            startNextLoad();
+        else
+            RunLoop::main().stop();
+    });
+}
+
+void CacheTest::willSendRequestAsync(ResourceHandle*, ResourceRequest&& request, ResourceResponse&&, CompletionHandler<void(ResourceRequest&&)>&& completionHandler)
+{
+    completionHandler(WTFMove(request));
+}
+
+void CacheTest::didReceiveResponseAsync(ResourceHandle*, ResourceResponse&& response, CompletionHandler<void()>&& completionHandler)
+{
+    m_loadWasServedFromCache = response.source() == ResourceResponse::Source::DiskCache;
+    completionHandler();
+}
+
+#if USE(PROTECTION_SPACE_AUTH_CALLBACK)
+void CacheTest::canAuthenticateAgainstProtectionSpaceAsync(ResourceHandle*, const ProtectionSpace&, CompletionHandler<void(bool)>&& completionHandler)
+{
+    completionHandler(false);
+}
+#endif
+
+void CacheTest::printResults() const
+{
+    if (!m_options.cacheEntryCount)
+        return;
+
+    printf("%s cache test: %u entries of %zu KB, %u failed, %u not served from the cache\n", protocolName(m_server.protocol()), m_options.cacheEntryCount, cacheEntrySize / KB, m_failedCount, m_unexpectedMissCount);
+    printf("  miss              %10.2f ms p50  %8.2f ms p99\n", percentileInMilliseconds(m_missLatencies, 0.5), percentileInMilliseconds(m_missLatencies, 0.99));
+    printf("  hit               %10.2f ms p50  %8.2f ms p99\n", percentileInMilliseconds(m_hitLatencies, 0.5), percentileInMilliseconds(m_hitLatencies, 0.99));
+}
+
+static bool parseUnsigned(const String& argument, const char* name, unsigned& value)
+{
+    if (!argument.startsWith(name))
+        return false;
+
+    bool ok;
+    unsigned parsedValue = argument.substring(strlen(name)).toUIntStrict(&ok);
+    if (!ok)
+        return false;
+
+    value = parsedValue;
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        String argument(argv[i]);
+        if (parseUnsigned(argument, "--requests=", options.requestCount)
+            || parseUnsigned(argument, "--concurrency=", options.concurrency)
+            || parseUnsigned(argument, "--cache-entries=", options.cacheEntryCount))
+            continue;
+
+        if (argument == "--protocol=http1")
+            options.runHTTP2 = false;
+        else if (argument == "--protocol=http2")
+            options.runHTTP1 = false;
+        else if (argument != "--protocol=both")
+            return false;
+    }
+
+    return options.requestCount && options.concurrency;
+}
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --requests=N        requests in the load test (default 5000)\n"
+        "  --concurrency=N     requests in flight at once (default 1000)\n"
+        "  --cache-entries=N   entries in the cache test, 0 to skip it (default 200)\n"
+        "  --protocol=P        http1, http2 or both (default both)\n",
+        program);
+}
+
+static String createCacheDirectory()
+{
+    char path[] = "/tmp/CurlBenchmark-XXXXXX";
+    if (!mkdtemp(path))
+        return String();
+    return String::fromUTF8(path);
+}
+
+static void deleteCacheDirectory(const String& path)
+{
+    for (auto& file : FileSystem::listDirectory(path))
+        FileSystem::deleteFile(file);
+    FileSystem::deleteEmptyDirectory(path);
+}
+
+static bool runBenchmark(LocalHTTPServer::Protocol protocol, const Options& options, NetworkingContext& context)
+{
+    if (protocol == LocalHTTPServer::Protocol::HTTP2 && !CurlContext::singleton().isHttp2Enabled()) {
+        printf("%s: skipped, libcurl was built without HTTP/2\n\n", protocolName(protocol));
+        return true;
+    }
+
+    auto server = LocalHTTPServer::create(protocol);
+    if (!server) {
+        fprintf(stderr, "Couldn't start the %s server\n", protocolName(protocol));
+        return false;
+    }
+
+    LoadTest loadTest(*server, options);
+    loadTest.run();
+    loadTest.printResults();
+
+    CacheTest cacheTest(*server, options, context);
+    cacheTest.run();
+    cacheTest.printResults();
+
+    printf("\n");
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // A peer closing a TLS connection mid-write must not kill the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    RunLoop::initializeMainRunLoop();
+
+    // The HTTP/2 server's certificate is self-signed.
+    CurlContext::singleton().sslHandle().setIgnoreSSLErrors(true);
+
+    String cacheDirectory = createCacheDirectory();
+    if (cacheDirectory.isNull()) {
+        fprintf(stderr, "Couldn't create a cache directory\n");
+        return EXIT_FAILURE;
+    }
+    CurlCacheManager::singleton().setCacheDirectory(cacheDirectory);
+
+    auto context = BenchmarkNetworkingContext::create();
+
+    bool succeeded = (!options.runHTTP1 || runBenchmark(LocalHTTPServer::Protocol::HTTP1, options, context))
+        && (!options.runHTTP2 || runBenchmark(LocalHTTPServer::Protocol::HTTP2, options, context));
+
+    deleteCacheDirectory(cacheDirectory);
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
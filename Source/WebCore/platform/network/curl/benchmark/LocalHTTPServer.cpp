@@ -0,0 +1,573 @@
+#include "config.h"
+#include "LocalHTTPServer.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nghttp2/nghttp2.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wtf/HashMap.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/text/CString.h>
+#include <wtf/text/StringBuilder.h>
+
+namespace WebCore {
+
+// Larger requests are answered with 404 so a typo can't exhaust memory on either side.
+static const size_t maximumBodySize = 256 * MB;
+
+static const char bytesPrefix[] = "/bytes/";
+static const char cacheablePrefix[] = "/cacheable/";
+
+struct Response {
+    int statusCode { 404 };
+    size_t contentLength { 0 };
+    bool isCacheable { false };
+    String entityTag;
+};
+
+static Response responseForRequest(const String& target, const String& ifNoneMatch)
+{
+    Response response;
+
+    size_t queryStart = target.find('?');
+    String path = queryStart == notFound ? target : target.left(queryStart);
+
+    String size;
+    if (path.startsWith(bytesPrefix))
+        size = path.substring(strlen(bytesPrefix));
+    else if (path.startsWith(cacheablePrefix)) {
+        size = path.substring(strlen(cacheablePrefix));
+        response.isCacheable = true;
+    } else
+        return response;
+
+    bool ok;
+    uint64_t contentLength = size.toUInt64Strict(&ok);
+    if (!ok || contentLength > maximumBodySize) {
+        response.isCacheable = false;
+        return response;
+    }
+
+    if (response.isCacheable) {
+        response.entityTag = makeString('"', size, '"');
+        if (ifNoneMatch == response.entityTag) {
+            response.statusCode = 304;
+            return response;
+        }
+    }
+
+    response.statusCode = 200;
+    response.contentLength = contentLength;
+    return response;
+}
+
+static const char* reasonPhrase(int statusCode)
+{
+    switch (statusCode) {
+    case 200:
+        return "OK";
+    case 304:
+        return "Not Modified";
+    default:
+        return "Not Found";
+    }
+}
+
+static const char* cacheControl(const Response& response)
+{
+    return response.isCacheable ? "max-age=3600" : "no-store";
+}
+
+// Every body is a run of this pattern, so nothing is allocated per response.
+static const size_t bodyPatternSize = 64 * KB;
+
+static const char* bodyPattern()
+{
+    static char* pattern = [] {
+        char* pattern = static_cast<char*>(fastMalloc(bodyPatternSize));
+        for (size_t i = 0; i < bodyPatternSize; ++i)
+            pattern[i] = 'a' + i % 26;
+        return pattern;
+    }();
+    return pattern;
+}
+
+std::unique_ptr<LocalHTTPServer> LocalHTTPServer::create(Protocol protocol)
+{
+    std::unique_ptr<LocalHTTPServer> server(new LocalHTTPServer(protocol));
+
+    if (protocol == Protocol::HTTP2 && !server->setUpTLS())
+        return nullptr;
+
+    if (!server->listen())
+        return nullptr;
+
+    return server;
+}
+
+LocalHTTPServer::LocalHTTPServer(Protocol protocol)
+    : m_protocol(protocol)
+{
+    bodyPattern();
+}
+
+LocalHTTPServer::~LocalHTTPServer()
+{
+    if (m_listenSocket != -1) {
+        // Wakes up the accept() in acceptConnections().
+        shutdown(m_listenSocket, SHUT_RDWR);
+        if (m_acceptThread)
+            m_acceptThread->waitForCompletion();
+        close(m_listenSocket);
+    }
+
+    Vector<int> sockets;
+    Vector<Ref<Thread>> threads;
+    {
+        LockHolder locker(m_connectionsLock);
+        sockets = WTFMove(m_connectionSockets);
+        threads = WTFMove(m_connectionThreads);
+    }
+
+    for (auto socket : sockets)
+        shutdown(socket, SHUT_RDWR);
+    for (auto& thread : threads)
+        thread->waitForCompletion();
+    for (auto socket : sockets)
+        close(socket);
+
+    if (m_sslContext)
+        SSL_CTX_free(m_sslContext);
+}
+
+String LocalHTTPServer::baseURL() const
+{
+    return makeString(m_protocol == Protocol::HTTP2 ? "https" : "http", "://127.0.0.1:", String::number(m_port));
+}
+
+bool LocalHTTPServer::listen()
+{
+    m_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenSocket == -1)
+        return false;
+
+    int reuseAddress = 1;
+    setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    sockaddr_in address { };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) || ::listen(m_listenSocket, SOMAXCONN))
+        return false;
+
+    socklen_t addressLength = sizeof(address);
+    if (getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength))
+        return false;
+    m_port = ntohs(address.sin_port);
+
+    m_acceptThread = Thread::create("LocalHTTPServer", [this] {
+        acceptConnections();
+    });
+    return true;
+}
+
+void LocalHTTPServer::acceptConnections()
+{
+    while (true) {
+        int socket = accept(m_listenSocket, nullptr, nullptr);
+        if (socket == -1) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return;
+        }
+
+        int noDelay = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        LockHolder locker(m_connectionsLock);
+        m_connectionSockets.append(socket);
+        m_connectionThreads.append(Thread::create("LocalHTTPServer connection", [this, socket] {
+            if (m_protocol == Protocol::HTTP2)
+                serveHTTP2(socket);
+            else
+                serveHTTP1(socket);
+        }));
+    }
+}
+
+// HTTP/1.1 -------------------------------------------------------------------
+
+static bool sendAll(int socket, const char* data, size_t size)
+{
+    while (size) {
+        ssize_t bytesSent = send(socket, data, size, MSG_NOSIGNAL);
+        if (bytesSent <= 0) {
+            if (bytesSent == -1 && errno == EINTR)
+                continue;
+            return false;
+        }
+        data += bytesSent;
+        size -= bytesSent;
+    }
+    return true;
+}
+
+static size_t findHeaderEnd(const Vector<char>& buffer)
+{
+    static const char terminator[] = "\r\n\r\n";
+    auto end = std::search(buffer.begin(), buffer.end(), terminator, terminator + 4);
+    return end == buffer.end() ? notFound : end - buffer.begin();
+}
+
+void LocalHTTPServer::serveHTTP1(int socket)
+{
+    Vector<char> buffer;
+    char readBuffer[16 * KB];
+
+    while (true) {
+        size_t headerEnd;
+        while ((headerEnd = findHeaderEnd(buffer)) == notFound) {
+            ssize_t bytesRead = recv(socket, readBuffer, sizeof(readBuffer), 0);
+            if (bytesRead <= 0) {
+                if (bytesRead == -1 && errno == EINTR)
+                    continue;
+                return;
+            }
+            buffer.append(readBuffer, bytesRead);
+        }
+
+        // The benchmark only sends GETs, so there is never a request body to skip.
+        auto lines = String(buffer.data(), headerEnd).split("\r\n");
+        buffer.remove(0, headerEnd + 4);
+
+        auto requestLine = lines[0].split(' ');
+        if (requestLine.size() != 3)
+            return;
+
+        String ifNoneMatch;
+        bool closeConnection = false;
+        for (size_t i = 1; i < lines.size(); ++i) {
+            size_t colon = lines[i].find(':');
+            if (colon == notFound)
+                continue;
+            String name = lines[i].left(colon).stripWhiteSpace();
+            String value = lines[i].substring(colon + 1).stripWhiteSpace();
+            if (equalLettersIgnoringASCIICase(name, "if-none-match"))
+                ifNoneMatch = value;
+            else if (equalLettersIgnoringASCIICase(name, "connection") && equalLettersIgnoringASCIICase(value, "close"))
+                closeConnection = true;
+        }
+
+        auto response = responseForRequest(requestLine[1], ifNoneMatch);
+
+        StringBuilder head;
+        head.appendLiteral("HTTP/1.1 ");
+        head.appendNumber(response.statusCode);
+        head.append(' ');
+        head.append(reasonPhrase(response.statusCode));
+        head.appendLiteral("\r\nContent-Type: application/octet-stream");
+        // A 304 must not claim a length other than the cached body's, and curl's cache
+        // prefers the 304's headers over the ones it stored.
+        if (response.statusCode != 304) {
+            head.appendLiteral("\r\nContent-Length: ");
+            head.appendNumber(static_cast<uint64_t>(response.contentLength));
+        }
+        head.appendLiteral("\r\nCache-Control: ");
+        head.append(cacheControl(response));
+        if (!response.entityTag.isNull()) {
+            head.appendLiteral("\r\nETag: ");
+            head.append(response.entityTag);
+        }
+        head.appendLiteral("\r\n\r\n");
+
+        auto headData = head.toString().utf8();
+        if (!sendAll(socket, headData.data(), headData.length()))
+            return;
+
+        for (size_t remaining = response.contentLength; remaining; ) {
+            size_t chunkSize = std::min(remaining, bodyPatternSize);
+            if (!sendAll(socket, bodyPattern(), chunkSize))
+                return;
+            remaining -= chunkSize;
+        }
+
+        if (closeConnection)
+            return;
+    }
+}
+
+// HTTP/2 ---------------------------------------------------------------------
+
+bool LocalHTTPServer::setUpTLS()
+{
+    m_sslContext = SSL_CTX_new(SSLv23_server_method());
+    if (!m_sslContext)
+        return false;
+
+    SSL_CTX_set_options(m_sslContext, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION);
+
+    // A throwaway P-256 key and a certificate for 127.0.0.1 signed with it.
+    EVP_PKEY* key = nullptr;
+    EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    bool generatedKey = keyContext
+        && EVP_PKEY_keygen_init(keyContext) == 1
+        && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) == 1
+        && EVP_PKEY_keygen(keyContext, &key) == 1;
+    EVP_PKEY_CTX_free(keyContext);
+    if (!generatedKey)
+        return false;
+
+    X509* certificate = X509_new();
+    X509_set_version(certificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_get_notBefore(certificate), 0);
+    X509_gmtime_adj(X509_get_notAfter(certificate), 24 * 60 * 60);
+    X509_set_pubkey(certificate, key);
+
+    X509_NAME* name = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+    X509_set_issuer_name(certificate, name);
+
+    bool success = X509_sign(certificate, key, EVP_sha256())
+        && SSL_CTX_use_certificate(m_sslContext, certificate) == 1
+        && SSL_CTX_use_PrivateKey(m_sslContext, key) == 1;
+
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+
+    if (!success)
+        return false;
+
+    SSL_CTX_set_alpn_select_cb(m_sslContext, [](SSL*, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned inLength, void*) {
+        if (nghttp2_select_next_protocol(const_cast<unsigned char**>(out), outLength, in, inLength) != 1)
+            return SSL_TLSEXT_ERR_NOACK;
+        return SSL_TLSEXT_ERR_OK;
+    }, nullptr);
+
+    return true;
+}
+
+namespace {
+
+struct HTTP2Stream {
+    WTF_MAKE_STRUCT_FAST_ALLOCATED;
+
+    String path;
+    String ifNoneMatch;
+    size_t contentLength { 0 };
+    size_t remaining { 0 };
+};
+
+// One server side HTTP/2 session, driven with blocking reads and writes on the connection's thread.
+class HTTP2Connection {
+    WTF_MAKE_NONCOPYABLE(HTTP2Connection);
+public:
+    explicit HTTP2Connection(SSL*);
+    ~HTTP2Connection();
+
+    void run();
+
+private:
+    static ssize_t send(nghttp2_session*, const uint8_t*, size_t, int, void*);
+    static int beginHeaders(nghttp2_session*, const nghttp2_frame*, void*);
+    static int receiveHeader(nghttp2_session*, const nghttp2_frame*, const uint8_t* name, size_t nameLength, const uint8_t* value, size_t valueLength, uint8_t flags, void*);
+    static int receiveFrame(nghttp2_session*, const nghttp2_frame*, void*);
+    static int closeStream(nghttp2_session*, int32_t streamID, uint32_t errorCode, void*);
+    static ssize_t readBody(nghttp2_session*, int32_t streamID, uint8_t*, size_t, uint32_t* dataFlags, nghttp2_data_source*, void*);
+
+    void submitResponse(int32_t streamID, HTTP2Stream&);
+
+    SSL* m_ssl;
+    nghttp2_session* m_session { nullptr };
+    HashMap<int32_t, std::unique_ptr<HTTP2Stream>> m_streams;
+};
+
+HTTP2Connection::HTTP2Connection(SSL* ssl)
+    : m_ssl(ssl)
+{
+    nghttp2_session_callbacks* callbacks;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_send_callback(callbacks, send);
+    nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, beginHeaders);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, receiveHeader);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, receiveFrame);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, closeStream);
+    nghttp2_session_server_new(&m_session, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+}
+
+HTTP2Connection::~HTTP2Connection()
+{
+    nghttp2_session_del(m_session);
+}
+
+void HTTP2Connection::run()
+{
+    nghttp2_settings_entry settings[] = {
+        { NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 1000 },
+    };
+    if (nghttp2_submit_settings(m_session, NGHTTP2_FLAG_NONE, settings, WTF_ARRAY_LENGTH(settings)))
+        return;
+
+    uint8_t buffer[16 * KB];
+    while (nghttp2_session_want_read(m_session) || nghttp2_session_want_write(m_session)) {
+        // Everything that can be sent goes out before blocking on the next read. Data held back
+        // by flow control goes out after the read that brings the WINDOW_UPDATE.
+        if (nghttp2_session_send(m_session))
+            return;
+
+        if (!nghttp2_session_want_read(m_session))
+            return;
+
+        int bytesRead = SSL_read(m_ssl, buffer, sizeof(buffer));
+        if (bytesRead <= 0)
+            return;
+
+        if (nghttp2_session_mem_recv(m_session, buffer, bytesRead) < 0)
+            return;
+    }
+}
+
+ssize_t HTTP2Connection::send(nghttp2_session*, const uint8_t* data, size_t length, int, void* userData)
+{
+    auto& connection = *static_cast<HTTP2Connection*>(userData);
+    int bytesWritten = SSL_write(connection.m_ssl, data, length);
+    return bytesWritten > 0 ? bytesWritten : NGHTTP2_ERR_CALLBACK_FAILURE;
+}
+
+int HTTP2Connection::beginHeaders(nghttp2_session*, const nghttp2_frame* frame, void* userData)
+{
+    if (frame->hd.type != NGHTTP2_HEADERS || frame->headers.cat != NGHTTP2_HCAT_REQUEST)
+        return 0;
+
+    auto& connection = *static_cast<HTTP2Connection*>(userData);
+    connection.m_streams.set(frame->hd.stream_id, std::make_unique<HTTP2Stream>());
+    return 0;
+}
+
+int HTTP2Connection::receiveHeader(nghttp2_session*, const nghttp2_frame* frame, const uint8_t* name, size_t nameLength, const uint8_t* value, size_t valueLength, uint8_t, void* userData)
+{
+    auto& connection = *static_cast<HTTP2Connection*>(userData);
+    auto* stream = connection.m_streams.get(frame->hd.stream_id);
+    if (!stream)
+        return 0;
+
+    String headerName(name, nameLength);
+    if (headerName == ":path")
+        stream->path = String(value, valueLength);
+    else if (headerName == "if-none-match")
+        stream->ifNoneMatch = String(value, valueLength);
+    return 0;
+}
+
+int HTTP2Connection::receiveFrame(nghttp2_session*, const nghttp2_frame* frame, void* userData)
+{
+    if (frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA)
+        return 0;
+    if (!(frame->hd.flags & NGHTTP2_FLAG_END_STREAM))
+        return 0;
+
+    auto& connection = *static_cast<HTTP2Connection*>(userData);
+    if (auto* stream = connection.m_streams.get(frame->hd.stream_id))
+        connection.submitResponse(frame->hd.stream_id, *stream);
+    return 0;
+}
+
+int HTTP2Connection::closeStream(nghttp2_session*, int32_t streamID, uint32_t, void* userData)
+{
+    auto& connection = *static_cast<HTTP2Connection*>(userData);
+    connection.m_streams.remove(streamID);
+    return 0;
+}
+
+ssize_t HTTP2Connection::readBody(nghttp2_session*, int32_t, uint8_t* buffer, size_t length, uint32_t* dataFlags, nghttp2_data_source* source, void*)
+{
+    auto& stream = *static_cast<HTTP2Stream*>(source->ptr);
+
+    // Continue the pattern where the previous frame left off, so the body is the same as over HTTP/1.1.
+    size_t offset = stream.contentLength - stream.remaining;
+    size_t bytesToCopy = std::min(length, stream.remaining);
+    for (size_t copied = 0; copied < bytesToCopy; ) {
+        size_t patternOffset = (offset + copied) % bodyPatternSize;
+        size_t chunkSize = std::min(bytesToCopy - copied, bodyPatternSize - patternOffset);
+        memcpy(buffer + copied, bodyPattern() + patternOffset, chunkSize);
+        copied += chunkSize;
+    }
+
+    stream.remaining -= bytesToCopy;
+    if (!stream.remaining)
+        *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+    return bytesToCopy;
+}
+
+static nghttp2_nv makeHeader(const char* name, const CString& value)
+{
+    return { reinterpret_cast<uint8_t*>(const_cast<char*>(name)), reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())), strlen(name), value.length(), NGHTTP2_NV_FLAG_NONE };
+}
+
+void HTTP2Connection::submitResponse(int32_t streamID, HTTP2Stream& stream)
+{
+    auto response = responseForRequest(stream.path, stream.ifNoneMatch);
+
+    // nghttp2_submit_response() copies the names and values.
+    auto status = String::number(response.statusCode).utf8();
+    auto contentLength = String::number(static_cast<uint64_t>(response.contentLength)).utf8();
+    CString contentType("application/octet-stream");
+    CString cacheControlValue(cacheControl(response));
+    auto entityTag = response.entityTag.utf8();
+
+    Vector<nghttp2_nv, 5> headers;
+    headers.append(makeHeader(":status", status));
+    headers.append(makeHeader("content-type", contentType));
+    if (response.statusCode != 304)
+        headers.append(makeHeader("content-length", contentLength));
+    headers.append(makeHeader("cache-control", cacheControlValue));
+    if (!response.entityTag.isNull())
+        headers.append(makeHeader("etag", entityTag));
+
+    stream.contentLength = response.contentLength;
+    stream.remaining = response.contentLength;
+
+    nghttp2_data_provider body;
+    body.source.ptr = &stream;
+    body.read_callback = readBody;
+
+    nghttp2_submit_response(m_session, streamID, headers.data(), headers.size(), response.contentLength ? &body : nullptr);
+}
+
+} // namespace
+
+void LocalHTTPServer::serveHTTP2(int socket)
+{
+    SSL* ssl = SSL_new(m_sslContext);
+    if (!ssl)
+        return;
+
+    SSL_set_fd(ssl, socket);
+    if (SSL_accept(ssl) == 1) {
+        const unsigned char* protocol = nullptr;
+        unsigned protocolLength = 0;
+        SSL_get0_alpn_selected(ssl, &protocol, &protocolLength);
+
+        // Only clients that negotiated h2 are served; there is no HTTP/1.1 fallback over TLS.
+        if (protocolLength == 2 && !memcmp(protocol, "h2", 2)) {
+            HTTP2Connection connection(ssl);
+            connection.run();
+        }
+
+        SSL_shutdown(ssl);
+    }
+
+    SSL_free(ssl);
+}
+
+} // namespace WebCore
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <wtf/Lock.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/WTFString.h>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace WebCore {
+
+// A small HTTP server on 127.0.0.1 for CurlBenchmark. It serves HTTP/1.1 in the clear, or
+// HTTP/2 over TLS with a self-signed certificate that clients have to be told to accept.
+//
+//   /bytes/<size>      <size> bytes the client must not cache
+//   /cacheable/<size>  <size> bytes cacheable for an hour, revalidated with If-None-Match
+//
+// Anything after a '?' is ignored, so a query makes a URL unique without changing the body.
+// Each connection is served on its own thread.
+class LocalHTTPServer {
+    WTF_MAKE_NONCOPYABLE(LocalHTTPServer);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    enum class Protocol {
+        HTTP1,
+        HTTP2
+    };
+
+    // Returns null if the server couldn't listen or set up TLS.
+    static std::unique_ptr<LocalHTTPServer> create(Protocol);
+    ~LocalHTTPServer();
+
+    Protocol protocol() const { return m_protocol; }
+    String baseURL() const;
+
+private:
+    explicit LocalHTTPServer(Protocol);
+
+    bool listen();
+    bool setUpTLS();
+    void acceptConnections();
+
+    void serveHTTP1(int socket);
+    void serveHTTP2(int socket);
+
+    Protocol m_protocol;
+    int m_listenSocket { -1 };
+    unsigned short m_port { 0 };
+    SSL_CTX* m_sslContext { nullptr };
+
+    RefPtr<Thread> m_acceptThread;
+
+    Lock m_connectionsLock;
+    Vector<int> m_connectionSockets;
+    Vector<Ref<Thread>> m_connectionThreads;
+};
+
+} // namespace WebCore
@@ -188,6 +188,9 @@ void SQLiteDatabase::useWALJournalMode()
 
 void SQLiteDatabase::close()
 {
+    // sqlite3_close() fails and leaves the connection open while it has unfinalized statements.
+    clearCachedStatements();
+
     if (m_db) {
         // FIXME: This is being called on the main thread during JS GC. <rdar://problem/5739818>
         // ASSERT(m_openingThread == &Thread::current());
@@ -322,6 +325,85 @@ void SQLiteDatabase::setSynchronous(SynchronousPragma sync)
     executeCommand(makeString("PRAGMA synchronous = ", static_cast<unsigned>(sync)));
 }
 
+void SQLiteDatabase::setMemoryMapSize(int64_t size)
+{
+    if (size < 0)
+        size = 0;
+
+    LockHolder locker(m_authorizerLock);
+    enableAuthorizer(false);
+
+    // The pragma answers with the size that was actually applied, which is capped at SQLITE_MAX_MMAP_SIZE.
+    SQLiteStatement statement(*this, makeString("PRAGMA mmap_size = ", size));
+    if (statement.prepareAndStep() == SQLITE_ROW)
+        LOG(SQLDatabase, "SQLite database memory maps up to %lli bytes", static_cast<long long>(statement.getColumnInt64(0)));
+    else
+        LOG_ERROR("Failed to set memory map size of database to %lli bytes", static_cast<long long>(size));
+
+    enableAuthorizer(true);
+}
+
+void SQLiteDatabase::setCacheSize(int64_t size)
+{
+    if (size < 0)
+        size = 0;
+
+    LockHolder locker(m_authorizerLock);
+    enableAuthorizer(false);
+
+    // A negative cache_size is a limit in KiB rather than a page count, so it doesn't depend on the page size.
+    if (!executeCommand(makeString("PRAGMA cache_size = -", size / 1024)))
+        LOG_ERROR("Failed to set cache size of database to %lli bytes", static_cast<long long>(size));
+
+    enableAuthorizer(true);
+}
+
+SQLiteStatement* SQLiteDatabase::cachedStatement(const String& query)
+{
+    if (!m_db)
+        return nullptr;
+
+    auto iterator = m_cachedStatements.find(query);
+    if (iterator != m_cachedStatements.end()) {
+        if (iterator->value->reset() == SQLITE_OK) {
+            m_cachedStatementsUseOrder.appendOrMoveToLast(query);
+            return iterator->value.get();
+        }
+        m_cachedStatements.remove(iterator);
+        m_cachedStatementsUseOrder.remove(query);
+    }
+
+    auto statement = std::make_unique<SQLiteStatement>(*this, query);
+    if (statement->prepare() != SQLITE_OK)
+        return nullptr;
+
+    evictCachedStatementsIfNeeded(m_statementCacheCapacity - 1);
+
+    auto* result = statement.get();
+    m_cachedStatements.add(query, WTFMove(statement));
+    m_cachedStatementsUseOrder.add(query);
+    return result;
+}
+
+void SQLiteDatabase::setStatementCacheCapacity(unsigned capacity)
+{
+    ASSERT(capacity);
+    m_statementCacheCapacity = std::max(capacity, 1u);
+    evictCachedStatementsIfNeeded(m_statementCacheCapacity);
+}
+
+void SQLiteDatabase::evictCachedStatementsIfNeeded(unsigned capacity)
+{
+    while (m_cachedStatements.size() > capacity)
+        m_cachedStatements.remove(m_cachedStatementsUseOrder.takeFirst());
+}
+
+void SQLiteDatabase::clearCachedStatements()
+{
+    m_cachedStatements.clear();
+    m_cachedStatementsUseOrder.clear();
+}
+
 void SQLiteDatabase::setBusyTimeout(int ms)
 {
     if (m_db)
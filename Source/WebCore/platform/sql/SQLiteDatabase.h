@@ -28,9 +28,12 @@
 
 #include <functional>
 #include <sqlite3.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
 #include <wtf/Lock.h>
 #include <wtf/Threading.h>
 #include <wtf/text/CString.h>
+#include <wtf/text/StringHash.h>
 #include <wtf/text/WTFString.h>
 
 #if COMPILER(MSVC)
@@ -98,6 +101,21 @@ public:
     // OFF - Calls return immediately after the data has been passed to disk
     enum SynchronousPragma { SyncOff = 0, SyncNormal = 1, SyncFull = 2 };
     void setSynchronous(SynchronousPragma);
+
+    // Lets SQLite read up to this many bytes of the database file through a memory map instead of
+    // copying pages into its cache. 0 turns memory mapped I/O off. SQLite clamps the value to its
+    // compile time SQLITE_MAX_MMAP_SIZE, which is 0 on builds that don't support it.
+    WEBCORE_EXPORT void setMemoryMapSize(int64_t);
+
+    // Sets the most memory, in bytes, the page cache of this connection may use.
+    WEBCORE_EXPORT void setCacheSize(int64_t);
+
+    // Returns a reset, prepared statement for the query from a per-connection cache of the most
+    // recently used statements, or null if the query fails to prepare. The database owns the
+    // statement: it stays valid until the cache evicts it to make room for other queries or the
+    // database is closed, so callers shouldn't hold on to it across other cachedStatement() calls.
+    WEBCORE_EXPORT SQLiteStatement* cachedStatement(const String& query);
+    WEBCORE_EXPORT void setStatementCacheCapacity(unsigned);
     
     WEBCORE_EXPORT int lastError();
     WEBCORE_EXPORT const char* lastErrorMsg();
@@ -150,6 +168,9 @@ private:
 
     void overrideUnauthorizedFunctions();
 
+    void evictCachedStatementsIfNeeded(unsigned capacity);
+    void clearCachedStatements();
+
     sqlite3* m_db { nullptr };
     int m_pageSize { -1 };
     
@@ -172,6 +193,12 @@ private:
     CString m_openErrorMessage;
 
     int m_lastChangesCount { 0 };
+
+    static constexpr unsigned defaultStatementCacheCapacity = 32;
+    HashMap<String, std::unique_ptr<SQLiteStatement>> m_cachedStatements;
+    // Queries of m_cachedStatements, least recently used first.
+    ListHashSet<String> m_cachedStatementsUseOrder;
+    unsigned m_statementCacheCapacity { defaultStatementCacheCapacity };
 };
 
 } // namespace WebCore
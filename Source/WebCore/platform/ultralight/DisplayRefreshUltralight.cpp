@@ -0,0 +1,45 @@
+#include "config.h"
+#include "DisplayRefreshUltralight.h"
+
+#include <wtf/MainThread.h>
+#include <wtf/NeverDestroyed.h>
+
+namespace WebCore {
+
+DisplayRefreshUltralight& DisplayRefreshUltralight::singleton()
+{
+  static NeverDestroyed<DisplayRefreshUltralight> instance;
+  return instance;
+}
+
+void DisplayRefreshUltralight::displayDidRefresh()
+{
+  ASSERT(isMainThread());
+  m_lastRefreshTime = MonotonicTime::now();
+
+  // Clients added while we notify wait for the next refresh. Clients removed while we
+  // notify (e.g. a document torn down by another document's callback) are skipped.
+  m_clientsToNotify = WTFMove(m_clients);
+  while (!m_clientsToNotify.isEmpty())
+    m_clientsToNotify.takeAny()->displayDidRefresh();
+}
+
+bool DisplayRefreshUltralight::isDrivenByHost() const
+{
+  return m_lastRefreshTime && MonotonicTime::now() - m_lastRefreshTime < refreshTimeout;
+}
+
+void DisplayRefreshUltralight::addClient(DisplayRefreshUltralightClient& client)
+{
+  ASSERT(isMainThread());
+  m_clients.add(&client);
+}
+
+void DisplayRefreshUltralight::removeClient(DisplayRefreshUltralightClient& client)
+{
+  ASSERT(isMainThread());
+  m_clients.remove(&client);
+  m_clientsToNotify.remove(&client);
+}
+
+} // namespace WebCore
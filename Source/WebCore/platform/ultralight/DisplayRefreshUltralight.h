@@ -0,0 +1,51 @@
+#pragma once
+
+#include <wtf/HashSet.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+class DisplayRefreshUltralightClient {
+public:
+  virtual ~DisplayRefreshUltralightClient() = default;
+  virtual void displayDidRefresh() = 0;
+};
+
+// Lets the host pace requestAnimationFrame to its own display refresh. Hosts call
+// displayDidRefresh() once per vsync (or per presented frame) on the main thread; while
+// they keep doing so, unthrottled animation frames are serviced from there instead of
+// from a timer. Hosts that never call it keep the timer-driven behavior.
+//
+// Visibility and low power mode are reported through the usual WebCore entry points:
+// Page::setActivityState() for hidden or occluded views and
+// LowPowerModeNotifier::setLowPowerModeEnabled() for low power mode.
+class DisplayRefreshUltralight {
+  WTF_MAKE_NONCOPYABLE(DisplayRefreshUltralight); WTF_MAKE_FAST_ALLOCATED;
+public:
+  WEBCORE_EXPORT static DisplayRefreshUltralight& singleton();
+
+  WEBCORE_EXPORT void displayDidRefresh();
+
+  // Whether the host has refreshed recently enough that waiting for the next refresh
+  // won't stall animations.
+  bool isDrivenByHost() const;
+
+  // Clients are notified once, on the next refresh, and must add themselves again to
+  // be notified of the one after.
+  void addClient(DisplayRefreshUltralightClient&);
+  void removeClient(DisplayRefreshUltralightClient&);
+
+  // How long a client should wait for a refresh before servicing its frame anyway.
+  static constexpr Seconds refreshTimeout { 100_ms };
+
+private:
+  friend class NeverDestroyed<DisplayRefreshUltralight>;
+  DisplayRefreshUltralight() = default;
+
+  HashSet<DisplayRefreshUltralightClient*> m_clients;
+  HashSet<DisplayRefreshUltralightClient*> m_clientsToNotify;
+  MonotonicTime m_lastRefreshTime;
+};
+
+} // namespace WebCore
@@ -52,14 +52,14 @@ void load(const URL& url, LoadCompletionHandler&& completionHandler) {
       if (file != ultralight::invalidFileHandle) {
         int64_t fileSize = 0;
         if (fs->GetFileSize(file, fileSize) && fileSize > 0) {
-          char* buffer = new char[fileSize];
-          if (fs->ReadFromFile(file, buffer, fileSize) > 0) {
-            loadTask->result.data = SharedBuffer::create(buffer, fileSize);
+          Vector<char> buffer;
+          buffer.grow(fileSize);
+          if (fs->ReadFromFile(file, buffer.data(), fileSize) > 0) {
+            loadTask->result.data = SharedBuffer::create(WTFMove(buffer));
             ultralight::String16 mimeType = "application/unknown";
             fs->GetFileMimeType(path, mimeType);
             loadTask->result.mimeType = ultralight::Convert(mimeType);
-            ultralight::String16 charset = "utf-8";
-            loadTask->result.charset = ultralight::Convert(charset);
+            loadTask->result.charset = "utf-8"_s;
           }
         }
         fs->CloseFile(file);
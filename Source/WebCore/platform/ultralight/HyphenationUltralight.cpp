@@ -1,20 +1,414 @@
 #include "config.h"
 #include "Hyphenation.h"
+
+#include <Ultralight/platform/Platform.h>
+#include <Ultralight/platform/FileSystem.h>
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
+#include <wtf/HashMap.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
+#include <wtf/text/AtomStringHash.h>
+#include <wtf/text/StringBuilder.h>
+#include <wtf/text/StringConcatenate.h>
+#include <wtf/text/StringHash.h>
 #include <wtf/text/StringView.h>
-#include "NotImplemented.h"
+#include "StringUltralight.h"
+
+// Liang (TeX) hyphenation for the Ultralight port.
+//
+// Dictionaries are looked up lazily per locale through the Ultralight FileSystem under
+// "resources/hyphenation/". Two formats are accepted:
+//
+//   hyph_<locale>.hyb  A packed trie image (see PackedHeader below). It contains no pointers,
+//                      so the bytes read from disk are used in place without any fix-up.
+//   hyph_<locale>.dic  A libhyphen / TeX pattern file, compiled into the same packed image
+//                      on first use.
+//
+// Dictionaries are shared by every view and each keeps a small memo of recently hyphenated
+// words, since the line breaker asks about the same word repeatedly with a shrinking limit.
 
 namespace WebCore {
 
+static const uint32_t packedMagic = 0x50484c55; // 'ULHP'
+static const uint32_t packedVersion = 1;
+static const unsigned defaultLeftHyphenMin = 2;
+static const unsigned defaultRightHyphenMin = 2;
+static const unsigned maxWordLength = 64;
+static const unsigned maxMemoizedWords = 2048;
+
+struct PackedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+    uint32_t valuesSize;
+    uint8_t leftHyphenMin;
+    uint8_t rightHyphenMin;
+    uint8_t padding[2];
+};
+
+// Node 0 is the root. Edges of a node are contiguous and sorted by character so they can be
+// binary searched. A node with a non-zero valuesLength terminates a pattern whose inter-letter
+// values start at valuesOffset.
+struct PackedNode {
+    uint32_t firstEdge;
+    uint32_t edgeCount;
+    uint32_t valuesOffset;
+    uint32_t valuesLength;
+};
+
+struct PackedEdge {
+    uint32_t character;
+    uint32_t child;
+};
+
+static_assert(!(sizeof(PackedHeader) % 4) && sizeof(PackedNode) == 16 && sizeof(PackedEdge) == 8, "Packed hyphenation structs must have a fixed layout");
+
+class PatternCompiler {
+public:
+    void addPattern(const Vector<UChar>& letters, const Vector<uint8_t>& values)
+    {
+        ASSERT(values.size() == letters.size() + 1);
+        unsigned node = 0;
+        for (UChar letter : letters) {
+            auto result = m_nodes[node].children.add(letter, m_nodes.size());
+            node = result.iterator->value;
+            if (result.isNewEntry)
+                m_nodes.append({ });
+        }
+        m_nodes[node].values = values;
+    }
+
+    Vector<uint8_t> pack(unsigned leftHyphenMin, unsigned rightHyphenMin) const
+    {
+        Vector<PackedNode> nodes(m_nodes.size());
+        Vector<PackedEdge> edges;
+        Vector<uint8_t> values;
+        for (unsigned i = 0; i < m_nodes.size(); ++i) {
+            const auto& node = m_nodes[i];
+            nodes[i].firstEdge = edges.size();
+            nodes[i].edgeCount = node.children.size();
+            for (auto& child : node.children)
+                edges.append({ child.key, child.value });
+            std::sort(edges.begin() + nodes[i].firstEdge, edges.end(), [](const PackedEdge& a, const PackedEdge& b) {
+                return a.character < b.character;
+            });
+            nodes[i].valuesOffset = values.size();
+            nodes[i].valuesLength = node.values.size();
+            values.appendVector(node.values);
+        }
+
+        PackedHeader header { packedMagic, packedVersion, static_cast<uint32_t>(nodes.size()), static_cast<uint32_t>(edges.size()), static_cast<uint32_t>(values.size()),
+            static_cast<uint8_t>(leftHyphenMin), static_cast<uint8_t>(rightHyphenMin), { 0, 0 } };
+
+        Vector<uint8_t> image;
+        image.append(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+        image.append(reinterpret_cast<const uint8_t*>(nodes.data()), nodes.size() * sizeof(PackedNode));
+        image.append(reinterpret_cast<const uint8_t*>(edges.data()), edges.size() * sizeof(PackedEdge));
+        image.appendVector(values);
+        return image;
+    }
+
+private:
+    struct Node {
+        HashMap<UChar, unsigned, WTF::IntHash<UChar>, WTF::UnsignedWithZeroKeyHashTraits<UChar>> children;
+        Vector<uint8_t> values;
+    };
+
+    Vector<Node> m_nodes { 1 };
+};
+
+static unsigned parseHyphenMin(const String& line, unsigned defaultValue)
+{
+    bool ok = false;
+    unsigned value = line.substring(line.find(' ') + 1).stripWhiteSpace().toUIntStrict(&ok);
+    return ok ? value : defaultValue;
+}
+
+// Parses a libhyphen / TeX pattern file such as "hyph_en_US.dic". The first line names the
+// character encoding, the rest are patterns like ".ach4" or "a1bi". libhyphen extensions for
+// non-standard hyphenation ("/" replacements) and compound levels are ignored.
+static Vector<uint8_t> compilePatternFile(const Vector<char>& data)
+{
+    String text;
+    size_t firstLineEnd = data.find('\n');
+    String encoding = String(data.data(), firstLineEnd == notFound ? data.size() : firstLineEnd).stripWhiteSpace();
+    if (equalLettersIgnoringASCIICase(encoding, "utf-8"))
+        text = String::fromUTF8(data.data(), data.size());
+    else
+        text = String(data.data(), data.size());
+    if (text.isNull())
+        return { };
+
+    PatternCompiler compiler;
+    unsigned leftHyphenMin = defaultLeftHyphenMin;
+    unsigned rightHyphenMin = defaultRightHyphenMin;
+    Vector<String> lines = text.split('\n');
+    for (size_t i = 1; i < lines.size(); ++i) {
+        String line = lines[i].stripWhiteSpace();
+        if (line.isEmpty() || line[0] == '%' || line.contains('/'))
+            continue;
+        if (line.startsWith("LEFTHYPHENMIN")) {
+            leftHyphenMin = parseHyphenMin(line, leftHyphenMin);
+            continue;
+        }
+        if (line.startsWith("RIGHTHYPHENMIN")) {
+            rightHyphenMin = parseHyphenMin(line, rightHyphenMin);
+            continue;
+        }
+        if (line.startsWith("COMPOUND") || line.startsWith("NOHYPHEN") || line == "NEXTLEVEL")
+            continue;
+
+        Vector<UChar> letters;
+        Vector<uint8_t> values(1, 0);
+        for (unsigned j = 0; j < line.length(); ++j) {
+            UChar c = line[j];
+            if (isASCIIDigit(c))
+                values.last() = c - '0';
+            else {
+                letters.append(u_tolower(c));
+                values.append(0);
+            }
+        }
+        if (!letters.isEmpty())
+            compiler.addPattern(letters, values);
+    }
+
+    return compiler.pack(leftHyphenMin, rightHyphenMin);
+}
+
+static bool readFile(const String& path, Vector<char>& data)
+{
+    auto fs = ultralight::Platform::instance().file_system();
+    if (!fs)
+        return false;
+
+    ultralight::String16 path16 = ultralight::Convert(path);
+    if (!fs->FileExists(path16))
+        return false;
+
+    ultralight::FileHandle handle = fs->OpenFile(path16, false);
+    if (handle == ultralight::invalidFileHandle)
+        return false;
+
+    int64_t fileSize = 0;
+    bool success = fs->GetFileSize(handle, fileSize) && fileSize > 0;
+    if (success) {
+        data.grow(fileSize);
+        success = fs->ReadFromFile(handle, data.data(), fileSize) == fileSize;
+    }
+    fs->CloseFile(handle);
+    return success;
+}
+
+class HyphenationDictionary : public RefCounted<HyphenationDictionary> {
+    WTF_MAKE_NONCOPYABLE(HyphenationDictionary);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    static RefPtr<HyphenationDictionary> create(Vector<uint8_t>&& image)
+    {
+        auto dictionary = adoptRef(*new HyphenationDictionary(WTFMove(image)));
+        if (!dictionary->validate())
+            return nullptr;
+        return dictionary;
+    }
+
+    // Returns the offsets within |word| (already lowercased) before which a hyphen may be placed.
+    const Vector<uint8_t>& hyphenationPoints(const String& word)
+    {
+        auto it = m_memo.find(word);
+        if (it != m_memo.end())
+            return it->value;
+
+        if (m_memo.size() >= maxMemoizedWords)
+            m_memo.clear();
+
+        return m_memo.add(word, computeHyphenationPoints(word)).iterator->value;
+    }
+
+private:
+    explicit HyphenationDictionary(Vector<uint8_t>&& image)
+        : m_image(WTFMove(image))
+    {
+    }
+
+    const PackedHeader& header() const { return *reinterpret_cast<const PackedHeader*>(m_image.data()); }
+    const PackedNode* nodes() const { return reinterpret_cast<const PackedNode*>(m_image.data() + sizeof(PackedHeader)); }
+    const PackedEdge* edges() const { return reinterpret_cast<const PackedEdge*>(nodes() + header().nodeCount); }
+    const uint8_t* values() const { return reinterpret_cast<const uint8_t*>(edges() + header().edgeCount); }
+
+    // Bounds-check the image once so lookups can trust it.
+    bool validate() const
+    {
+        if (m_image.size() < sizeof(PackedHeader))
+            return false;
+
+        auto& header = this->header();
+        if (header.magic != packedMagic || header.version != packedVersion || !header.nodeCount)
+            return false;
+
+        uint64_t expectedSize = sizeof(PackedHeader) + static_cast<uint64_t>(header.nodeCount) * sizeof(PackedNode)
+            + static_cast<uint64_t>(header.edgeCount) * sizeof(PackedEdge) + header.valuesSize;
+        if (m_image.size() != expectedSize)
+            return false;
+
+        for (uint32_t i = 0; i < header.nodeCount; ++i) {
+            auto& node = nodes()[i];
+            if (static_cast<uint64_t>(node.firstEdge) + node.edgeCount > header.edgeCount
+                || static_cast<uint64_t>(node.valuesOffset) + node.valuesLength > header.valuesSize)
+                return false;
+        }
+        for (uint32_t i = 0; i < header.edgeCount; ++i) {
+            if (edges()[i].child >= header.nodeCount)
+                return false;
+        }
+        return true;
+    }
+
+    const PackedNode* child(const PackedNode& node, UChar character) const
+    {
+        auto* begin = edges() + node.firstEdge;
+        auto* end = begin + node.edgeCount;
+        auto* edge = std::lower_bound(begin, end, character, [](const PackedEdge& edge, UChar character) {
+            return edge.character < character;
+        });
+        if (edge == end || edge->character != character)
+            return nullptr;
+        return nodes() + edge->child;
+    }
+
+    Vector<uint8_t> computeHyphenationPoints(const String& word) const
+    {
+        unsigned leftHyphenMin = std::max<unsigned>(header().leftHyphenMin, 1);
+        unsigned rightHyphenMin = std::max<unsigned>(header().rightHyphenMin, 1);
+        if (word.length() < leftHyphenMin + rightHyphenMin)
+            return { };
+
+        // Liang's algorithm over ".word.", scores[k] is the value of the gap before dotted[k].
+        Vector<UChar, maxWordLength + 2> dotted;
+        dotted.append('.');
+        for (unsigned i = 0; i < word.length(); ++i)
+            dotted.append(word[i]);
+        dotted.append('.');
+
+        Vector<uint8_t, maxWordLength + 3> scores(dotted.size() + 1, 0);
+        for (unsigned start = 0; start < dotted.size(); ++start) {
+            const PackedNode* node = nodes();
+            for (unsigned i = start; i < dotted.size(); ++i) {
+                node = child(*node, dotted[i]);
+                if (!node)
+                    break;
+                const uint8_t* patternValues = values() + node->valuesOffset;
+                for (unsigned k = 0; k < node->valuesLength && start + k < scores.size(); ++k)
+                    scores[start + k] = std::max(scores[start + k], patternValues[k]);
+            }
+        }
+
+        // A break before word[m] is the gap before dotted[m + 1].
+        Vector<uint8_t> points;
+        for (unsigned m = leftHyphenMin; m + rightHyphenMin <= word.length(); ++m) {
+            if (scores[m + 1] & 1)
+                points.append(m);
+        }
+        return points;
+    }
+
+    Vector<uint8_t> m_image;
+    HashMap<String, Vector<uint8_t>> m_memo;
+};
+
+static RefPtr<HyphenationDictionary> loadDictionary(const String& fileLocale)
+{
+    String basePath = makeString("resources/hyphenation/hyph_", fileLocale);
+
+    Vector<char> data;
+    if (readFile(basePath + ".hyb", data)) {
+        Vector<uint8_t> image;
+        image.append(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        return HyphenationDictionary::create(WTFMove(image));
+    }
+
+    if (readFile(basePath + ".dic", data))
+        return HyphenationDictionary::create(compilePatternFile(data));
+
+    return nullptr;
+}
+
+// Dictionary files follow the libhyphen naming scheme ("hyph_en_US.dic"), so for "en-US" we
+// try "en_US", then "en_us", then just the language "en".
+static Vector<String> fileLocaleCandidates(const AtomString& localeIdentifier)
+{
+    String locale = localeIdentifier.string();
+    locale.replace('-', '_');
+
+    Vector<String> candidates;
+    candidates.append(locale);
+    String lowercase = locale.convertToASCIILowercase();
+    if (lowercase != locale)
+        candidates.append(lowercase);
+    size_t divider = lowercase.find('_');
+    if (divider != notFound)
+        candidates.append(lowercase.left(divider));
+    return candidates;
+}
+
+static HashMap<AtomString, RefPtr<HyphenationDictionary>>& dictionaryCache()
+{
+    static NeverDestroyed<HashMap<AtomString, RefPtr<HyphenationDictionary>>> cache;
+    return cache;
+}
+
+static HyphenationDictionary* dictionaryForLocale(const AtomString& localeIdentifier)
+{
+    if (localeIdentifier.isEmpty())
+        return nullptr;
+
+    // Missing locales are cached as null so we only touch the FileSystem once per locale.
+    auto result = dictionaryCache().add(localeIdentifier, nullptr);
+    if (result.isNewEntry) {
+        for (auto& candidate : fileLocaleCandidates(localeIdentifier)) {
+            if ((result.iterator->value = loadDictionary(candidate)))
+                break;
+        }
+    }
+    return result.iterator->value.get();
+}
+
 bool canHyphenate(const AtomString& localeIdentifier)
 {
-  notImplemented();
-  return false;
+    return dictionaryForLocale(localeIdentifier);
 }
 
 size_t lastHyphenLocation(StringView text, size_t beforeIndex, const AtomString& localeIdentifier)
 {
-  notImplemented();
-  return 0;
+    auto* dictionary = dictionaryForLocale(localeIdentifier);
+    if (!dictionary)
+        return 0;
+
+    // WebCore passes text like " word," so hyphenate only the run of letters inside it.
+    unsigned wordStart = 0;
+    while (wordStart < text.length() && !u_isalpha(text[wordStart]))
+        ++wordStart;
+    unsigned wordEnd = wordStart;
+    while (wordEnd < text.length() && u_isalpha(text[wordEnd]))
+        ++wordEnd;
+    if (wordEnd == wordStart || wordEnd - wordStart > maxWordLength || beforeIndex <= wordStart)
+        return 0;
+
+    StringBuilder word;
+    word.reserveCapacity(wordEnd - wordStart);
+    for (unsigned i = wordStart; i < wordEnd; ++i)
+        word.append(static_cast<UChar>(u_tolower(text[i])));
+
+    auto& points = dictionary->hyphenationPoints(word.toString());
+    for (size_t i = points.size(); i--;) {
+        size_t location = wordStart + points[i];
+        if (location < beforeIndex)
+            return location;
+    }
+    return 0;
 }
 
-} // namespace WebCore
\ No newline at end of file
+} // namespace WebCore
@@ -0,0 +1,51 @@
+#include "config.h"
+#include "LowPowerModeNotifier.h"
+
+#include <wtf/HashSet.h>
+#include <wtf/MainThread.h>
+#include <wtf/NeverDestroyed.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+static bool lowPowerModeEnabled;
+
+static HashSet<LowPowerModeNotifier*>& notifiers()
+{
+  static NeverDestroyed<HashSet<LowPowerModeNotifier*>> notifiers;
+  return notifiers;
+}
+
+LowPowerModeNotifier::LowPowerModeNotifier(LowPowerModeChangeCallback&& callback)
+    : m_callback(WTFMove(callback))
+{
+  ASSERT(isMainThread());
+  notifiers().add(this);
+}
+
+LowPowerModeNotifier::~LowPowerModeNotifier()
+{
+  notifiers().remove(this);
+}
+
+bool LowPowerModeNotifier::isLowPowerModeEnabled() const
+{
+  return lowPowerModeEnabled;
+}
+
+void LowPowerModeNotifier::setLowPowerModeEnabled(bool enabled)
+{
+  ASSERT(isMainThread());
+  if (lowPowerModeEnabled == enabled)
+    return;
+
+  lowPowerModeEnabled = enabled;
+
+  // Callbacks reach back into their Page, copy in case one of them goes away.
+  for (auto* notifier : copyToVector(notifiers())) {
+    if (notifiers().contains(notifier))
+      notifier->m_callback(enabled);
+  }
+}
+
+} // namespace WebCore
@@ -1,14 +1,28 @@
 #include "config.h"
 #include "MemoryUtils.h"
+#include "MemoryCache.h"
+#include "PlatformFontFreeType.h"
 #include "ResourceUsageThread.h"
 #include <wtf/MemoryPressureHandler.h>
 #include <Ultralight/private/util/Debug.h>
 #include <sstream>
 #include <string>
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+#include "BitmapTextureUltralight.h"
+#endif
 #if !OS(DARWIN)
 #include "CommonVM.h"
+#include <JavaScriptCore/ExecutableAllocator.h>
 #include <JavaScriptCore/VM.h>
 #endif
+#if !OS(DARWIN) && !USE(SYSTEM_MALLOC)
+#include <bmalloc/bmalloc.h>
+#include <wtf/Gigacage.h>
+#endif
+#if OS(LINUX)
+#include <malloc.h>
+#include <wtf/linux/CurrentProcessMemoryStatus.h>
+#endif
 
 namespace WebCore {
 
@@ -47,26 +61,72 @@ MemoryUtils::~MemoryUtils() {
 #endif
 }
 
+MemoryStatistics MemoryUtils::memoryStatistics() {
+  MemoryStatistics stats;
+#if OS(DARWIN)
+  // Darwin can attribute most categories precisely by tagging VM pages.
+  stats.javaScriptHeap = gData.categories[MemoryCategory::GCHeap].totalSize() + gData.categories[MemoryCategory::GCOwned].totalSize();
+  stats.javaScriptJIT = gData.categories[MemoryCategory::JSJIT].totalSize();
+  stats.images = gData.categories[MemoryCategory::Images].totalSize();
+  stats.layers = gData.categories[MemoryCategory::Layers].totalSize();
+  stats.bmalloc = gData.categories[MemoryCategory::bmalloc].totalSize();
+  stats.gigacage = gData.categories[MemoryCategory::Gigacage].totalSize();
+  stats.libcMalloc = gData.categories[MemoryCategory::LibcMalloc].totalSize();
+  stats.totalDirty = gData.totalDirtySize;
+#else
+  JSC::VM* vm = &commonVM();
+  stats.javaScriptHeap = vm->heap.blockBytesAllocated() + vm->heap.extraMemorySize();
+#if ENABLE(JIT)
+  stats.javaScriptJIT = JSC::ExecutableAllocator::committedByteCount();
+#endif
+  stats.images = MemoryCache::singleton().getStatistics().images.decodedSize;
+#if USE(TEXTURE_MAPPER_ULTRALIGHT)
+  stats.layers = BitmapTextureUltralight::totalBackingStoreBytes();
+#endif
+
+#if !USE(SYSTEM_MALLOC)
+  stats.bmalloc = bmalloc::api::heapFootprint(bmalloc::HeapKind::Primary);
+  for (auto kind : { Gigacage::Primitive, Gigacage::JSValue }) {
+    if (Gigacage::isEnabled(kind))
+      stats.gigacage += bmalloc::api::heapFootprint(bmalloc::heapKind(kind));
+  }
+#endif
+
+#if OS(LINUX)
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+#elif defined(__GLIBC__)
+  struct mallinfo info = mallinfo();
+#endif
+#if defined(__GLIBC__)
+  stats.libcMalloc = static_cast<size_t>(info.uordblks) + static_cast<size_t>(info.hblkhd);
+#endif
+
+  ProcessMemoryStatus memoryStatus;
+  currentProcessMemoryStatus(memoryStatus);
+  stats.totalDirty = memoryStatus.resident - memoryStatus.shared;
+#endif
+#endif
+  stats.fonts = ultralight::FontFaceMemoryUsage();
+  return stats;
+}
+
 #define PRINT_STATS(str, obj) \
   stream << str << fmtBytes(obj) << std::endl;
 
 void MemoryUtils::logMemoryStatistics() {
+  MemoryStatistics stats = memoryStatistics();
   std::ostringstream stream;
   stream << "Memory Usage (WebCore): " << std::endl;
-#if OS(DARWIN)
-  PRINT_STATS("    JavaScript:          ", gData.categories[MemoryCategory::GCHeap].totalSize() + gData.categories[MemoryCategory::GCOwned].totalSize());
-  // These statistics are only available on macOS at this time because of the ability to tag memory pages
-  PRINT_STATS("    JavaScript JIT:      ", gData.categories[MemoryCategory::JSJIT].totalSize());
-  PRINT_STATS("    Images:              ", gData.categories[MemoryCategory::Images].totalSize());
-  PRINT_STATS("    Layers:              ", gData.categories[MemoryCategory::Layers].totalSize());
-  PRINT_STATS("    Page:                ", gData.categories[MemoryCategory::bmalloc].totalSize() + gData.categories[MemoryCategory::LibcMalloc].totalSize());
-  //PRINT_STATS("    Other:               ", Other);
-#else
-  JSC::VM* vm = &commonVM();
-  size_t currentGCHeapCapacity = vm->heap.blockBytesAllocated();
-  size_t currentGCOwnedExtra = vm->heap.extraMemorySize();
-  PRINT_STATS("    JavaScript:          ", currentGCHeapCapacity + currentGCOwnedExtra);
-#endif
+  PRINT_STATS("    JavaScript:          ", stats.javaScriptHeap);
+  PRINT_STATS("    JavaScript JIT:      ", stats.javaScriptJIT);
+  PRINT_STATS("    Images:              ", stats.images);
+  PRINT_STATS("    Layers:              ", stats.layers);
+  PRINT_STATS("    Fonts:               ", stats.fonts);
+  PRINT_STATS("    bmalloc:             ", stats.bmalloc);
+  PRINT_STATS("    Gigacage:            ", stats.gigacage);
+  PRINT_STATS("    libc malloc:         ", stats.libcMalloc);
+  PRINT_STATS("    Total dirty:         ", stats.totalDirty);
   UL_LOG_INFO(stream.str().c_str());
 }
 
@@ -1,12 +1,31 @@
 #pragma once
 
+#include <stddef.h>
+
 namespace WebCore {
 
+// Memory use by category, in bytes. Categories that can't be measured on the
+// current platform are left at zero.
+struct MemoryStatistics {
+  size_t javaScriptHeap = 0;      // GC heap plus memory owned by GC objects
+  size_t javaScriptJIT = 0;       // Committed executable memory
+  size_t images = 0;              // Decoded image data in the memory cache
+  size_t layers = 0;              // Compositing layer backing stores
+  size_t fonts = 0;               // Font data of loaded font faces
+  size_t bmalloc = 0;             // bmalloc primary heap
+  size_t gigacage = 0;            // bmalloc Gigacage heaps
+  size_t libcMalloc = 0;          // System malloc
+  size_t totalDirty = 0;          // Resident, non-shared memory of the process
+};
+
 class WEBCORE_EXPORT MemoryUtils {
 public:
   MemoryUtils();
   ~MemoryUtils();
 
+  // Must be called on the main thread.
+  MemoryStatistics memoryStatistics();
+
   void logMemoryStatistics();
 
   void beginSimulatedMemoryPressure();
@@ -30,6 +30,16 @@ static const float ControlBaseHeight = 17;
 #endif
 static const float ControlBaseFontSize = 11;
 
+// Native controls draw straight into the canvas, which recording contexts don't have.
+static bool canPaintToCanvas(const PaintInfo& paintInfo)
+{
+    if (paintInfo.context().platformContext())
+        return true;
+
+    paintInfo.context().didSkipUnrecordableDrawing();
+    return false;
+}
+
 class RenderThemeUltralight : public RenderTheme {
 protected:
     bool m_mediaControlsStyleSheetLoaded = false;
@@ -324,6 +334,8 @@ public:
     {
         bool checked = isChecked(box);
         bool indeterminate = isIndeterminate(box);
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
         GraphicsContextStateSaver stateSaver(paintInfo.context());
@@ -413,6 +425,8 @@ public:
     virtual bool paintRadioDecorations(const RenderObject& box, const PaintInfo& paintInfo, const IntRect& rect) override
     {
         GraphicsContextStateSaver stateSaver(paintInfo.context());
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
 
@@ -530,6 +544,8 @@ public:
     virtual bool paintMenuListButtonDecorations(const RenderBox& box, const PaintInfo& paintInfo, const FloatRect& rect) override
     {
 
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
 
@@ -683,6 +699,8 @@ public:
         GraphicsContextStateSaver stateSaver(paintInfo.context());
         FloatRect clip = addRoundedBorderClip(box, paintInfo.context(), rect);
 
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
         bool flip = isPressed(box);
@@ -736,6 +754,8 @@ public:
 
         //paintInfo.context().clipRoundedRect(style.getRoundedBorderFor(LayoutRect(rect)).pixelSnappedRoundedRectForPainting(box.document().deviceScaleFactor()));
         FloatRect clip = addRoundedBorderClip(box, paintInfo.context(), IntRect(rect));
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
 
@@ -797,6 +817,8 @@ public:
         const int progressBarHeight = 9;
         const float verticalOffset = (rect.height() - progressBarHeight) / 2.0;
 
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* ctx = paintInfo.context().platformContext();
         PlatformCanvas canvas = ctx->canvas();
 
@@ -867,6 +889,8 @@ public:
         IntRect trackClip = rect;
         auto& style = box.style();
 
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
 
@@ -963,6 +987,8 @@ public:
         GraphicsContextStateSaver stateSaver(paintInfo.context());
         FloatRect clip = addRoundedBorderClip(box, paintInfo.context(), rect);
 
+        if (!canPaintToCanvas(paintInfo))
+            return false;
         PlatformGraphicsContext* context = paintInfo.context().platformContext();
         PlatformCanvas canvas = context->canvas();
 
@@ -4,6 +4,7 @@
 #include <Ultralight/platform/Config.h>
 #include <Ultralight/platform/Platform.h>
 #include <Ultralight/private/util/Debug.h>
+#include <wtf/text/StringConcatenate.h>
 
 namespace WebCore {
 namespace ResourceLoader {
@@ -11,7 +12,7 @@ namespace ResourceLoader {
     ultralight::FileHandle openFile(const String& filePath)
     {
         ultralight::FileSystem* fs = ultralight::Platform::instance().file_system();
-        ultralight::String16 filePath16 = "resources/" + ultralight::Convert(filePath);
+        ultralight::String16 filePath16 = ultralight::Convert(makeString("resources/", filePath));
 
         if (!fs) {
             ultralight::String16 err_msg = "Could not load resource: " + filePath16 + ", no FileSystem instance set, make sure that you've called ultralight::Platform::instance().set_file_system().";
@@ -47,18 +48,20 @@ namespace ResourceLoader {
             return String();
 
         int64_t fileSize = 0;
-        Vector<char> buffer;
+        String result;
+        LChar* characters;
 
-        if (!fs->GetFileSize(handle, fileSize) || fileSize == 0)
+        if (!fs->GetFileSize(handle, fileSize) || fileSize <= 0 || fileSize > String::MaxLength)
             goto FAIL_LOAD;
 
-        buffer.resize(fileSize);
-        if (fs->ReadFromFile(handle, buffer.data(), fileSize) != fileSize)
+        // Read straight into the string's buffer rather than copying from a temporary one.
+        result = String::createUninitialized(static_cast<unsigned>(fileSize), characters);
+        if (fs->ReadFromFile(handle, reinterpret_cast<char*>(characters), fileSize) != fileSize)
             goto FAIL_LOAD;
 
         fs->CloseFile(handle);
 
-        return String(buffer.data(), static_cast<size_t>(fileSize));
+        return result;
 
     FAIL_LOAD:
         if (fs && handle != ultralight::invalidFileHandle)
@@ -1,23 +1,45 @@
 #pragma once
 #include <Ultralight/String16.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringView.h>
 #include <wtf/text/WTFString.h>
 //#include <wtf/unicode/UTF8.h>
 #include <wtf/text/ASCIIFastPath.h>
 
 namespace ultralight {
 
+static_assert(sizeof(Char16) == sizeof(UChar), "ultralight::Char16 must be layout-compatible with UChar");
+
 inline WTF::String Convert(const ultralight::String16& str) {
   return WTF::String(reinterpret_cast<const UChar*>(str.data()), str.length());
 }
 
-inline ultralight::String16 Convert(const WTF::String& str) {
+// Returns a non-owning view of |str|, valid only while |str| is alive and unmodified.
+inline WTF::StringView ConvertToStringView(const ultralight::String16& str) {
+  if (str.empty())
+    return WTF::StringView();
+
+  return WTF::StringView(reinterpret_cast<const UChar*>(str.data()), str.length());
+}
+
+inline ultralight::String16 Convert(const WTF::StringView& str) {
   if (str.isEmpty())
     return ultralight::String16();
 
-  if (str.is8Bit())
-    return ultralight::String16(reinterpret_cast<const char*>(str.characters8()), str.length());
+  if (!str.is8Bit())
+    return ultralight::String16(reinterpret_cast<const Char16*>(str.characters16()), str.length());
+
+  // The const char* constructor of String16 only handles ASCII, widen Latin-1 ourselves.
+  // Most strings crossing the boundary are short (paths, MIME types) so this rarely
+  // touches the heap.
+  Vector<UChar, 256> buffer;
+  buffer.grow(str.length());
+  WTF::copyUCharsFromLCharSource(buffer.data(), str.characters8(), str.length());
+  return ultralight::String16(reinterpret_cast<const Char16*>(buffer.data()), buffer.size());
+}
 
-  return ultralight::String16(reinterpret_cast<const Char16*>(str.characters16()), str.length());
+inline ultralight::String16 Convert(const WTF::String& str) {
+  return Convert(WTF::StringView(str));
 }
 
 }  // namespace ultralight
@@ -1,47 +1,338 @@
 #include "config.h"
 #include "UTFUltralight.h"
 #include <unicode/ustring.h>
+#include <unicode/utf16.h>
+#include <wtf/MathExtras.h>
+#include <wtf/text/ASCIIFastPath.h>
+
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#endif
+
+// These transcoders run in a single pass. When |dest| is NULL they only count, which gives
+// the exact length the second call will need. Invalid input is replaced with U+FFFD using
+// the same "maximal subpart" policy as ICU's u_str*WithSub family, which they replace.
+
+namespace {
+
+const char32_t replacementCharacter = 0xFFFD;
+
+inline bool isContinuationByte(uint8_t b, uint8_t lower = 0x80, uint8_t upper = 0xBF)
+{
+    return b >= lower && b <= upper;
+}
+
+inline int32_t lengthOf(const char* src)
+{
+    return static_cast<int32_t>(strlen(src));
+}
+
+inline int32_t lengthOf(const char16_t* src)
+{
+    return u_strlen(reinterpret_cast<const UChar*>(src));
+}
+
+inline int32_t lengthOf(const char32_t* src)
+{
+    int32_t length = 0;
+    while (src[length])
+        ++length;
+    return length;
+}
+
+// Writes |value| unless we are only counting. Returns false if |dest| is full.
+template<typename CharType>
+inline bool append(CharType* dest, int32_t destLen, int32_t& resultLen, CharType value)
+{
+    if (dest) {
+        if (resultLen >= destLen)
+            return false;
+        dest[resultLen] = value;
+    }
+    ++resultLen;
+    return true;
+}
+
+inline bool appendUTF16(char16_t* dest, int32_t destLen, int32_t& resultLen, char32_t c)
+{
+    if (c < 0x10000)
+        return append<char16_t>(dest, destLen, resultLen, static_cast<char16_t>(c));
+
+    return append<char16_t>(dest, destLen, resultLen, static_cast<char16_t>(U16_LEAD(c)))
+        && append<char16_t>(dest, destLen, resultLen, static_cast<char16_t>(U16_TRAIL(c)));
+}
+
+inline bool appendUTF8(char* dest, int32_t destLen, int32_t& resultLen, char32_t c)
+{
+    int32_t length = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+    if (dest && resultLen + length > destLen)
+        return false;
+
+    if (dest) {
+        char* out = dest + resultLen;
+        switch (length) {
+        case 1:
+            out[0] = static_cast<char>(c);
+            break;
+        case 2:
+            out[0] = static_cast<char>(0xC0 | (c >> 6));
+            out[1] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        case 3:
+            out[0] = static_cast<char>(0xE0 | (c >> 12));
+            out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        default:
+            out[0] = static_cast<char>(0xF0 | (c >> 18));
+            out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[3] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        }
+    }
+    resultLen += length;
+    return true;
+}
+
+// Returns the length of the all-ASCII prefix of src[0, srcLen).
+inline int32_t asciiPrefixLength(const uint8_t* src, int32_t srcLen)
+{
+    int32_t i = 0;
+#if CPU(X86_SSE2)
+    for (; i + 16 <= srcLen; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        int mask = _mm_movemask_epi8(chunk);
+        if (mask)
+            return i + ctz(static_cast<uint32_t>(mask));
+    }
+#else
+    for (; i + static_cast<int32_t>(sizeof(WTF::MachineWord)) <= srcLen; i += sizeof(WTF::MachineWord)) {
+        WTF::MachineWord word;
+        memcpy(&word, src + i, sizeof(word));
+        if (!WTF::isAllASCII<LChar>(word))
+            break;
+    }
+#endif
+    while (i < srcLen && src[i] < 0x80)
+        ++i;
+    return i;
+}
+
+inline int32_t asciiPrefixLength(const char16_t* src, int32_t srcLen)
+{
+    int32_t i = 0;
+#if CPU(X86_SSE2)
+    const __m128i nonASCIIMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 8 <= srcLen; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, nonASCIIMask), _mm_setzero_si128())) != 0xFFFF)
+            break;
+    }
+#endif
+    while (i < srcLen && src[i] < 0x80)
+        ++i;
+    return i;
+}
+
+// Decodes one UTF-8 sequence starting at src[i], advancing |i| past it. Ill-formed sequences
+// consume their maximal valid subpart (at least one byte) and decode to U+FFFD.
+inline char32_t decodeUTF8(const uint8_t* src, int32_t srcLen, int32_t& i)
+{
+    uint8_t lead = src[i++];
+    if (lead < 0x80)
+        return lead;
+
+    int32_t trailing;
+    uint8_t lower = 0x80;
+    uint8_t upper = 0xBF;
+    char32_t c;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        trailing = 1;
+        c = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        trailing = 2;
+        c = lead & 0x0F;
+        if (lead == 0xE0)
+            lower = 0xA0;
+        else if (lead == 0xED)
+            upper = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        trailing = 3;
+        c = lead & 0x07;
+        if (lead == 0xF0)
+            lower = 0x90;
+        else if (lead == 0xF4)
+            upper = 0x8F;
+    } else
+        return replacementCharacter;
+
+    for (int32_t n = 0; n < trailing; ++n) {
+        if (i >= srcLen || !isContinuationByte(src[i], lower, upper))
+            return replacementCharacter;
+        c = (c << 6) | (src[i++] & 0x3F);
+        lower = 0x80;
+        upper = 0xBF;
+    }
+    return c;
+}
+
+// Decodes one UTF-16 code point starting at src[i], advancing |i| past it. Unpaired
+// surrogates decode to U+FFFD.
+inline char32_t decodeUTF16(const char16_t* src, int32_t srcLen, int32_t& i)
+{
+    char16_t c = src[i++];
+    if (!U16_IS_SURROGATE(c))
+        return c;
+
+    if (U16_IS_SURROGATE_LEAD(c) && i < srcLen && U16_IS_TRAIL(src[i]))
+        return U16_GET_SUPPLEMENTARY(c, src[i++]);
+
+    return replacementCharacter;
+}
+
+// Mirrors the previous ICU-based behavior: success or a sizing call returns the length,
+// anything else returns 0. A terminating NUL is written when there is room for it.
+template<typename CharType>
+inline int32_t finish(CharType* dest, int32_t destLen, int32_t resultLen)
+{
+    if (dest && resultLen < destLen)
+        dest[resultLen] = 0;
+    return resultLen;
+}
+
+#if !ASSERT_DISABLED
+template<typename Function>
+void assertMatchesICU(int32_t resultLen, Function icuConvert)
+{
+    int32_t icuLen = 0;
+    UErrorCode error = U_ZERO_ERROR;
+    icuConvert(&icuLen, &error);
+    ASSERT(error == U_BUFFER_OVERFLOW_ERROR || U_SUCCESS(error));
+    ASSERT(resultLen == icuLen);
+}
+#endif
+
+} // namespace
 
 int32_t ConvertUTF16ToUTF32(char32_t* dest, int32_t destLen, const char16_t* src, int32_t srcLen) {
+  if (srcLen < 0)
+    srcLen = lengthOf(src);
+
   int32_t resultLen = 0;
-  UErrorCode error = U_ZERO_ERROR;
-  
-  // Substitute invalid sequences with Unicode Replacement Character (U+FFFD)
-  u_strToUTF32WithSub((UChar32*)dest, destLen, &resultLen, (const UChar*)src, srcLen, 0xFFFD, 0, &error);
-  
-  // Ignore Buffer Overflow Error if we are determining size (destLen == 0)
-  return (U_SUCCESS(error) || (error == U_BUFFER_OVERFLOW_ERROR && !destLen)) ? resultLen : 0;
+  int32_t i = 0;
+  while (i < srcLen) {
+    // ASCII fast path
+    int32_t asciiEnd = i + asciiPrefixLength(src + i, srcLen - i);
+    if (dest && resultLen + (asciiEnd - i) > destLen)
+      return 0;
+    for (; i < asciiEnd; ++i, ++resultLen) {
+      if (dest)
+        dest[resultLen] = src[i];
+    }
+    if (i == srcLen)
+      break;
+
+    if (!append<char32_t>(dest, destLen, resultLen, decodeUTF16(src, srcLen, i)))
+      return 0;
+  }
+
+#if !ASSERT_DISABLED
+  assertMatchesICU(resultLen, [&](int32_t* icuLen, UErrorCode* error) {
+    u_strToUTF32WithSub(nullptr, 0, icuLen, (const UChar*)src, srcLen, 0xFFFD, 0, error);
+  });
+#endif
+
+  return finish(dest, destLen, resultLen);
 }
 
 int32_t ConvertUTF32ToUTF16(char16_t* dest, int32_t destLen, const char32_t* src, int32_t srcLen) {
+  if (srcLen < 0)
+    srcLen = lengthOf(src);
+
   int32_t resultLen = 0;
-  UErrorCode error = U_ZERO_ERROR;
+  for (int32_t i = 0; i < srcLen; ++i) {
+    char32_t c = src[i];
+    if (c > 0x10FFFF || U_IS_SURROGATE(c))
+      c = replacementCharacter;
+    if (!appendUTF16(dest, destLen, resultLen, c))
+      return 0;
+  }
+
+#if !ASSERT_DISABLED
+  assertMatchesICU(resultLen, [&](int32_t* icuLen, UErrorCode* error) {
+    u_strFromUTF32WithSub(nullptr, 0, icuLen, (const UChar32*)src, srcLen, 0xFFFD, 0, error);
+  });
+#endif
 
-  // Substitute invalid sequences with Unicode Replacement Character (U+FFFD)
-  u_strFromUTF32WithSub((UChar*)dest, destLen, &resultLen, (const UChar32*)src, srcLen, 0xFFFD, 0, &error);
-  
-  // Ignore Buffer Overflow Error if we are determining size (destLen == 0)
-  return (U_SUCCESS(error) || (error == U_BUFFER_OVERFLOW_ERROR && !destLen)) ? resultLen : 0;
+  return finish(dest, destLen, resultLen);
 }
 
 int32_t ConvertUTF16ToUTF8(char* dest, int32_t destLen, const char16_t* src, int32_t srcLen) {
+  if (srcLen < 0)
+    srcLen = lengthOf(src);
+
   int32_t resultLen = 0;
-  UErrorCode error = U_ZERO_ERROR;
-  
-  // Substitute invalid sequences with Unicode Replacement Character (U+FFFD)
-  u_strToUTF8WithSub(dest, destLen, &resultLen, (const UChar*)src, srcLen, 0xFFFD, 0, &error);
+  int32_t i = 0;
+  while (i < srcLen) {
+    // ASCII fast path, narrows eight code units at a time.
+    int32_t asciiLength = asciiPrefixLength(src + i, srcLen - i);
+    if (asciiLength) {
+      if (dest) {
+        if (resultLen + asciiLength > destLen)
+          return 0;
+        WTF::copyLCharsFromUCharSource(reinterpret_cast<LChar*>(dest + resultLen), reinterpret_cast<const UChar*>(src + i), asciiLength);
+      }
+      i += asciiLength;
+      resultLen += asciiLength;
+      if (i == srcLen)
+        break;
+    }
+
+    if (!appendUTF8(dest, destLen, resultLen, decodeUTF16(src, srcLen, i)))
+      return 0;
+  }
+
+#if !ASSERT_DISABLED
+  assertMatchesICU(resultLen, [&](int32_t* icuLen, UErrorCode* error) {
+    u_strToUTF8WithSub(nullptr, 0, icuLen, (const UChar*)src, srcLen, 0xFFFD, 0, error);
+  });
+#endif
 
-  // Ignore Buffer Overflow Error if we are determining size (destLen == 0)
-  return (U_SUCCESS(error) || (error == U_BUFFER_OVERFLOW_ERROR && !destLen)) ? resultLen : 0;
+  return finish(dest, destLen, resultLen);
 }
 
 int32_t ConvertUTF8ToUTF16(char16_t* dest, int32_t destLen, const char* src, int32_t srcLen) {
+  if (srcLen < 0)
+    srcLen = lengthOf(src);
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
   int32_t resultLen = 0;
-  UErrorCode error = U_ZERO_ERROR;
-  
-  // Substitute invalid sequences with Unicode Replacement Character (U+FFFD)
-  u_strFromUTF8WithSub((UChar*)dest, destLen, &resultLen, src, srcLen, 0xFFFD, 0, &error);
+  int32_t i = 0;
+  while (i < srcLen) {
+    // ASCII fast path, widens sixteen bytes at a time.
+    int32_t asciiLength = asciiPrefixLength(bytes + i, srcLen - i);
+    if (asciiLength) {
+      if (dest) {
+        if (resultLen + asciiLength > destLen)
+          return 0;
+        WTF::copyUCharsFromLCharSource(reinterpret_cast<UChar*>(dest + resultLen), bytes + i, asciiLength);
+      }
+      i += asciiLength;
+      resultLen += asciiLength;
+      if (i == srcLen)
+        break;
+    }
+
+    if (!appendUTF16(dest, destLen, resultLen, decodeUTF8(bytes, srcLen, i)))
+      return 0;
+  }
+
+#if !ASSERT_DISABLED
+  assertMatchesICU(resultLen, [&](int32_t* icuLen, UErrorCode* error) {
+    u_strFromUTF8WithSub(nullptr, 0, icuLen, src, srcLen, 0xFFFD, 0, error);
+  });
+#endif
 
-  // Ignore Buffer Overflow Error if we are determining size (destLen == 0)
-  return (U_SUCCESS(error) || (error == U_BUFFER_OVERFLOW_ERROR && !destLen)) ? resultLen : 0;
+  return finish(dest, destLen, resultLen);
 }
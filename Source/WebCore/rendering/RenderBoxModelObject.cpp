@@ -70,10 +70,6 @@
 #include "RuntimeApplicationChecks.h"
 #endif
 
-#if PLATFORM(ULTRALIGHT)
-#include "platform/graphics/ultralight/PlatformContextUltralight.h"
-#endif
-
 namespace WebCore {
 
 using namespace HTMLNames;
@@ -2548,8 +2544,7 @@ void RenderBoxModelObject::paintBoxShadow(const PaintInfo& info, const LayoutRec
               pixelFillRect.adjustRadii();
           }
 
-          PlatformGraphicsContext* platformCtx = context.platformContext();
-          platformCtx->DrawBoxShadow(pixelFillRect, shadowOffset, shadowRadius, shadowColor, false, rectToClipOut);
+          context.drawBoxShadow(pixelFillRect, shadowOffset, shadowRadius, shadowColor, false, rectToClipOut);
         }
         else {
           // Inset shadow.
@@ -2584,8 +2579,7 @@ void RenderBoxModelObject::paintBoxShadow(const PaintInfo& info, const LayoutRec
 
           FloatRoundedRect pixelRoundedHole = FloatRoundedRect(pixelHoleRect, pixelBorderRect.radii());
 
-          PlatformGraphicsContext* platformCtx = context.platformContext();
-          platformCtx->DrawBoxShadow(pixelBorderRect, shadowOffset, shadowRadius, shadowColor, true, pixelRoundedHole);
+          context.drawBoxShadow(pixelBorderRect, shadowOffset, shadowRadius, shadowColor, true, pixelRoundedHole);
         }
     }
 #else
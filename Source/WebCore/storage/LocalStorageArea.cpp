@@ -0,0 +1,193 @@
+#include "config.h"
+#include "LocalStorageArea.h"
+
+#include "LocalStorageDatabase.h"
+#include "StorageEventDispatcher.h"
+#include "StorageMap.h"
+#include "StorageType.h"
+#include <wtf/CrossThreadCopier.h>
+#include <wtf/MainThread.h>
+#include <wtf/WorkQueue.h>
+#include <wtf/threads/BinarySemaphore.h>
+
+namespace WebCore {
+
+// Changes are held for this long so a burst of them is written in one transaction.
+static const Seconds databaseUpdateInterval { 1_s };
+
+// Past this many pending changes the batch is written right away, to bound the memory they use.
+static const unsigned maximumPendingChanges = 1000;
+
+static WorkQueue& localStorageQueue()
+{
+    static auto& queue = WorkQueue::create("org.webkit.LocalStorage", WorkQueue::Type::Serial, WorkQueue::QOS::Background).leakRef();
+    return queue;
+}
+
+Ref<LocalStorageArea> LocalStorageArea::create(const SecurityOriginData& securityOrigin, const String& databasePath, unsigned quota)
+{
+    return adoptRef(*new LocalStorageArea(securityOrigin, databasePath, quota));
+}
+
+LocalStorageArea::LocalStorageArea(const SecurityOriginData& securityOrigin, const String& databasePath, unsigned quota)
+    : m_securityOrigin(securityOrigin)
+    , m_quota(quota)
+    , m_database(LocalStorageDatabase::create(databasePath))
+    , m_databaseUpdateTimer(*this, &LocalStorageArea::updateDatabase)
+{
+    ASSERT(isMainThread());
+}
+
+LocalStorageArea::~LocalStorageArea()
+{
+    ASSERT(isMainThread());
+
+    updateDatabase();
+    localStorageQueue().dispatch([database = m_database.copyRef()] {
+        database->close();
+    });
+}
+
+void LocalStorageArea::importItemsIfNeeded()
+{
+    ASSERT(isMainThread());
+
+    if (m_didImportItems)
+        return;
+    m_didImportItems = true;
+
+    // The page can't make progress without its items, so this is the one place that waits for
+    // the queue. The queue is serial, so every write queued for this file before has finished.
+    HashMap<String, String> items;
+    BinarySemaphore semaphore;
+    localStorageQueue().dispatch([database = m_database.copyRef(), &items, &semaphore] {
+        items = crossThreadCopy(database->readItems());
+        semaphore.signal();
+    });
+    semaphore.wait();
+
+    m_storageMap = StorageMap::create(m_quota);
+    m_storageMap->importItems(WTFMove(items));
+}
+
+unsigned LocalStorageArea::length()
+{
+    importItemsIfNeeded();
+    return m_storageMap->length();
+}
+
+String LocalStorageArea::key(unsigned index)
+{
+    importItemsIfNeeded();
+    return m_storageMap->key(index);
+}
+
+String LocalStorageArea::item(const String& key)
+{
+    importItemsIfNeeded();
+    return m_storageMap->getItem(key);
+}
+
+void LocalStorageArea::setItem(Frame* sourceFrame, const String& key, const String& value, bool& quotaException)
+{
+    ASSERT(!value.isNull());
+    importItemsIfNeeded();
+
+    String oldValue;
+    if (auto newStorageMap = m_storageMap->setItem(key, value, oldValue, quotaException))
+        m_storageMap = WTFMove(newStorageMap);
+
+    if (quotaException || oldValue == value)
+        return;
+
+    m_pendingChanges.set(key, value);
+    scheduleDatabaseUpdate();
+
+    StorageEventDispatcher::dispatchLocalStorageEvents(key, oldValue, value, m_securityOrigin, sourceFrame);
+}
+
+void LocalStorageArea::removeItem(Frame* sourceFrame, const String& key)
+{
+    importItemsIfNeeded();
+
+    String oldValue;
+    if (auto newStorageMap = m_storageMap->removeItem(key, oldValue))
+        m_storageMap = WTFMove(newStorageMap);
+
+    if (oldValue.isNull())
+        return;
+
+    m_pendingChanges.set(key, String());
+    scheduleDatabaseUpdate();
+
+    StorageEventDispatcher::dispatchLocalStorageEvents(key, oldValue, String(), m_securityOrigin, sourceFrame);
+}
+
+void LocalStorageArea::clear(Frame* sourceFrame)
+{
+    importItemsIfNeeded();
+
+    if (!m_storageMap->length())
+        return;
+
+    m_storageMap = StorageMap::create(m_quota);
+
+    // Earlier changes would all be undone by the clear anyway.
+    m_pendingChanges.clear();
+    m_pendingClear = true;
+    scheduleDatabaseUpdate();
+
+    StorageEventDispatcher::dispatchLocalStorageEvents(String(), String(), String(), m_securityOrigin, sourceFrame);
+}
+
+bool LocalStorageArea::contains(const String& key)
+{
+    importItemsIfNeeded();
+    return m_storageMap->contains(key);
+}
+
+StorageType LocalStorageArea::storageType() const
+{
+    return StorageType::Local;
+}
+
+void LocalStorageArea::scheduleDatabaseUpdate()
+{
+    if (m_pendingChanges.size() >= maximumPendingChanges) {
+        updateDatabase();
+        return;
+    }
+
+    if (!m_databaseUpdateTimer.isActive())
+        m_databaseUpdateTimer.startOneShot(databaseUpdateInterval);
+}
+
+void LocalStorageArea::updateDatabase()
+{
+    ASSERT(isMainThread());
+
+    m_databaseUpdateTimer.stop();
+
+    if (!m_pendingClear && m_pendingChanges.isEmpty())
+        return;
+
+    localStorageQueue().dispatch([database = m_database.copyRef(), clearItems = m_pendingClear, changes = crossThreadCopy(m_pendingChanges)] {
+        database->writeChanges(clearItems, changes);
+    });
+
+    m_pendingChanges.clear();
+    m_pendingClear = false;
+}
+
+void LocalStorageArea::synchronizeDatabase()
+{
+    updateDatabase();
+
+    BinarySemaphore semaphore;
+    localStorageQueue().dispatch([&semaphore] {
+        semaphore.signal();
+    });
+    semaphore.wait();
+}
+
+} // namespace WebCore
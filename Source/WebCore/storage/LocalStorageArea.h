@@ -0,0 +1,60 @@
+#pragma once
+
+#include "SecurityOriginData.h"
+#include "StorageArea.h"
+#include "Timer.h"
+#include <wtf/HashMap.h>
+#include <wtf/text/StringHash.h>
+
+namespace WebCore {
+
+class LocalStorageDatabase;
+class StorageMap;
+
+// A localStorage area backed by a SQLite file. The items are read once, on first use, and
+// served from a StorageMap after that. Changes are collected on the main thread and written
+// to disk in batches on a background queue.
+class LocalStorageArea final : public StorageArea {
+public:
+    WEBCORE_EXPORT static Ref<LocalStorageArea> create(const SecurityOriginData&, const String& databasePath, unsigned quota);
+    WEBCORE_EXPORT ~LocalStorageArea();
+
+    unsigned length() final;
+    String key(unsigned index) final;
+    String item(const String& key) final;
+    void setItem(Frame* sourceFrame, const String& key, const String& value, bool& quotaException) final;
+    void removeItem(Frame* sourceFrame, const String& key) final;
+    void clear(Frame* sourceFrame) final;
+    bool contains(const String& key) final;
+
+    StorageType storageType() const final;
+
+    size_t memoryBytesUsedByCache() final { return 0; }
+
+    const SecurityOriginData& securityOrigin() const final { return m_securityOrigin; }
+
+    // Writes the pending changes now and waits until they are on disk.
+    WEBCORE_EXPORT void synchronizeDatabase();
+
+private:
+    LocalStorageArea(const SecurityOriginData&, const String& databasePath, unsigned quota);
+
+    void importItemsIfNeeded();
+
+    void scheduleDatabaseUpdate();
+    void updateDatabase();
+
+    SecurityOriginData m_securityOrigin;
+    unsigned m_quota;
+
+    Ref<LocalStorageDatabase> m_database;
+    RefPtr<StorageMap> m_storageMap;
+    bool m_didImportItems { false };
+
+    // Changes not handed to the database yet. A null value is a removal.
+    HashMap<String, String> m_pendingChanges;
+    bool m_pendingClear { false };
+    Timer m_databaseUpdateTimer;
+};
+
+} // namespace WebCore
@@ -0,0 +1,130 @@
+#include "config.h"
+#include "LocalStorageDatabase.h"
+
+#include "Logging.h"
+#include "SQLiteStatement.h"
+#include "SQLiteTransaction.h"
+#include <sqlite3.h>
+#include <wtf/FileSystem.h>
+#include <wtf/MainThread.h>
+
+namespace WebCore {
+
+LocalStorageDatabase::LocalStorageDatabase(const String& databasePath)
+    : m_databasePath(databasePath.isolatedCopy())
+{
+    ASSERT(!m_databasePath.isEmpty());
+}
+
+LocalStorageDatabase::~LocalStorageDatabase()
+{
+    ASSERT(!m_database.isOpen());
+}
+
+bool LocalStorageDatabase::openDatabaseIfNeeded(ShouldCreateDatabase shouldCreateDatabase)
+{
+    ASSERT(!isMainThread());
+
+    if (m_database.isOpen())
+        return true;
+
+    if (m_failedToOpenDatabase)
+        return false;
+
+    // Reading an origin that never stored anything shouldn't leave an empty file behind.
+    if (shouldCreateDatabase == ShouldCreateDatabase::No && !FileSystem::fileExists(m_databasePath))
+        return false;
+
+    FileSystem::makeAllDirectories(FileSystem::directoryName(m_databasePath));
+
+    // SQLiteDatabase::open() puts the database in WAL mode, so the batched writes below don't
+    // rewrite the whole file.
+    if (!m_database.open(m_databasePath)) {
+        LOG_ERROR("Failed to open local storage database at %s", m_databasePath.utf8().data());
+        m_failedToOpenDatabase = true;
+        return false;
+    }
+
+    // The queue doesn't promise to run every task on the same thread.
+    m_database.disableThreadingChecks();
+
+    if (!m_database.executeCommand("CREATE TABLE IF NOT EXISTS ItemTable (key TEXT UNIQUE ON CONFLICT REPLACE PRIMARY KEY NOT NULL ON CONFLICT FAIL, value BLOB NOT NULL ON CONFLICT FAIL)"_s)) {
+        LOG_ERROR("Failed to create the local storage table (%i) - %s", m_database.lastError(), m_database.lastErrorMsg());
+        m_database.close();
+        m_failedToOpenDatabase = true;
+        return false;
+    }
+
+    return true;
+}
+
+HashMap<String, String> LocalStorageDatabase::readItems()
+{
+    HashMap<String, String> items;
+    if (!openDatabaseIfNeeded(ShouldCreateDatabase::No))
+        return items;
+
+    SQLiteStatement query(m_database, "SELECT key, value FROM ItemTable"_s);
+    if (query.prepare() != SQLITE_OK) {
+        LOG_ERROR("Failed to prepare the local storage import statement - %s", m_database.lastErrorMsg());
+        return items;
+    }
+
+    int result;
+    while ((result = query.step()) == SQLITE_ROW)
+        items.set(query.getColumnText(0), query.getColumnBlobAsString(1));
+
+    if (result != SQLITE_DONE)
+        LOG_ERROR("Failed to read all local storage items (%i) - %s", result, m_database.lastErrorMsg());
+
+    return items;
+}
+
+void LocalStorageDatabase::writeChanges(bool clearItems, const HashMap<String, String>& changes)
+{
+    if (!openDatabaseIfNeeded(ShouldCreateDatabase::Yes))
+        return;
+
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+
+    if (clearItems && !m_database.executeCommand("DELETE FROM ItemTable"_s)) {
+        LOG_ERROR("Failed to clear local storage items - %s", m_database.lastErrorMsg());
+        return;
+    }
+
+    if (!changes.isEmpty()) {
+        SQLiteStatement insertStatement(m_database, "INSERT INTO ItemTable VALUES (?, ?)"_s);
+        SQLiteStatement deleteStatement(m_database, "DELETE FROM ItemTable WHERE key = ?"_s);
+        if (insertStatement.prepare() != SQLITE_OK || deleteStatement.prepare() != SQLITE_OK) {
+            LOG_ERROR("Failed to prepare the local storage update statements - %s", m_database.lastErrorMsg());
+            return;
+        }
+
+        for (auto& change : changes) {
+            auto& statement = change.value.isNull() ? deleteStatement : insertStatement;
+            statement.reset();
+
+            int result = statement.bindText(1, change.key);
+            if (result == SQLITE_OK && !change.value.isNull())
+                result = statement.bindBlob(2, change.value);
+            if (result == SQLITE_OK)
+                result = statement.step();
+
+            if (result != SQLITE_DONE) {
+                LOG_ERROR("Failed to update local storage item (%i) - %s", result, m_database.lastErrorMsg());
+                return;
+            }
+        }
+    }
+
+    transaction.commit();
+}
+
+void LocalStorageDatabase::close()
+{
+    if (m_database.isOpen())
+        m_database.close();
+}
+
+} // namespace WebCore
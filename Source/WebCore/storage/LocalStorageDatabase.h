@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SQLiteDatabase.h"
+#include <wtf/HashMap.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/text/StringHash.h>
+#include <wtf/text/WTFString.h>
+
+namespace WebCore {
+
+// The SQLite file behind a LocalStorageArea. It is only used from the background queue the
+// area hands its work to, and is opened on first use.
+class LocalStorageDatabase : public ThreadSafeRefCounted<LocalStorageDatabase> {
+public:
+    static Ref<LocalStorageDatabase> create(const String& databasePath)
+    {
+        return adoptRef(*new LocalStorageDatabase(databasePath));
+    }
+
+    ~LocalStorageDatabase();
+
+    HashMap<String, String> readItems();
+
+    // Applies one batch of changes in a single transaction, after removing every item if
+    // clearItems is set. A null value removes its key.
+    void writeChanges(bool clearItems, const HashMap<String, String>& changes);
+
+    void close();
+
+private:
+    explicit LocalStorageDatabase(const String& databasePath);
+
+    enum class ShouldCreateDatabase : bool { No, Yes };
+    bool openDatabaseIfNeeded(ShouldCreateDatabase);
+
+    String m_databasePath;
+    SQLiteDatabase m_database;
+    bool m_failedToOpenDatabase { false };
+};
+
+} // namespace WebCore
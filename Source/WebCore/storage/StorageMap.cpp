@@ -36,9 +36,7 @@ Ref<StorageMap> StorageMap::create(unsigned quota)
 }
 
 StorageMap::StorageMap(unsigned quota)
-    : m_iterator(m_map.end())
-    , m_iteratorIndex(UINT_MAX)
-    , m_quotaSize(quota)  // quota measured in bytes
+    : m_quotaSize(quota)  // quota measured in bytes
     , m_currentLength(0)
 {
 }
@@ -47,37 +45,31 @@ Ref<StorageMap> StorageMap::copy()
 {
     Ref<StorageMap> newMap = create(m_quotaSize);
     newMap->m_map = m_map;
+    newMap->m_keys = m_keys;
+    newMap->m_keyIndices = m_keyIndices;
     newMap->m_currentLength = m_currentLength;
     return newMap;
 }
 
-void StorageMap::invalidateIterator()
+void StorageMap::appendKey(const String& key)
 {
-    m_iterator = m_map.end();
-    m_iteratorIndex = UINT_MAX;
+    ASSERT(!m_keyIndices.contains(key));
+    m_keyIndices.add(key, m_keys.size());
+    m_keys.append(key);
 }
 
-void StorageMap::setIteratorToIndex(unsigned index)
+void StorageMap::removeKey(const String& key)
 {
-    // FIXME: Once we have bidirectional iterators for HashMap we can be more intelligent about this.
-    // The requested index will be closest to begin(), our current iterator, or end(), and we
-    // can take the shortest route.
-    // Until that mechanism is available, we'll always increment our iterator from begin() or current.
-
-    if (m_iteratorIndex == index)
-        return;
-
-    if (index < m_iteratorIndex) {
-        m_iteratorIndex = 0;
-        m_iterator = m_map.begin();
-        ASSERT(m_iterator != m_map.end());
-    }
-
-    while (m_iteratorIndex < index) {
-        ++m_iteratorIndex;
-        ++m_iterator;
-        ASSERT(m_iterator != m_map.end());
+    unsigned index = m_keyIndices.take(key);
+    ASSERT(index < m_keys.size() && m_keys[index] == key);
+
+    // Fill the hole with the last key rather than shifting everything after it.
+    unsigned lastIndex = m_keys.size() - 1;
+    if (index != lastIndex) {
+        m_keys[index] = WTFMove(m_keys[lastIndex]);
+        m_keyIndices.set(m_keys[index], index);
     }
+    m_keys.removeLast();
 }
 
 unsigned StorageMap::length() const
@@ -87,11 +79,10 @@ unsigned StorageMap::length() const
 
 String StorageMap::key(unsigned index)
 {
-    if (index >= length())
+    if (index >= m_keys.size())
         return String();
 
-    setIteratorToIndex(index);
-    return m_iterator->key;
+    return m_keys[index];
 }
 
 String StorageMap::getItem(const String& key) const
@@ -136,8 +127,8 @@ RefPtr<StorageMap> StorageMap::setItem(const String& key, const String& value, S
     HashMap<String, String>::AddResult addResult = m_map.add(key, value);
     if (!addResult.isNewEntry)
         addResult.iterator->value = value;
-
-    invalidateIterator();
+    else
+        appendKey(key);
 
     return nullptr;
 }
@@ -167,7 +158,7 @@ RefPtr<StorageMap> StorageMap::removeItem(const String& key, String& oldValue)
 
     oldValue = m_map.take(key);
     if (!oldValue.isNull()) {
-        invalidateIterator();
+        removeKey(key);
         ASSERT(m_currentLength - key.length() <= m_currentLength);
         m_currentLength -= key.length();
     }
@@ -187,9 +178,11 @@ void StorageMap::importItems(HashMap<String, String>&& items)
     if (m_map.isEmpty()) {
         // Fast path.
         m_map = WTFMove(items);
+        m_keys.reserveInitialCapacity(m_map.size());
         for (auto& pair : m_map) {
             ASSERT(m_currentLength + pair.key.length() + pair.value.length() >= m_currentLength);
             m_currentLength += (pair.key.length() + pair.value.length());
+            appendKey(pair.key);
         }
         return;
     }
@@ -202,7 +195,9 @@ void StorageMap::importItems(HashMap<String, String>&& items)
         m_currentLength += (key.length() + value.length());
         
         auto result = m_map.add(WTFMove(key), WTFMove(value));
-        ASSERT_UNUSED(result, result.isNewEntry); // True if the key didn't exist previously.
+        ASSERT(result.isNewEntry); // True if the key didn't exist previously.
+        if (result.isNewEntry)
+            appendKey(result.iterator->key);
     }
 }
 
@@ -135,5 +135,15 @@ void enableMiniMode()
         Scavenger::get()->enableMiniMode();
 }
 
+size_t heapFootprint(HeapKind kind)
+{
+    if (DebugHeap::tryGet())
+        return 0;
+    kind = mapToActiveHeapKind(kind);
+    Heap& heap = PerProcess<PerHeapKind<Heap>>::get()->at(kind);
+    std::lock_guard<Mutex> lock(Heap::mutex());
+    return heap.footprint();
+}
+
 } } // namespace bmalloc::api
 
@@ -129,5 +129,8 @@ BEXPORT void setScavengerThreadQOSClass(qos_class_t overrideClass);
 
 BEXPORT void enableMiniMode();
 
+// Returns the physical footprint of the given heap. Returns 0 when the debug heap is in use.
+BEXPORT size_t heapFootprint(HeapKind kind = HeapKind::Primary);
+
 } // namespace api
 } // namespace bmalloc